@@ -0,0 +1,333 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#define ENABLE_SNDFILE_WINDOWS_PROTOTYPES 1
+#include <sndfile.h>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "../FilterEngine.h"
+#include "../helpers/ConfigFile.h"
+#include "../helpers/PrecisionTimer.h"
+#include "../helpers/StringHelper.h"
+#include "BatchRender.h"
+
+using namespace std;
+
+struct RenderJob
+{
+	wstring inputPath;
+	unsigned long long size;
+};
+
+struct WorkerQueue
+{
+	mutex queueMutex;
+	// sorted by descending size, the owner takes from the front and others steal from the back
+	deque<RenderJob> jobs;
+};
+
+// the engine of a worker keeps its loaded configuration for all files of the same format
+struct WorkerEngine
+{
+	FilterEngine engine;
+	int sampleRate = 0;
+	unsigned channelCount = 0;
+};
+
+struct RenderState
+{
+	const RenderSettings* settings;
+	vector<WorkerQueue> queues;
+	mutex printMutex;
+	atomic<unsigned> fileCount;
+	atomic<unsigned> failedCount;
+	atomic<unsigned long long> frameCount;
+	atomic<unsigned long long> sampleCount;
+	// sum of the lengths of the rendered files in seconds, in microseconds to be atomic
+	atomic<unsigned long long> audioMicroseconds;
+};
+
+static bool takeJob(RenderState* state, size_t worker, RenderJob& job)
+{
+	WorkerQueue& own = state->queues[worker];
+	{
+		lock_guard<mutex> lock(own.queueMutex);
+		if (!own.jobs.empty())
+		{
+			job = own.jobs.front();
+			own.jobs.pop_front();
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < state->queues.size(); i++)
+	{
+		WorkerQueue& other = state->queues[(worker + i) % state->queues.size()];
+		lock_guard<mutex> lock(other.queueMutex);
+		if (!other.jobs.empty())
+		{
+			job = other.jobs.back();
+			other.jobs.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static wstring getFileName(const wstring& path)
+{
+	size_t pos = path.find_last_of(L"\\/");
+	return pos == wstring::npos ? path : path.substr(pos + 1);
+}
+
+// paths can contain characters outside of the ANSI codepage, which are only replaced for the console output
+static string toConsole(const wstring& path)
+{
+	return StringHelper::toString(path, CP_ACP);
+}
+
+static bool renderFile(RenderState* state, WorkerEngine& worker, vector<float>& buf, const wstring& inputPath, double& time)
+{
+	const RenderSettings& settings = *state->settings;
+
+	SF_INFO info = {};
+	SNDFILE* inFile = sf_wchar_open(inputPath.c_str(), SFM_READ, &info);
+	if (inFile == NULL)
+	{
+		lock_guard<mutex> lock(state->printMutex);
+		fprintf(stderr, "%s: %s\n", toConsole(inputPath).c_str(), sf_strerror(inFile));
+		return false;
+	}
+
+	wstring outputPath = settings.outputDirectory + L"\\" + getFileName(inputPath);
+	wchar_t fullInputPath[MAX_PATH];
+	wchar_t fullOutputPath[MAX_PATH];
+	if (GetFullPathNameW(inputPath.c_str(), MAX_PATH, fullInputPath, NULL) != 0
+		&& GetFullPathNameW(outputPath.c_str(), MAX_PATH, fullOutputPath, NULL) != 0
+		&& _wcsicmp(fullInputPath, fullOutputPath) == 0)
+	{
+		lock_guard<mutex> lock(state->printMutex);
+		fprintf(stderr, "%s: Output would overwrite the input\n", toConsole(inputPath).c_str());
+		sf_close(inFile);
+		return false;
+	}
+
+	SF_INFO outInfo = {0, info.samplerate, info.channels, info.format, 0};
+	SNDFILE* outFile = sf_wchar_open(outputPath.c_str(), SFM_WRITE, &outInfo);
+	if (outFile == NULL)
+	{
+		lock_guard<mutex> lock(state->printMutex);
+		fprintf(stderr, "%s: %s\n", toConsole(outputPath).c_str(), sf_strerror(outFile));
+		sf_close(inFile);
+		return false;
+	}
+
+	PrecisionTimer timer;
+	timer.start();
+
+	unsigned channelCount = info.channels;
+	unsigned batchSize = settings.batchSize;
+	buf.resize((size_t)batchSize * channelCount);
+
+	if (info.samplerate != worker.sampleRate || channelCount != worker.channelCount)
+	{
+		// the configuration is only parsed again when the format differs from the previous file
+		worker.engine.initialize((float)info.samplerate, channelCount, channelCount, channelCount, 0, batchSize, settings.configPath);
+		worker.sampleRate = info.samplerate;
+		worker.channelCount = channelCount;
+	}
+	else
+	{
+		// no state of the filters carries over from the previous file
+		worker.engine.reset();
+	}
+
+	unsigned long long frameCount = 0;
+	bool success = true;
+	while (true)
+	{
+		sf_count_t numRead = sf_readf_float(inFile, buf.data(), batchSize);
+		if (numRead <= 0)
+			break;
+
+		worker.engine.process(buf.data(), buf.data(), (unsigned)numRead);
+
+		if (sf_writef_float(outFile, buf.data(), numRead) != numRead)
+		{
+			lock_guard<mutex> lock(state->printMutex);
+			fprintf(stderr, "%s: %s\n", toConsole(outputPath).c_str(), sf_strerror(outFile));
+			success = false;
+			break;
+		}
+		frameCount += numRead;
+	}
+
+	sf_close(outFile);
+	sf_close(inFile);
+	time = timer.stop();
+
+	state->frameCount += frameCount;
+	state->sampleCount += frameCount * channelCount;
+	state->audioMicroseconds += frameCount * 1000000ull / info.samplerate;
+
+	return success;
+}
+
+static void renderThread(RenderState* state, size_t worker)
+{
+	const RenderSettings& settings = *state->settings;
+
+	WorkerEngine workerEngine;
+	workerEngine.engine.setDeviceInfo(false, true, settings.deviceName, settings.connectionName, settings.deviceGuid,
+		settings.deviceName + L" " + settings.connectionName + L" " + settings.deviceGuid);
+
+	vector<float> buf;
+	RenderJob job;
+	while (takeJob(state, worker, job))
+	{
+		double time = 0.0;
+		bool success = renderFile(state, workerEngine, buf, job.inputPath, time);
+		if (success)
+			state->fileCount++;
+		else
+			state->failedCount++;
+
+		lock_guard<mutex> lock(state->printMutex);
+		printf("[%d] %s %s in %f seconds\n", (unsigned)worker, success ? "Rendered" : "Failed", toConsole(job.inputPath).c_str(), time);
+	}
+}
+
+vector<wstring> expandInputPaths(const vector<wstring>& patterns)
+{
+	vector<wstring> paths;
+	for (const wstring& pattern : patterns)
+	{
+		if (!pattern.empty() && pattern[0] == L'@')
+		{
+			// decoded like configuration files, so the list may be UTF-8, UTF-16 or ANSI
+			shared_ptr<const ConfigFile> list = ConfigFile::load(pattern.substr(1));
+			if (list == nullptr)
+			{
+				fprintf(stderr, "Can't read file list %s\n", toConsole(pattern.substr(1)).c_str());
+				continue;
+			}
+
+			const wstring& text = list->getText();
+			for (const ConfigFile::Line& line : list->getLines())
+			{
+				wstring path = StringHelper::trim(text.substr(line.offset, line.length));
+				if (!path.empty())
+					paths.push_back(path);
+			}
+		}
+		else if (pattern.find_first_of(L"*?") != wstring::npos)
+		{
+			size_t pos = pattern.find_last_of(L"\\/");
+			wstring directory = pos == wstring::npos ? L"" : pattern.substr(0, pos + 1);
+
+			WIN32_FIND_DATAW data;
+			HANDLE findHandle = FindFirstFileW(pattern.c_str(), &data);
+			if (findHandle == INVALID_HANDLE_VALUE)
+			{
+				fprintf(stderr, "No files match %s\n", toConsole(pattern).c_str());
+				continue;
+			}
+
+			do
+			{
+				if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+					paths.push_back(directory + data.cFileName);
+			}
+			while (FindNextFileW(findHandle, &data));
+
+			FindClose(findHandle);
+		}
+		else
+		{
+			paths.push_back(pattern);
+		}
+	}
+
+	return paths;
+}
+
+void reportBatchRender(const vector<wstring>& inputPaths, unsigned workerCount, const RenderSettings& settings)
+{
+	vector<RenderJob> jobs;
+	for (const wstring& path : inputPaths)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		unsigned long long size = 0;
+		if (GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+			size = ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+		jobs.push_back({path, size});
+	}
+
+	if (jobs.empty())
+	{
+		fprintf(stderr, "No input files to render\n");
+		return;
+	}
+
+	// the largest files first, so that the workers finish at about the same time
+	stable_sort(jobs.begin(), jobs.end(), [](const RenderJob& a, const RenderJob& b) {return a.size > b.size;});
+
+	workerCount = max(min(workerCount, (unsigned)jobs.size()), 1u);
+
+	RenderState state;
+	state.settings = &settings;
+	state.queues = vector<WorkerQueue>(workerCount);
+	state.fileCount = 0;
+	state.failedCount = 0;
+	state.frameCount = 0;
+	state.sampleCount = 0;
+	state.audioMicroseconds = 0;
+	for (size_t i = 0; i < jobs.size(); i++)
+		state.queues[i % workerCount].jobs.push_back(jobs[i]);
+
+	printf("\nRendering %d file(s) with %d worker(s) to %s\n", (unsigned)jobs.size(), workerCount, toConsole(settings.outputDirectory).c_str());
+
+	PrecisionTimer timer;
+	timer.start();
+
+	vector<thread> workers;
+	for (unsigned i = 0; i < workerCount; i++)
+		workers.push_back(thread(renderThread, &state, (size_t)i));
+	for (thread& worker : workers)
+		worker.join();
+
+	double time = timer.stop();
+	double audioLength = state.audioMicroseconds / 1000000.0;
+
+	printf("\n%d file(s) rendered", state.fileCount.load());
+	if (state.failedCount > 0)
+		printf(", %d failed", state.failedCount.load());
+	printf(" in %f seconds\n", time);
+	printf("%llu frames (%llu samples, %.1f seconds of audio) processed\n", state.frameCount.load(), state.sampleCount.load(), audioLength);
+	printf("This is %.1f times real time or %.1f million samples per second\n", audioLength / time, state.sampleCount / time / 1000000.0);
+}
@@ -0,0 +1,42 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct RenderSettings
+{
+	std::wstring configPath;
+	std::wstring deviceName;
+	std::wstring connectionName;
+	std::wstring deviceGuid;
+	unsigned batchSize;
+	std::wstring outputDirectory;
+};
+
+// Expands wildcard patterns like C:\Recordings\*.wav and list files given as @list.txt with one path per line
+std::vector<std::wstring> expandInputPaths(const std::vector<std::wstring>& patterns);
+
+// Renders each input file with the configuration to a file of the same name and format in the output directory.
+// Each worker thread has its own FilterEngine, which only loads the configuration again for a file of another format
+// and is reset between files otherwise. It takes the largest remaining file from its own queue or, when that is
+// empty, from the end of the queue of another worker. Reports the throughput of all workers together.
+void reportBatchRender(const std::vector<std::wstring>& inputPaths, unsigned workerCount, const RenderSettings& settings);
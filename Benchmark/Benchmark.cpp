@@ -26,6 +26,7 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <string>
+#include <thread>
 #include <sndfile.h>
 #include <tclap/CmdLine.h>
 
@@ -35,9 +36,284 @@
 #include "../helpers/StringHelper.h"
 #include "../helpers/PrecisionTimer.h"
 #include "../helpers/MemoryHelper.h"
+#include "../helpers/SimdHelper.h"
+#include "../libHybridConv-0.1.1/libHybridConv_eapo.h"
+#include "../filters/VSTPluginFilter.h"
+#include "StandInPlugin.h"
+#include "MicroBenchmark.h"
+#include "RealtimeSimulation.h"
+#include "StreamingRender.h"
+#include "BatchRender.h"
+#include "SimdCheck.h"
+#include "FileWatcherCheck.h"
+#include "ParseCheck.h"
+#include "VoicemeeterSimulation.h"
 
 using namespace std;
 
+static string getOutputPath(const string& output)
+{
+	if (output != "")
+		return output;
+
+	char temp[255];
+	GetTempPathA(sizeof(temp) / sizeof(wchar_t), temp);
+
+	return string(temp) + "testout.wav";
+}
+
+static void reportConvolutionAccuracy(const string& impulseResponsePath, float* buf, unsigned frameCount, unsigned channelCount, unsigned blockSize)
+{
+	printf("\nComparing single and double precision convolution with %s\n", impulseResponsePath.c_str());
+
+	SF_INFO info;
+	SNDFILE* irFile = sf_open(impulseResponsePath.c_str(), SFM_READ, &info);
+	if (irFile == NULL)
+	{
+		fprintf(stderr, "%s\n", sf_strerror(irFile));
+		return;
+	}
+
+	unsigned irLength = (unsigned)info.frames;
+	double* interleaved = new double[irLength * info.channels];
+	sf_count_t numRead = 0;
+	while (numRead < irLength)
+		numRead += sf_readf_double(irFile, interleaved + numRead * info.channels, irLength - numRead);
+	sf_close(irFile);
+
+	// first channel of the impulse response applied to the first channel of the signal
+	double* ir = new double[irLength];
+	for (unsigned i = 0; i < irLength; i++)
+		ir[i] = interleaved[i * info.channels];
+	delete[] interleaved;
+
+	unsigned blockCount = frameCount / blockSize;
+	unsigned length = blockCount * blockSize;
+	double* input = new double[length];
+	for (unsigned i = 0; i < length; i++)
+		input[i] = buf[i * channelCount];
+	double* outDouble = new double[length];
+	double* outFloat = new double[length];
+
+	HConvSingle doubleFilter;
+	HConvSingleF floatFilter;
+	hcInitSingle(&doubleFilter, ir, irLength, blockSize, 1);
+	hcInitSingleF(&floatFilter, ir, irLength, blockSize, 1);
+
+	PrecisionTimer timer;
+	timer.start();
+	for (unsigned i = 0; i < length; i += blockSize)
+	{
+		hcPutSingle(&doubleFilter, input + i);
+		hcProcessSingle(&doubleFilter);
+		hcGetSingle(&doubleFilter, outDouble + i);
+	}
+	double doubleTime = timer.stop();
+
+	timer.start();
+	for (unsigned i = 0; i < length; i += blockSize)
+	{
+		hcPutSingleF(&floatFilter, input + i);
+		hcProcessSingleF(&floatFilter);
+		hcGetSingleF(&floatFilter, outFloat + i);
+	}
+	double floatTime = timer.stop();
+
+	size_t doubleBytes = sizeof(double) * doubleFilter.segment_size * (doubleFilter.num_filterbuf + doubleFilter.num_mixbuf);
+	size_t floatBytes = sizeof(float) * floatFilter.segment_size * (floatFilter.num_filterbuf + floatFilter.num_mixbuf);
+
+	hcCloseSingle(&doubleFilter);
+	hcCloseSingleF(&floatFilter);
+
+	double maxError = 0.0;
+	double errorEnergy = 0.0;
+	double signalEnergy = 0.0;
+	for (unsigned i = 0; i < length; i++)
+	{
+		double error = outFloat[i] - outDouble[i];
+		maxError = max(maxError, fabs(error));
+		errorEnergy += error * error;
+		signalEnergy += outDouble[i] * outDouble[i];
+	}
+
+	printf("%d samples with %d taps in blocks of %d frames\n", length, irLength, blockSize);
+	printf("Double precision: %f seconds, %.1f MiB spectra\n", doubleTime, doubleBytes / 1048576.0);
+	printf("Single precision: %f seconds, %.1f MiB spectra\n", floatTime, floatBytes / 1048576.0);
+	printf("Max absolute error: %g (%f dB)\n", maxError, log10(maxError) * 20.0);
+	if (signalEnergy > 0.0)
+		printf("Error relative to output: %f dB\n", log10(errorEnergy / signalEnergy) * 10.0);
+
+	delete[] input;
+	delete[] outDouble;
+	delete[] outFloat;
+	delete[] ir;
+}
+
+static void reportParallelVST(double load, const SweepParameters& sweep, unsigned channelCount, unsigned sampleRate, unsigned blockSize)
+{
+	printf("\nComparing serial and parallel processing of a stand-in VST plugin taking %g ms per block\n", load * 1000.0);
+
+	setStandInPluginLoad(load);
+	shared_ptr<VSTPluginLibrary> library = VSTPluginLibrary::createBuiltIn(L"Stand-in plugin", &standInPluginMain);
+	vector<wstring> channelNames;
+	for (unsigned c = 0; c < channelCount; c++)
+		channelNames.push_back(to_wstring(c + 1));
+
+	unsigned frameCount = (unsigned)(sweep.length * sampleRate);
+	float sweepDiff = sweep.to - sweep.from;
+	unsigned blockCount = frameCount / blockSize;
+	double* input = new double[channelCount * blockSize];
+	double* outputs[2];
+	double blockTimes[2];
+	for (int mode = 0; mode < 2; mode++)
+	{
+		bool parallel = mode == 1;
+		outputs[mode] = new double[(size_t)channelCount * blockCount * blockSize];
+
+		VSTPluginFilter filter(library, L"", unordered_map<wstring, float>(), parallel);
+		filter.initialize((float)sampleRate, blockSize, channelNames);
+
+		double** inputChannels = new double*[channelCount];
+		double** outputChannels = new double*[channelCount];
+		double maxBlockTime = 0.0;
+		PrecisionTimer timer;
+		PrecisionTimer blockTimer;
+		timer.start();
+		for (unsigned b = 0; b < blockCount; b++)
+		{
+			for (unsigned c = 0; c < channelCount; c++)
+			{
+				inputChannels[c] = input + c * blockSize;
+				outputChannels[c] = outputs[mode] + ((size_t)c * blockCount + b) * blockSize;
+			}
+
+			// the sweep is generated block by block, so that no buffer for its whole length is needed
+			for (unsigned i = 0; i < blockSize; i++)
+			{
+				double t = ((size_t)b * blockSize + i) * 1.0 / sampleRate;
+				double s = sin(((sweep.from + sweepDiff * (t / sweep.length) / 2) * t) * 2 * M_PI);
+
+				for (unsigned c = 0; c < channelCount; c++)
+					inputChannels[c][i] = s;
+			}
+
+			blockTimer.start();
+			filter.process(outputChannels, inputChannels, blockSize);
+			maxBlockTime = max(maxBlockTime, blockTimer.stop());
+		}
+		double time = timer.stop();
+		blockTimes[mode] = time / blockCount;
+
+		printf("%s: %f ms per block on average, %f ms at most, block period %f ms\n", parallel ? "Parallel" : "Serial",
+			blockTimes[mode] * 1000.0, maxBlockTime * 1000.0, blockSize * 1000.0 / sampleRate);
+
+		delete[] inputChannels;
+		delete[] outputChannels;
+	}
+
+	// blocks that missed the deadline were passed through, so they differ from the serial result
+	unsigned bypassedBlocks = 0;
+	for (unsigned c = 0; c < channelCount; c++)
+	{
+		for (unsigned b = 0; b < blockCount; b++)
+		{
+			size_t offset = ((size_t)c * blockCount + b) * blockSize;
+			if (memcmp(outputs[0] + offset, outputs[1] + offset, blockSize * sizeof(double)) != 0)
+				bypassedBlocks++;
+		}
+	}
+	printf("%d of %d channel blocks differ from serial processing\n", bypassedBlocks, channelCount * blockCount);
+	printf("Speedup: %.2f\n", blockTimes[0] / blockTimes[1]);
+
+	delete[] input;
+	delete[] outputs[0];
+	delete[] outputs[1];
+}
+
+static void reportConfigParsing(unsigned repetitions, unsigned sampleRate, unsigned channelCount, unsigned blockSize)
+{
+	const unsigned filterCount = 500;
+	const unsigned conditionCount = 200;
+	printf("\nLoading a generated configuration with %d filters in Room EQ Wizard syntax and %d conditions %d times\n", filterCount, conditionCount, repetitions);
+
+	char temp[255];
+	GetTempPathA(sizeof(temp), temp);
+	string path = temp;
+	path += "testparse.txt";
+
+	FILE* fp = fopen(path.c_str(), "w");
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Could not write %s\n", path.c_str());
+		return;
+	}
+
+	fprintf(fp, "Device: all\nPreamp: -6 dB\n");
+	for (unsigned i = 0; i < filterCount; i++)
+	{
+		// header of a filter settings file exported by Room EQ Wizard for each channel
+		if (i % (filterCount / 2) == 0)
+		{
+			fprintf(fp, "Channel: %s\nFilter Settings file\n\nRoom EQ V5.31\nDated: Oct 18, 2026 10:00:00 AM\n\n", i == 0 ? "L" : "R");
+			fprintf(fp, "Notes:\n\nEqualiser: Generic\nAverage 1\n");
+		}
+
+		// log-spaced frequencies, formatted like Room EQ Wizard with a period as thousands separator
+		double freq = 20.0 * pow(1000.0, (double)i / filterCount);
+		char freqString[32];
+		if (freq >= 1000.0)
+			sprintf_s(freqString, "%d.%03d", (int)freq / 1000, (int)freq % 1000);
+		else
+			sprintf_s(freqString, "%.1f", freq);
+		double gain = (i % 13) - 6.0;
+
+		switch (i % 5)
+		{
+		case 0:
+			fprintf(fp, "Filter %d: ON LSC 12 dB Fc %s Hz Gain %.1f dB\n", i + 1, freqString, gain);
+			break;
+		case 1:
+			fprintf(fp, "Filter %d: ON HS Fc %s Hz Gain %.1f dB Q 0.71\n", i + 1, freqString, gain);
+			break;
+		case 2:
+			fprintf(fp, "Filter %d: ON PK Fc %s Hz Gain %.1f dB BW Oct 0.5\n", i + 1, freqString, gain);
+			break;
+		default:
+			fprintf(fp, "Filter %d: ON PK Fc %s Hz Gain %.1f dB Q %.2f\n", i + 1, freqString, gain, 0.5 + (i % 7) * 0.5);
+			break;
+		}
+	}
+
+	// conditions like in configurations shared by several devices, only the last one is true
+	for (unsigned i = 0; i < conditionCount; i++)
+	{
+		fprintf(fp, "If: sampleRate == %d || regexReplace(\"Device ([0-9]+)\", \"Device %d\", \"$1\") == \"%d\"\n", i, i, conditionCount - 1);
+		fprintf(fp, "Preamp: `-0.01 * %d` dB\nEndIf:\n", i);
+	}
+	fclose(fp);
+
+	wstring configPath = StringHelper::toWString(path, CP_ACP);
+	FilterEngine engine;
+	engine.initialize((float)sampleRate, channelCount, channelCount, channelCount, 0, blockSize, configPath);
+
+	double totalTime = 0.0;
+	double minTime = 0.0;
+	PrecisionTimer timer;
+	for (unsigned i = 0; i < repetitions; i++)
+	{
+		timer.start();
+		engine.loadConfig(configPath);
+		double time = timer.stop();
+
+		totalTime += time;
+		if (i == 0 || time < minTime)
+			minTime = time;
+	}
+
+	printf("Loading including filter creation took %f ms on average, %f ms at least\n", totalTime * 1000.0 / repetitions, minTime * 1000.0);
+	DeleteFileA(path.c_str());
+}
+
 int main(int argc, char** argv)
 {
 	try
@@ -63,6 +339,27 @@ int main(int argc, char** argv)
 		TCLAP::ValueArg<float> fromArg("f", "from", "Start frequency of generated sweep in Hz (Default: 0.1)", false, 1.0f, "float", cmd);
 		TCLAP::ValueArg<float> lengthArg("l", "length", "Length of generated sweep in seconds (Default: 200.0)", false, 200.0f, "float", cmd);
 		TCLAP::ValueArg<unsigned> channelArg("c", "channels", "Number of channels of generated sweep (Default: 2)", false, 2, "integer", cmd);
+		TCLAP::ValueArg<string> configArg("", "config", "Configuration file to use instead of config.txt in the configuration directory of the installation, which also avoids reading the registry (Default: <empty>)", false, "", "string", cmd);
+		TCLAP::ValueArg<string> outdirArg("", "outdir", "Directory to write the files rendered by --render to (Default: temporary directory)", false, "", "string", cmd);
+		TCLAP::ValueArg<unsigned> workersArg("", "workers", "Number of files rendered in parallel by --render (Default: number of logical processors)", false, 0, "integer", cmd);
+		TCLAP::MultiArg<string> renderArg("", "render", "Input file, wildcard pattern or @file with a list of input files to render with the configuration into --outdir, keeping name and format, instead of running the benchmark", false, "string", cmd);
+		TCLAP::SwitchArg streamArg("", "stream", "Read the input file or generate the sweep and write the output in chunks on separate threads while processing, instead of holding the whole signal in memory", cmd);
+		TCLAP::ValueArg<string> convAccuracyArg("", "convaccuracy", "Impulse response file to compare single and double precision convolution with, using batchsize as block size, instead of running the filter configuration", false, "", "string", cmd);
+		TCLAP::ValueArg<float> parallelVSTArg("", "parallelvst", "Milliseconds per block taken by a stand-in stereo VST plugin to compare serial and parallel processing of its instances with, using batchsize as block size, instead of running the filter configuration", false, 0.0f, "float", cmd);
+		TCLAP::ValueArg<unsigned> voicemeeterArg("", "voicemeeter", "Number of Voicemeeter output buses (1 to 16) to process with the configuration in a stand-in for the audio callback of Voicemeeter to compare serial and parallel processing of the buses, using batchsize as block size, instead of running the filter configuration", false, 5, "integer", cmd);
+		TCLAP::SwitchArg noPacingArg("", "nopacing", "Call process for --rtsim back to back instead of once per period", cmd);
+		TCLAP::ValueArg<float> reloadArg("", "reload", "Interval in milliseconds in which --rtsim reloads the configuration to measure transitions (Default: 0 = never)", false, 0.0f, "float", cmd);
+		TCLAP::ValueArg<unsigned> jitterArg("", "jitter", "Maximum random deviation of the number of frames per callback of --rtsim (Default: 0)", false, 0, "integer", cmd);
+		TCLAP::ValueArg<unsigned> periodArg("", "period", "Number of frames per callback of --rtsim (Default: 480)", false, 480, "integer", cmd);
+		TCLAP::ValueArg<float> rtsimArg("", "rtsim", "Seconds of audio to process in callbacks like an audio host, reporting percentiles of the processing time per callback, instead of processing the whole input at once", false, 0.0f, "float", cmd);
+		TCLAP::ValueArg<string> jsonArg("", "json", "File to write the results of --micro to in JSON format", false, "", "string", cmd);
+		TCLAP::ValueArg<unsigned> microRepetitionsArg("", "microreps", "Number of measured repetitions for each case of --micro (Default: 10)", false, 10, "integer", cmd);
+		TCLAP::ValueArg<string> microArg("", "micro", "Comma-separated names of filter types (BiQuad, IIR, Preamp, Delay, Copy, Convolution, GraphicEQ, LoudnessCorrection) or all to measure individually with several channel counts and block sizes at the sample rate given by rate, at a fixed volume for LoudnessCorrection and with continuous volume changes for LoudnessCorrection-Ramp, instead of running the filter configuration", false, "", "string", cmd);
+		TCLAP::ValueArg<string> simdArg("", "simd", "Instruction set level of the processing kernels (scalar, sse2, avx2, avx512 or neon) to compare them, instead of the highest one supported by the processor or the one given by the environment variable EQUALIZERAPO_SIMD", false, "", "string", cmd);
+		TCLAP::SwitchArg simdCheckArg("", "simdcheck", "Compare the processing kernels of every supported instruction set level with the scalar kernels on random data, instead of running the filter configuration", cmd);
+		TCLAP::SwitchArg watchCheckArg("", "watchcheck", "Change files in a temporary directory and check that the file watcher reports exactly the changes of the watched files, instead of running the filter configuration", cmd);
+		TCLAP::ValueArg<string> parseCheckArg("", "parsecheck", "Directory with configuration files, whose lines and variations of them are parsed with the former regular expressions and the current scanners of the Filter, GraphicEQ and Device commands to compare the results, instead of running the filter configuration", false, "", "string", cmd);
+		TCLAP::ValueArg<unsigned> parseArg("", "parse", "Number of times to load a generated configuration with 500 filters in Room EQ Wizard syntax to measure the parsing time, instead of running the filter configuration", false, 0, "integer", cmd);
 
 		cmd.parse(argc, argv);
 
@@ -88,6 +385,179 @@ int main(int argc, char** argv)
 		printf("Run \"%s -h\" to show usage info\n", argv[0]);
 		printf("\n");
 
+		if (simdArg.isSet())
+		{
+			SimdLevel level;
+			if (!SimdHelper::parseLevel(StringHelper::toWString(simdArg.getValue(), CP_ACP), level))
+			{
+				fprintf(stderr, "Unknown instruction set level %s\n", simdArg.getValue().c_str());
+				return 1;
+			}
+			SimdHelper::setLevel(level);
+		}
+		printf("Using %s kernels (supported: %s)\n", StringHelper::toString(SimdHelper::getLevelName(SimdHelper::getLevel()), CP_ACP).c_str(),
+			StringHelper::toString(SimdHelper::getLevelName(SimdHelper::getSupportedLevel()), CP_ACP).c_str());
+		printf("\n");
+
+		if (simdCheckArg.getValue())
+		{
+			bool success = reportSimdCheck();
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return success ? 0 : 1;
+		}
+
+		if (watchCheckArg.getValue())
+		{
+			bool success = reportFileWatcherCheck();
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return success ? 0 : 1;
+		}
+
+		if (parseCheckArg.isSet())
+		{
+			bool success = reportParseCheck(StringHelper::toWString(parseCheckArg.getValue(), CP_ACP));
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return success ? 0 : 1;
+		}
+
+		if (renderArg.isSet())
+		{
+			RenderSettings settings;
+			settings.configPath = StringHelper::toWString(configArg.getValue(), CP_ACP);
+			settings.deviceName = StringHelper::toWString(devicenameArg.getValue(), CP_ACP);
+			settings.connectionName = StringHelper::toWString(connectionnameArg.getValue(), CP_ACP);
+			settings.deviceGuid = StringHelper::toWString(guidArg.getValue(), CP_ACP);
+			settings.batchSize = max(batchsizeArg.getValue(), 1u);
+			settings.outputDirectory = StringHelper::toWString(outdirArg.getValue(), CP_ACP);
+			if (settings.outputDirectory == L"")
+			{
+				wchar_t temp[MAX_PATH + 1];
+				GetTempPathW(sizeof(temp) / sizeof(wchar_t), temp);
+				settings.outputDirectory = temp;
+			}
+			while (settings.outputDirectory.size() > 1 && (settings.outputDirectory.back() == L'\\' || settings.outputDirectory.back() == L'/'))
+				settings.outputDirectory.pop_back();
+
+			unsigned workerCount = workersArg.getValue();
+			if (workerCount == 0)
+				workerCount = max(thread::hardware_concurrency(), 1u);
+
+			vector<wstring> patterns;
+			for (const string& pattern : renderArg.getValue())
+				patterns.push_back(StringHelper::toWString(pattern, CP_ACP));
+
+			reportBatchRender(expandInputPaths(patterns), workerCount, settings);
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
+		// the following modes generate their own signals, so the sweep is not generated for them
+		if (parallelVSTArg.isSet())
+		{
+			SweepParameters sweep = {fromArg.getValue(), toArg.getValue(), lengthArg.getValue()};
+			reportParallelVST(parallelVSTArg.getValue() / 1000.0, sweep, channelArg.getValue(), rateArg.getValue(), max(batchsizeArg.getValue(), 1u));
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
+		if (parseArg.isSet())
+		{
+			reportConfigParsing(max(parseArg.getValue(), 1u), rateArg.getValue(), channelArg.getValue(), batchsizeArg.getValue());
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
+		if (microArg.isSet())
+		{
+			reportMicroBenchmarks(microArg.getValue(), rateArg.getValue(), max(microRepetitionsArg.getValue(), 1u), jsonArg.getValue());
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
+		wstring customPath = StringHelper::toWString(configArg.getValue(), CP_ACP);
+
+		if (streamArg.getValue())
+		{
+			SweepParameters sweep = {fromArg.getValue(), toArg.getValue(), lengthArg.getValue()};
+			unsigned long long streamFrameCount;
+			SNDFILE* inFile = NULL;
+
+			string input = inputArg.getValue();
+			if (input != "")
+			{
+				printf("Streaming sound data from %s\n", input.c_str());
+
+				SF_INFO info;
+				inFile = sf_open(input.c_str(), SFM_READ, &info);
+				if (inFile == NULL)
+				{
+					fprintf(stderr, "%s", sf_strerror(inFile));
+					return 1;
+				}
+
+				sampleRate = info.samplerate;
+				channelCount = info.channels;
+				streamFrameCount = info.frames;
+			}
+			else
+			{
+				sampleRate = rateArg.getValue();
+				channelCount = channelArg.getValue();
+				streamFrameCount = (unsigned long long)(sweep.length * sampleRate);
+
+				printf("No input file given, so generating linear sine sweep from %g to %g Hz over %g seconds while processing\n", sweep.from, sweep.to, sweep.length);
+			}
+
+			unsigned batchsize = max(batchsizeArg.getValue(), 1u);
+			string output = getOutputPath(outputArg.getValue());
+
+			PrecisionTimer timer;
+			timer.start();
+			{
+				FilterEngine engine;
+				wstring deviceName = StringHelper::toWString(devicenameArg.getValue(), CP_ACP);
+				wstring connectionName = StringHelper::toWString(connectionnameArg.getValue(), CP_ACP);
+				wstring deviceGuid = StringHelper::toWString(guidArg.getValue(), CP_ACP);
+				engine.setDeviceInfo(false, true, deviceName, connectionName, deviceGuid, deviceName + L" " + connectionName + L" " + deviceGuid);
+				engine.initialize((float)sampleRate, channelCount, channelCount, channelCount, 0, batchsize, customPath);
+
+				double initTime = timer.stop();
+				if (!verbose)
+					printf("\nLoading configuration took %g ms\n", initTime * 1000.0);
+
+				reportStreamingRender(engine, inFile, sweep, streamFrameCount, channelCount, sampleRate, batchsize, output);
+			}
+
+			if (inFile != NULL)
+				sf_close(inFile);
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
 		string input = inputArg.getValue();
 		if (input != "")
 		{
@@ -154,6 +624,52 @@ int main(int argc, char** argv)
 
 		unsigned batchsize = batchsizeArg.getValue();
 
+		string convAccuracy = convAccuracyArg.getValue();
+		if (convAccuracy != "")
+		{
+			reportConvolutionAccuracy(convAccuracy, buf, frameCount, channelCount, batchsize);
+			delete[] buf;
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
+		if (voicemeeterArg.isSet())
+		{
+			reportVoicemeeterSimulation(min(max(voicemeeterArg.getValue(), 1u), 16u), customPath, buf, frameCount, channelCount, sampleRate, max(batchsize, 1u));
+			delete[] buf;
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
+		if (rtsimArg.isSet())
+		{
+			{
+				FilterEngine engine;
+				wstring deviceName = StringHelper::toWString(devicenameArg.getValue(), CP_ACP);
+				wstring connectionName = StringHelper::toWString(connectionnameArg.getValue(), CP_ACP);
+				wstring deviceGuid = StringHelper::toWString(guidArg.getValue(), CP_ACP);
+				engine.setDeviceInfo(false, true, deviceName, connectionName, deviceGuid, deviceName + L" " + connectionName + L" " + deviceGuid);
+
+				unsigned period = max(periodArg.getValue(), 1u);
+				unsigned jitter = min(jitterArg.getValue(), period - 1);
+				engine.initialize((float)sampleRate, channelCount, channelCount, channelCount, channelMask, period + jitter, customPath);
+
+				reportRealtimeSimulation(engine, rtsimArg.getValue(), buf, frameCount, channelCount, sampleRate, period, jitter, reloadArg.getValue() / 1000.0, !noPacingArg.getValue());
+			}
+			delete[] buf;
+
+			if (!noPauseArg.getValue())
+				system("pause");
+
+			return 0;
+		}
+
 		float* buf2 = new float[frameCount * channelCount];
 		for (unsigned i = 0; i < frameCount * channelCount; i++)
 			buf2[i] = 0.0f;
@@ -166,7 +682,7 @@ int main(int argc, char** argv)
 			wstring connectionName = StringHelper::toWString(connectionnameArg.getValue(), CP_ACP);
 			wstring deviceGuid = StringHelper::toWString(guidArg.getValue(), CP_ACP);
 			engine.setDeviceInfo(false, true, deviceName, connectionName, deviceGuid, deviceName + L" " + connectionName + L" " + deviceGuid);
-			engine.initialize((float)sampleRate, channelCount, channelCount, channelCount, channelMask, batchsize);
+			engine.initialize((float)sampleRate, channelCount, channelCount, channelCount, channelMask, batchsize, customPath);
 
 			double initTime = timer.stop();
 			if (!verbose)
@@ -202,15 +718,7 @@ int main(int argc, char** argv)
 				printf(" (%d samples clipped!)", clipCount);
 			printf("\n");
 
-			string output = outputArg.getValue();
-			if (output == "")
-			{
-				char temp[255];
-				GetTempPathA(sizeof(temp) / sizeof(wchar_t), temp);
-
-				output = temp;
-				output += "testout.wav";
-			}
+			string output = getOutputPath(outputArg.getValue());
 
 			printf("\nWriting output to %s\n", output.c_str());
 
@@ -0,0 +1,188 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// uses only the standard library besides the watcher, so that it also checks the inotify implementation on Linux
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../helpers/FileWatcher.h"
+#include "FileWatcherCheck.h"
+
+using namespace std;
+
+// changes of watched files must be reported within this time
+static const chrono::milliseconds reportTimeout(2000);
+// changes that must not be reported are waited for this long
+static const chrono::milliseconds quietTime(300);
+// setFiles is asynchronous, so the checks give the watcher thread this long to apply it
+static const chrono::milliseconds updateTime(200);
+
+class RecordingListener : public IFileChangeListener
+{
+public:
+	void fileChanged(const wstring& path) override
+	{
+		lock_guard<mutex> lock(changesMutex);
+		changes.push_back(path);
+		changesChanged.notify_all();
+	}
+
+	// returns whether path has been reported within timeout
+	bool waitFor(const wstring& path, chrono::milliseconds timeout)
+	{
+		unique_lock<mutex> lock(changesMutex);
+		return changesChanged.wait_for(lock, timeout, [&] {return find(changes.begin(), changes.end(), path) != changes.end();});
+	}
+
+	void clear()
+	{
+		lock_guard<mutex> lock(changesMutex);
+		changes.clear();
+	}
+
+private:
+	mutex changesMutex;
+	condition_variable changesChanged;
+	vector<wstring> changes;
+};
+
+class FileWatcherChecker
+{
+public:
+	FileWatcherChecker(const filesystem::path& directory)
+		: directory(directory)
+	{
+	}
+
+	unsigned run()
+	{
+		FileWatcher* watcher = FileWatcher::create(&listener);
+		if (watcher == NULL)
+		{
+			printf("Could not create file watcher\n");
+			return 1;
+		}
+
+		wstring a = path(L"a.txt");
+		wstring b = path(L"b.txt");
+		wstring c = path(L"c.txt");
+		wstring other = path(L"other.txt");
+		write(a, "a");
+		write(other, "other");
+
+		watcher->setFiles({a, b}, {});
+		this_thread::sleep_for(updateTime);
+
+		write(other, "changed");
+		expect(other, false, L"Change of an unwatched file in a watched directory");
+
+		write(a, "changed");
+		expect(a, true, L"Change of a watched file");
+
+		write(b, "b");
+		expect(b, true, L"Creation of a watched file");
+
+		filesystem::remove(b);
+		expect(b, true, L"Deletion of a watched file");
+
+		// the change may still be pending when the set of files is updated
+		write(a, "changed again");
+		watcher->setFiles({a, b, c}, {});
+		expect(a, true, L"Change of a watched file during an update");
+
+		// c changes after it has been read, but before it is watched
+		watcher->setFiles({a, b}, {});
+		this_thread::sleep_for(updateTime);
+		write(c, "c");
+		unordered_map<wstring, FileState> readStates;
+		readStates[c] = FileState::get(c);
+		write(c, "changed after reading");
+		listener.clear();
+		watcher->setFiles({a, b, c}, readStates);
+		expect(c, true, L"Change of a file between reading and watching it");
+
+		watcher->setFiles({a}, {});
+		this_thread::sleep_for(updateTime);
+		write(c, "changed after unwatching");
+		expect(c, false, L"Change of a file that is not watched anymore");
+
+		delete watcher;
+
+		return failureCount;
+	}
+
+private:
+	wstring path(const wchar_t* name)
+	{
+		return (directory / name).wstring();
+	}
+
+	static void write(const wstring& path, const char* text)
+	{
+		ofstream stream(filesystem::path(path), ios::binary | ios::trunc);
+		stream << text;
+	}
+
+	void expect(const wstring& path, bool reported, const wchar_t* description)
+	{
+		bool found = listener.waitFor(path, reported ? reportTimeout : quietTime);
+		if (found != reported)
+		{
+			printf("%ls was %s\n", description, found ? "reported, but should not" : "not reported");
+			failureCount++;
+		}
+		listener.clear();
+	}
+
+	filesystem::path directory;
+	RecordingListener listener;
+	unsigned failureCount = 0;
+};
+
+bool reportFileWatcherCheck()
+{
+	error_code error;
+	filesystem::path directory = filesystem::temp_directory_path(error) / "EqualizerAPO-FileWatcherCheck";
+	filesystem::remove_all(directory, error);
+	if (!filesystem::create_directories(directory, error))
+	{
+		printf("Could not create directory %s\n", directory.string().c_str());
+		return false;
+	}
+
+	FileWatcherChecker checker(directory);
+	unsigned failureCount = checker.run();
+	filesystem::remove_all(directory, error);
+
+	if (failureCount == 0)
+		printf("File watcher reported exactly the changes of the watched files\n");
+	else
+		printf("File watcher failed %u checks\n", failureCount);
+
+	return failureCount == 0;
+}
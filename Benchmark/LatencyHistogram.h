@@ -0,0 +1,110 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Histogram of durations in nanoseconds like an HDR histogram: each power of two range is split into
+// 128 linear buckets, so every value is resolved to better than 1 % with a fixed amount of memory.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram()
+		: counts(getIndex(~0ull) + 1, 0)
+	{
+	}
+
+	void record(unsigned long long value)
+	{
+		counts[getIndex(value)]++;
+		count++;
+		if (value > max)
+			max = value;
+	}
+
+	unsigned long long getCount() const
+	{
+		return count;
+	}
+
+	unsigned long long getMax() const
+	{
+		return max;
+	}
+
+	// highest value of the bucket that contains the given percentile of the recorded values
+	unsigned long long getPercentile(double percentile) const
+	{
+		if (count == 0)
+			return 0;
+
+		unsigned long long target = (unsigned long long)(percentile / 100.0 * count + 0.5);
+		if (target < 1)
+			target = 1;
+		if (target > count)
+			target = count;
+
+		unsigned long long sum = 0;
+		for (size_t i = 0; i < counts.size(); i++)
+		{
+			sum += counts[i];
+			if (sum >= target)
+			{
+				unsigned long long upper = getLowestValue(i + 1) - 1;
+				return upper < max ? upper : max;
+			}
+		}
+
+		return max;
+	}
+
+private:
+	static const unsigned subBucketBits = 8;
+	static const unsigned long long subBucketCount = 1ull << subBucketBits;
+	static const unsigned long long subBucketHalfCount = subBucketCount / 2;
+
+	static size_t getIndex(unsigned long long value)
+	{
+		if (value < subBucketCount)
+			return (size_t)value;
+
+		unsigned highestBit = 0;
+		while (highestBit < 63 && (value >> (highestBit + 1)) != 0)
+			highestBit++;
+
+		// shift the value into the upper half of the sub-buckets
+		unsigned shift = highestBit - subBucketBits + 1;
+		return (size_t)(shift * subBucketHalfCount + (value >> shift));
+	}
+
+	static unsigned long long getLowestValue(size_t index)
+	{
+		if (index < subBucketCount)
+			return index;
+
+		unsigned shift = (unsigned)(index / subBucketHalfCount - 1);
+		return (index - shift * subBucketHalfCount) << shift;
+	}
+
+	std::vector<unsigned long long> counts;
+	unsigned long long count = 0;
+	unsigned long long max = 0;
+};
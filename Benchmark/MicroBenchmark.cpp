@@ -0,0 +1,451 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define HAS_CYCLE_COUNTER
+#endif
+#include <sndfile.h>
+
+#include "../version.h"
+#include "../helpers/ChannelHelper.h"
+#include "../helpers/MemoryHelper.h"
+#include "../helpers/PrecisionTimer.h"
+#include "../helpers/StringHelper.h"
+#include "../filters/BiQuadFilterFactory.h"
+#include "../filters/ConvolutionFilterFactory.h"
+#include "../filters/CopyFilterFactory.h"
+#include "../filters/DelayFilterFactory.h"
+#include "../filters/GraphicEQFilterFactory.h"
+#include "../filters/IIRFilterFactory.h"
+#include "../filters/PreampFilterFactory.h"
+#include "../filters/loudnessCorrection/LoudnessCorrectionFilterFactory.h"
+#include "../filters/loudnessCorrection/VolumeMonitor.h"
+#include "MicroBenchmark.h"
+
+using namespace std;
+
+static const unsigned channelCounts[] = {1, 2, 6, 8, 16};
+static const unsigned blockSizes[] = {32, 64, 128, 256, 512, 1024, 2048, 4096};
+static const unsigned irLengths[] = {1024, 16384, 131072};
+// each repetition processes at least this many frames, so that short blocks are measured over many calls
+static const unsigned minFramesPerRepetition = 16384;
+static const unsigned warmupRepetitions = 2;
+// master volumes in dB for the loudness correction, independent of the volume of the default device
+static const double loudnessVolume = -20.0;
+static const double alternateLoudnessVolume = -30.0;
+
+// counts allocations by operator new in the whole process, MemoryHelper counts its own allocations with COUNT_ALLOCATIONS, which only the Benchmark defines
+static atomic<unsigned long long> newCount(0);
+
+void* operator new(size_t size)
+{
+	newCount.fetch_add(1, memory_order_relaxed);
+	void* ptr = malloc(size > 0 ? size : 1);
+	if (ptr == NULL)
+		throw bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+static unsigned long long getAllocationCount()
+{
+	return newCount.load(memory_order_relaxed) + MemoryHelper::getAllocationCount();
+}
+
+static unsigned long long readCycleCounter()
+{
+#ifdef HAS_CYCLE_COUNTER
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+struct FilterSpec
+{
+	string name;
+	wstring command;
+	wstring parameters;
+	IFilterFactory* factory;
+	// if set, the volume is changed whenever the previous change has been ramped completely
+	ManualVolumeSource* volumeSource = NULL;
+};
+
+struct MicroBenchmarkResult
+{
+	string name;
+	unsigned channelCount;
+	unsigned blockSize;
+	double minNs;
+	double medianNs;
+	double meanNs;
+	double stddevNs;
+	// time per sample for restoring the input before each block, already subtracted from the other times
+	double overheadNs;
+	// negative if there is no cycle counter
+	double cycles;
+	unsigned long long allocations;
+};
+
+static double median(vector<double> values)
+{
+	sort(values.begin(), values.end());
+	size_t count = values.size();
+	if (count % 2 == 0)
+		return (values[count / 2 - 1] + values[count / 2]) / 2;
+	return values[count / 2];
+}
+
+static bool isSelected(const string& name, const vector<string>& selection)
+{
+	for (const string& s : selection)
+	{
+		if (s == "all" || _stricmp(s.c_str(), name.c_str()) == 0)
+			return true;
+
+		// e.g. Convolution selects all impulse response lengths
+		if (s.size() < name.size() && _strnicmp(s.c_str(), name.c_str(), s.size()) == 0 && name[s.size()] == '-')
+			return true;
+	}
+
+	return false;
+}
+
+static wstring writeImpulseResponse(unsigned length, unsigned sampleRate)
+{
+	char temp[255];
+	GetTempPathA(sizeof(temp), temp);
+	string path = temp;
+	path += "microbenchmark" + to_string(length) + ".wav";
+
+	SF_INFO info = {};
+	info.samplerate = sampleRate;
+	info.channels = 1;
+	info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+	SNDFILE* file = sf_open(path.c_str(), SFM_WRITE, &info);
+	if (file == NULL)
+	{
+		fprintf(stderr, "%s\n", sf_strerror(file));
+		return L"";
+	}
+
+	// noise at a constant level, so that no part is trimmed as pre-delay or silent tail
+	vector<float> ir(length);
+	srand(length);
+	ir[0] = 1.0f;
+	for (unsigned i = 1; i < length; i++)
+		ir[i] = ((float)rand() / RAND_MAX - 0.5f) * 0.5f;
+	sf_writef_float(file, ir.data(), length);
+	sf_close(file);
+
+	return StringHelper::toWString(path, CP_ACP);
+}
+
+static wstring getCopyParameters(unsigned channelCount)
+{
+	// mix each channel with its neighbour
+	wstringstream stream;
+	for (unsigned i = 1; i <= channelCount; i++)
+		stream << i << L"=0.7*" << i << L"+0.3*" << i % channelCount + 1 << L" ";
+	return stream.str();
+}
+
+static void runBlocks(IFilter* filter, double** source, double** input, double** output, unsigned channelCount, unsigned blockSize, unsigned blockCount,
+	ManualVolumeSource* volumeSource = NULL, unsigned volumeChangeInterval = 0)
+{
+	unsigned framesSinceVolumeChange = 0;
+	for (unsigned i = 0; i < blockCount; i++)
+	{
+		// in-place filters would otherwise process their own output, which might decay to denormals or grow
+		for (unsigned j = 0; j < channelCount; j++)
+			memcpy(input[j], source[j], blockSize * sizeof(double));
+
+		if (volumeSource != NULL)
+		{
+			// the coefficients are calculated on this thread, like on the notification thread of the endpoint
+			framesSinceVolumeChange += blockSize;
+			if (framesSinceVolumeChange >= volumeChangeInterval)
+			{
+				double volume;
+				volumeSource->getVolume(volume);
+				volumeSource->setVolume(volume == loudnessVolume ? alternateLoudnessVolume : loudnessVolume);
+				framesSinceVolumeChange = 0;
+			}
+		}
+
+		if (filter != NULL)
+			filter->process(output, input, blockSize);
+	}
+}
+
+static bool measure(const FilterSpec& spec, unsigned sampleRate, unsigned channelCount, unsigned blockSize, unsigned repetitions, MicroBenchmarkResult& result)
+{
+	wstring command = spec.command;
+	wstring parameters = spec.command == L"Copy" ? getCopyParameters(channelCount) : spec.parameters;
+	vector<IFilter*> filters = spec.factory->createFilter(L"", command, parameters);
+	if (filters.size() != 1)
+	{
+		for (IFilter* filter : filters)
+		{
+			filter->~IFilter();
+			MemoryHelper::free(filter);
+		}
+		return false;
+	}
+
+	IFilter* filter = filters[0];
+	vector<wstring> channelNames = ChannelHelper::getChannelNames(channelCount, ChannelHelper::getDefaultChannelMask(channelCount));
+	vector<wstring> outChannelNames = filter->initialize((float)sampleRate, blockSize, channelNames);
+	unsigned outChannelCount = filter->getInPlace() ? channelCount : (unsigned)outChannelNames.size();
+
+	double** source = new double*[channelCount];
+	double** input = new double*[channelCount];
+	double** output = new double*[outChannelCount];
+	srand(channelCount);
+	for (unsigned i = 0; i < channelCount; i++)
+	{
+		source[i] = (double*)MemoryHelper::alloc(blockSize * sizeof(double));
+		input[i] = (double*)MemoryHelper::alloc(blockSize * sizeof(double));
+		for (unsigned j = 0; j < blockSize; j++)
+			source[i][j] = ((double)rand() / RAND_MAX - 0.5) * 0.5;
+	}
+	for (unsigned i = 0; i < outChannelCount; i++)
+		output[i] = filter->getInPlace() ? input[i] : (double*)MemoryHelper::alloc(blockSize * sizeof(double));
+
+	unsigned blockCount = max(minFramesPerRepetition / blockSize, 1u);
+	double sampleCount = (double)blockCount * blockSize * channelCount;
+	// the loudness correction ramps its coefficients over 20 ms after a volume change
+	unsigned volumeChangeInterval = sampleRate / 50;
+
+	PrecisionTimer timer;
+	for (unsigned i = 0; i < warmupRepetitions; i++)
+		runBlocks(filter, source, input, output, channelCount, blockSize, blockCount, spec.volumeSource, volumeChangeInterval);
+
+	vector<double> overheadTimes;
+	vector<double> overheadCycles;
+	for (unsigned i = 0; i < repetitions; i++)
+	{
+		unsigned long long startCycles = readCycleCounter();
+		timer.start();
+		runBlocks(NULL, source, input, output, channelCount, blockSize, blockCount);
+		overheadTimes.push_back(timer.stop());
+		overheadCycles.push_back((double)(readCycleCounter() - startCycles));
+	}
+	double overheadTime = median(overheadTimes);
+	double overheadCycleCount = median(overheadCycles);
+
+	vector<double> times;
+	vector<double> cycles;
+	unsigned long long allocationsBefore = getAllocationCount();
+	for (unsigned i = 0; i < repetitions; i++)
+	{
+		unsigned long long startCycles = readCycleCounter();
+		timer.start();
+		runBlocks(filter, source, input, output, channelCount, blockSize, blockCount, spec.volumeSource, volumeChangeInterval);
+		double time = timer.stop();
+		double cycleCount = (double)(readCycleCounter() - startCycles);
+
+		times.push_back(max(time - overheadTime, 0.0) * 1e9 / sampleCount);
+		cycles.push_back(max(cycleCount - overheadCycleCount, 0.0) / sampleCount);
+	}
+	result.allocations = getAllocationCount() - allocationsBefore;
+
+	result.name = spec.name;
+	result.channelCount = channelCount;
+	result.blockSize = blockSize;
+	result.minNs = *min_element(times.begin(), times.end());
+	result.medianNs = median(times);
+	double sum = 0.0;
+	for (double time : times)
+		sum += time;
+	result.meanNs = sum / repetitions;
+	double squareSum = 0.0;
+	for (double time : times)
+		squareSum += (time - result.meanNs) * (time - result.meanNs);
+	result.stddevNs = repetitions > 1 ? sqrt(squareSum / (repetitions - 1)) : 0.0;
+	result.overheadNs = overheadTime * 1e9 / sampleCount;
+#ifdef HAS_CYCLE_COUNTER
+	result.cycles = median(cycles);
+#else
+	result.cycles = -1.0;
+#endif
+
+	for (unsigned i = 0; i < channelCount; i++)
+	{
+		MemoryHelper::free(source[i]);
+		MemoryHelper::free(input[i]);
+	}
+	if (!filter->getInPlace())
+	{
+		for (unsigned i = 0; i < outChannelCount; i++)
+			MemoryHelper::free(output[i]);
+	}
+	delete[] source;
+	delete[] input;
+	delete[] output;
+
+	filter->~IFilter();
+	MemoryHelper::free(filter);
+
+	return true;
+}
+
+static void writeJson(const string& path, const vector<MicroBenchmarkResult>& results, unsigned sampleRate, unsigned repetitions)
+{
+	FILE* fp = fopen(path.c_str(), "w");
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Could not write %s\n", path.c_str());
+		return;
+	}
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"version\": \"%d.%d.%d\",\n", MAJOR, MINOR, REVISION);
+#ifdef _WIN64
+	fprintf(fp, "  \"architecture\": \"%s\",\n", "64-bit");
+#else
+	fprintf(fp, "  \"architecture\": \"%s\",\n", "32-bit");
+#endif
+	fprintf(fp, "  \"sampleRate\": %d,\n", sampleRate);
+	fprintf(fp, "  \"warmupRepetitions\": %d,\n", warmupRepetitions);
+	fprintf(fp, "  \"repetitions\": %d,\n", repetitions);
+	fprintf(fp, "  \"minFramesPerRepetition\": %d,\n", minFramesPerRepetition);
+	fprintf(fp, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const MicroBenchmarkResult& r = results[i];
+		fprintf(fp, "    {\"filter\": \"%s\", \"channels\": %d, \"blockSize\": %d, ", r.name.c_str(), r.channelCount, r.blockSize);
+		fprintf(fp, "\"nsPerSample\": {\"min\": %.4f, \"median\": %.4f, \"mean\": %.4f, \"stddev\": %.4f}, ", r.minNs, r.medianNs, r.meanNs, r.stddevNs);
+		fprintf(fp, "\"overheadNsPerSample\": %.4f, ", r.overheadNs);
+		if (r.cycles >= 0.0)
+			fprintf(fp, "\"cyclesPerSample\": %.4f, ", r.cycles);
+		else
+			fprintf(fp, "\"cyclesPerSample\": null, ");
+		fprintf(fp, "\"allocations\": %llu}%s\n", r.allocations, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	fclose(fp);
+
+	printf("\nWrote results to %s\n", path.c_str());
+}
+
+void reportMicroBenchmarks(const string& filterSelection, unsigned sampleRate, unsigned repetitions, const string& jsonPath)
+{
+	vector<string> selection;
+	stringstream selectionStream(filterSelection);
+	string item;
+	while (getline(selectionStream, item, ','))
+		selection.push_back(item);
+
+	BiQuadFilterFactory biQuadFactory;
+	IIRFilterFactory iirFactory;
+	PreampFilterFactory preampFactory;
+	DelayFilterFactory delayFactory;
+	CopyFilterFactory copyFactory;
+	ConvolutionFilterFactory convolutionFactory;
+	GraphicEQFilterFactory graphicEQFactory;
+	LoudnessCorrectionFilterFactory loudnessCorrectionFactory;
+
+	vector<FilterSpec> specs;
+	specs.push_back({"BiQuad", L"Filter", L"ON PK Fc 1000 Hz Gain 3 dB Q 1", &biQuadFactory});
+	specs.push_back({"IIR", L"Filter", L"ON IIR Order 2 Coefficients 0.0675 0.1349 0.0675 1 -1.143 0.4128", &iirFactory});
+	specs.push_back({"Preamp", L"Preamp", L"-3 dB", &preampFactory});
+	specs.push_back({"Delay", L"Delay", L"10 ms", &delayFactory});
+	specs.push_back({"Copy", L"Copy", L"", &copyFactory});
+	vector<wstring> irPaths;
+	for (unsigned irLength : irLengths)
+	{
+		string name = "Convolution-" + to_string(irLength);
+		if (!isSelected(name, selection))
+			continue;
+
+		wstring irPath = writeImpulseResponse(irLength, sampleRate);
+		if (irPath.empty())
+			continue;
+		irPaths.push_back(irPath);
+		specs.push_back({name, L"Convolution", irPath, &convolutionFactory});
+	}
+	specs.push_back({"GraphicEQ", L"GraphicEQ", L"25 -3; 100 2; 1000 0; 4000 -2; 10000 4", &graphicEQFactory});
+	// the volume monitor takes ownership of the source and reports its volume instead of the one of the default device
+	ManualVolumeSource* volumeSource = new ManualVolumeSource(loudnessVolume);
+	VolumeMonitor::getInstance().setSource(volumeSource);
+	specs.push_back({"LoudnessCorrection", L"LoudnessCorrection", L"State 1 ReferenceLevel 75 ReferenceOffset 0 Attenuation 1", &loudnessCorrectionFactory});
+	specs.push_back({"LoudnessCorrection-Ramp", L"LoudnessCorrection", L"State 1 ReferenceLevel 75 ReferenceOffset 0 Attenuation 1", &loudnessCorrectionFactory, volumeSource});
+
+	printf("\nMeasuring filters individually at %d Hz with %d warmup and %d measured repetitions of at least %d frames\n",
+		sampleRate, warmupRepetitions, repetitions, minFramesPerRepetition);
+	printf("Times are per sample of one channel, the time for restoring the input before each block is subtracted\n\n");
+
+	vector<MicroBenchmarkResult> results;
+	for (const FilterSpec& spec : specs)
+	{
+		if (!isSelected(spec.name, selection))
+			continue;
+
+		bool created = true;
+		for (unsigned channelCount : channelCounts)
+		{
+			for (unsigned blockSize : blockSizes)
+			{
+				MicroBenchmarkResult result;
+				created = measure(spec, sampleRate, channelCount, blockSize, repetitions, result);
+				if (!created)
+					break;
+
+				printf("%-24s %2d ch %4d frames: %8.3f ns median, %8.3f min, %7.3f stddev",
+					result.name.c_str(), channelCount, blockSize, result.medianNs, result.minNs, result.stddevNs);
+				if (result.cycles >= 0.0)
+					printf(", %7.2f cycles", result.cycles);
+				printf(", %llu allocations\n", result.allocations);
+
+				results.push_back(result);
+			}
+
+			if (!created)
+			{
+				fprintf(stderr, "Could not create %s filter\n", spec.name.c_str());
+				break;
+			}
+		}
+	}
+
+	VolumeMonitor::getInstance().setSource(NULL);
+
+	for (const wstring& irPath : irPaths)
+		DeleteFileW(irPath.c_str());
+
+	if (!jsonPath.empty())
+		writeJson(jsonPath, results, sampleRate, repetitions);
+}
@@ -0,0 +1,298 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../helpers/ConfigFile.h"
+#include "../helpers/MemoryHelper.h"
+#include "../helpers/StringHelper.h"
+#include "../filters/BiQuadFilterFactory.h"
+#include "../filters/GraphicEQFilter.h"
+#include "../filters/GraphicEQFilterFactory.h"
+#include "ParseCheck.h"
+
+using namespace std;
+
+// the regular expressions as BiQuadFilterFactory, GraphicEQFilterFactory and DeviceFilterFactory used them
+static const wregex regexType(L"^\\s*ON\\s+([A-Za-z]+)");
+static const wregex regexFreq(L"\\s+Fc\\s*([-+0-9.eE\u00A0]+)\\s*H\\s*z");
+static const wregex regexGain(L"\\s+Gain\\s*([-+0-9.eE]+)\\s*dB");
+static const wregex regexQ(L"\\s+Q\\s*([-+0-9.eE]+)");
+static const wregex regexBW(L"\\s+BW\\s+Oct\\s*([-+0-9.eE]+)");
+static const wregex regexSlope(L"^\\s*([-+0-9.eE]+)\\s*dB");
+static const wregex regexNumber(L"[-+0-9.eE]+");
+static const wregex regexGuid(L"\\{[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}\\}");
+
+// lines for the cases that the sample configurations do not contain
+static const wchar_t* builtInLines[] = {
+	L"Filter 1: ON PK Fc 1.000 Hz Gain 2 dB Q 0.7",
+	L"Filter 2: ON PK Fc 1\u00A0000 Hz Gain 2,5 dB Q 0,7",
+	L"Filter: ON PK Fc 1000Hz Gain -2dB Q 4.0",
+	L"Filter: ON PK Fc 1000 H z Gain 1 dB BW Oct 0.5",
+	L"Filter: ON LS 6dB Fc 100 Hz Gain 3 dB",
+	L"Filter: ON HSC Fc 8000 Hz Gain -4 dB Q 0.7",
+	L"Filter: ON BP Fc 300 Hz BW Oct 2",
+	L"Filter:   ON   PK   Fc   100   Hz   Gain   1   dB   Q   1",
+	L"Filter: ON PK\tFc\t100\tHz\tGain\t-1\tdB\tQ\t2",
+	L"Filter: ON PK Fcx 50 Hz Fc 60 Hz Gain x Gain 4 dB Q 1 Q 2",
+	L"Filter: ON PK Fc 1e3 Hz Gain 1e0 dB Q 1e0",
+	L"Filter: ON PK Fc 60 Hz Gain 4 dB BW  Oct1 QE 2 Q0.3",
+	L"Filter: ON LS 6 d B Fc 100 Hz Gain 3 dB",
+	L"Filter: ONPK Fc 100 Hz Gain 3 dB Q 1",
+	L"Filter: ON PK2 Fc - Hz Gain 3 dB Q 1",
+	L"Filter: OFF PK Fc 100 Hz Gain 1 dB Q 1",
+	L"GraphicEQ: 25 -3,0; 40 -2.5; 63",
+	L"GraphicEQ: e 25 -3; E+ 1; 1e4 -3 ;2e4 5 ; 30000 -1.5e1",
+	L"Device: Realtek {01234567-89ab-cdef-0123-456789ABCDEF} Speakers {0123}",
+	L"Device: {01234567-89AB-CDEF-0123-456789abcdef}{01234567-89ab-cdef-0123-456789abcdeg}",
+};
+
+// characters inserted by the variations, besides the ones of the line itself
+static const wchar_t variationCharacters[] = L" \t\u00A0.,-+eE0123456789{}abcdefFGHQBOcinoatz";
+static const unsigned variationCount = 200;
+// differences beyond this are only counted
+static const unsigned maxReportedDifferences = 20;
+
+class ParseChecker
+{
+public:
+	ParseChecker()
+		: random(1234)
+	{
+	}
+
+	void checkLine(const wstring& line)
+	{
+		size_t colon = line.find(L':');
+		if (colon == wstring::npos)
+			return;
+
+		wstring command = line.substr(0, colon);
+		size_t commandStart = command.find_first_not_of(L" \t");
+		size_t commandEnd = command.find_last_not_of(L" \t");
+		command = commandStart == wstring::npos ? L"" : command.substr(commandStart, commandEnd - commandStart + 1);
+		wstring parameters = line.substr(colon + 1);
+
+		check(command, parameters);
+		for (unsigned i = 0; i < variationCount; i++)
+			check(command, vary(parameters));
+	}
+
+	unsigned getLineCount() {return lineCount;}
+	unsigned getDifferingLineCount() {return differingLineCount;}
+
+private:
+	// inserts, removes or duplicates up to three characters
+	wstring vary(const wstring& s)
+	{
+		wstring result = s;
+		unsigned changeCount = random() % 3 + 1;
+		for (unsigned i = 0; i < changeCount; i++)
+		{
+			size_t pos = random() % (result.length() + 1);
+			switch (random() % 3)
+			{
+			case 0:
+				result.insert(pos, 1, variationCharacters[random() % (sizeof(variationCharacters) / sizeof(variationCharacters[0]) - 1)]);
+				break;
+			case 1:
+				if (pos < result.length())
+					result.erase(pos, 1);
+				break;
+			case 2:
+				if (pos < result.length())
+					result.insert(pos, 1, result[pos]);
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	void check(const wstring& command, const wstring& parameters)
+	{
+		lineCount++;
+		unsigned previousDifferenceCount = differenceCount;
+
+		wstring expectedNoGuid = regex_replace(parameters, regexGuid, L"");
+		wstring actualNoGuid = StringHelper::removeGuids(parameters);
+		if (actualNoGuid != expectedNoGuid)
+			reportDifference(command, parameters, L"without GUIDs", expectedNoGuid, actualNoGuid);
+
+		if (command.find(L"Filter") == 0)
+			checkFilter(command, StringHelper::replaceCharacters(parameters, L",", L"."));
+		else if (command == L"GraphicEQ")
+			checkGraphicEQ(command, parameters);
+
+		if (differenceCount > previousDifferenceCount)
+			differingLineCount++;
+	}
+
+	void checkFilter(const wstring& command, const wstring& parameters)
+	{
+		BiQuadFilterFactory::FilterStrings expected;
+		wsmatch match;
+		bool expectedFound = regex_search(parameters, match, regexType);
+		if (expectedFound)
+		{
+			expected.type = match.str(1);
+			expected.rest = match.suffix().str();
+			if (regex_search(expected.rest, match, regexFreq))
+				expected.freq = match.str(1);
+			if (regex_search(expected.rest, match, regexGain))
+				expected.gain = match.str(1);
+			if (regex_search(expected.rest, match, regexQ))
+				expected.q = match.str(1);
+			if (regex_search(expected.rest, match, regexBW))
+				expected.bw = match.str(1);
+			if (regex_search(expected.rest, match, regexSlope))
+				expected.slope = match.str(1);
+		}
+
+		BiQuadFilterFactory::FilterStrings actual;
+		bool actualFound = BiQuadFilterFactory::scanFilterStrings(parameters, actual);
+		if (actualFound != expectedFound)
+		{
+			reportDifference(command, parameters, L"type found", expectedFound ? L"true" : L"false", actualFound ? L"true" : L"false");
+			return;
+		}
+
+		compare(command, parameters, L"type", expected.type, actual.type);
+		compare(command, parameters, L"rest", expected.rest, actual.rest);
+		compare(command, parameters, L"Fc", expected.freq, actual.freq);
+		compare(command, parameters, L"Gain", expected.gain, actual.gain);
+		compare(command, parameters, L"Q", expected.q, actual.q);
+		compare(command, parameters, L"BW Oct", expected.bw, actual.bw);
+		compare(command, parameters, L"slope", expected.slope, actual.slope);
+	}
+
+	void checkGraphicEQ(const wstring& command, const wstring& parameters)
+	{
+		wstring value = parameters;
+		if (value.find(L'.') == wstring::npos)
+			value = StringHelper::replaceCharacters(value, L",", L".");
+
+		vector<wstring> numbers;
+		for (wsregex_iterator it(value.begin(), value.end(), regexNumber); it != wsregex_iterator(); it++)
+			numbers.push_back(it->str(0));
+		vector<FilterNode> expected;
+		for (size_t i = 0; i + 1 < numbers.size(); i += 2)
+			expected.push_back(FilterNode(wcstod(numbers[i].c_str(), NULL), wcstod(numbers[i + 1].c_str(), NULL)));
+		sort(expected.begin(), expected.end());
+
+		GraphicEQFilterFactory factory;
+		wstring factoryCommand = command;
+		wstring factoryParameters = parameters;
+		vector<IFilter*> filters = factory.createFilter(L"", factoryCommand, factoryParameters);
+		vector<FilterNode> actual;
+		if (filters.size() == 1)
+			actual = ((GraphicEQFilter*)filters[0])->getNodes();
+		for (IFilter* filter : filters)
+		{
+			filter->~IFilter();
+			MemoryHelper::free(filter);
+		}
+
+		bool equal = actual.size() == expected.size();
+		for (size_t i = 0; equal && i < actual.size(); i++)
+			equal = actual[i].freq == expected[i].freq && actual[i].dbGain == expected[i].dbGain;
+		if (!equal)
+			reportDifference(command, parameters, L"nodes", toString(expected), toString(actual));
+	}
+
+	static wstring toString(const vector<FilterNode>& nodes)
+	{
+		wstringstream stream;
+		stream.precision(17);
+		for (const FilterNode& node : nodes)
+			stream << node.freq << L" " << node.dbGain << L"; ";
+
+		return stream.str();
+	}
+
+	void compare(const wstring& command, const wstring& parameters, const wchar_t* what, const wstring& expected, const wstring& actual)
+	{
+		if (actual != expected)
+			reportDifference(command, parameters, what, expected, actual);
+	}
+
+	void reportDifference(const wstring& command, const wstring& parameters, const wchar_t* what, const wstring& expected, const wstring& actual)
+	{
+		differenceCount++;
+		if (differenceCount <= maxReportedDifferences)
+		{
+			printf("%s of \"%s:%s\" is \"%s\" instead of \"%s\"\n", StringHelper::toString(what, CP_UTF8).c_str(),
+				StringHelper::toString(command, CP_UTF8).c_str(), StringHelper::toString(parameters, CP_UTF8).c_str(),
+				StringHelper::toString(actual, CP_UTF8).c_str(), StringHelper::toString(expected, CP_UTF8).c_str());
+		}
+	}
+
+	mt19937 random;
+	unsigned lineCount = 0;
+	unsigned differenceCount = 0;
+	unsigned differingLineCount = 0;
+};
+
+bool reportParseCheck(const wstring& configDirectory)
+{
+	ParseChecker checker;
+	unsigned fileCount = 0;
+	error_code error;
+	for (const filesystem::directory_entry& entry : filesystem::directory_iterator(configDirectory, error))
+	{
+		if (entry.path().extension() != L".txt")
+			continue;
+
+		shared_ptr<const ConfigFile> file = ConfigFile::load(entry.path().wstring());
+		if (file == NULL)
+		{
+			fprintf(stderr, "Could not read %s\n", StringHelper::toString(entry.path().wstring(), CP_UTF8).c_str());
+			continue;
+		}
+
+		fileCount++;
+		const wstring& text = file->getText();
+		for (const ConfigFile::Line& line : file->getLines())
+			checker.checkLine(text.substr(line.offset, line.length));
+	}
+	if (error)
+	{
+		fprintf(stderr, "Could not list %s\n", StringHelper::toString(configDirectory, CP_UTF8).c_str());
+		return false;
+	}
+
+	for (const wchar_t* line : builtInLines)
+		checker.checkLine(line);
+
+	unsigned differingLineCount = checker.getDifferingLineCount();
+	if (differingLineCount == 0)
+		printf("The scanners match the former regular expressions on %u lines from %u files, built-in lines and their variations\n", checker.getLineCount(), fileCount);
+	else
+		printf("The scanners differ from the former regular expressions in %u of %u lines\n", differingLineCount, checker.getLineCount());
+
+	return differingLineCount == 0;
+}
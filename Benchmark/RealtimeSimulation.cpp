@@ -0,0 +1,209 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <avrt.h>
+
+#include "../FilterEngine.h"
+#include "../helpers/PrecisionTimer.h"
+#include "LatencyHistogram.h"
+#include "RealtimeSimulation.h"
+
+#pragma comment(lib, "avrt.lib")
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+using namespace std;
+
+struct ReloadState
+{
+	FilterEngine* engine;
+	double interval;
+	atomic<bool> stop;
+	atomic<bool> finished;
+	atomic<unsigned> count;
+};
+
+static void reloadThread(ReloadState* state)
+{
+	PrecisionTimer timer;
+	while (!state->stop)
+	{
+		timer.start();
+		while (!state->stop && timer.stop() < state->interval)
+			Sleep(1);
+
+		if (state->stop)
+			break;
+
+		// like the change notification thread of the engine
+		state->engine->reloadConfig();
+		state->count++;
+	}
+
+	state->finished = true;
+}
+
+static void waitUntil(PrecisionTimer& clock, double time, HANDLE waitTimer)
+{
+	// sleep for most of the time and spin for the rest, as the timer may wake up late
+	double remaining = time - clock.stop();
+	if (waitTimer != NULL && remaining > 0.002)
+	{
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -(long long)((remaining - 0.0015) * 1e7);
+		if (SetWaitableTimer(waitTimer, &dueTime, 0, NULL, NULL, false))
+			WaitForSingleObject(waitTimer, INFINITE);
+	}
+
+	while (clock.stop() < time)
+		YieldProcessor();
+}
+
+static void printPercentiles(const char* title, const LatencyHistogram& histogram, double period)
+{
+	printf("%s of %llu callbacks:\n", title, histogram.getCount());
+
+	const double percentiles[] = {50.0, 99.0, 99.9};
+	for (double percentile : percentiles)
+	{
+		double time = histogram.getPercentile(percentile) / 1e9;
+		printf("  p%-6g %9.3f ms, %6.1f %% of period\n", percentile, time * 1000.0, time / period * 100.0);
+	}
+
+	double maxTime = histogram.getMax() / 1e9;
+	printf("  max     %9.3f ms, %6.1f %% of period\n", maxTime * 1000.0, maxTime / period * 100.0);
+}
+
+void reportRealtimeSimulation(FilterEngine& engine, double seconds, const float* buf, unsigned frameCount, unsigned channelCount,
+	unsigned sampleRate, unsigned period, unsigned jitter, double reloadInterval, bool pacing)
+{
+	double periodTime = (double)period / sampleRate;
+	printf("\nSimulating callbacks with %d", period);
+	if (jitter > 0)
+		printf(" +- %d", jitter);
+	printf(" frames (%g ms period) for %g seconds %s\n", periodTime * 1000.0, seconds, pacing ? "in real time" : "without pauses");
+	if (reloadInterval > 0.0)
+		printf("Reloading the configuration every %g ms\n", reloadInterval * 1000.0);
+
+	unsigned maxFrameCount = period + jitter;
+	float* input = new float[maxFrameCount * channelCount];
+	float* output = new float[maxFrameCount * channelCount];
+
+	ReloadState reloadState;
+	reloadState.engine = &engine;
+	reloadState.interval = reloadInterval;
+	reloadState.stop = false;
+	reloadState.finished = reloadInterval <= 0.0;
+	reloadState.count = 0;
+	thread reloader;
+	if (reloadInterval > 0.0)
+		reloader = thread(reloadThread, &reloadState);
+
+	// the priority of the audio engine's processing thread
+	DWORD taskIndex = 0;
+	HANDLE avrtHandle = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
+	if (avrtHandle != NULL)
+		AvSetMmThreadPriority(avrtHandle, AVRT_PRIORITY_CRITICAL);
+	HANDLE waitTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+	LatencyHistogram histogram;
+	LatencyHistogram transitionHistogram;
+	unsigned long long missedDeadlines = 0;
+	unsigned long long processedFrames = 0;
+	unsigned long long targetFrames = (unsigned long long)(seconds * sampleRate);
+	size_t position = 0;
+	srand(0);
+
+	PrecisionTimer clock;
+	PrecisionTimer blockTimer;
+	clock.start();
+	double nextStart = 0.0;
+	while (processedFrames < targetFrames)
+	{
+		unsigned frames = period;
+		if (jitter > 0)
+			frames = period - jitter + rand() % (2 * jitter + 1);
+
+		for (unsigned i = 0; i < frames; i++)
+		{
+			for (unsigned j = 0; j < channelCount; j++)
+				input[i * channelCount + j] = buf[position * channelCount + j];
+			position = (position + 1) % frameCount;
+		}
+
+		if (pacing)
+			waitUntil(clock, nextStart, waitTimer);
+
+		bool transition = engine.isInTransition();
+		blockTimer.start();
+		engine.process(output, input, frames);
+		double time = blockTimer.stop();
+
+		unsigned long long nanoseconds = (unsigned long long)(time * 1e9);
+		histogram.record(nanoseconds);
+		if (transition)
+			transitionHistogram.record(nanoseconds);
+		if (time > (double)frames / sampleRate)
+			missedDeadlines++;
+
+		processedFrames += frames;
+		nextStart += (double)frames / sampleRate;
+
+		// like a host after a dropout, continue with the next period instead of catching up
+		double now = clock.stop();
+		if (now > nextStart + periodTime)
+			nextStart = now;
+	}
+	double totalTime = clock.stop();
+
+	// a pending reload only finishes after the transition to the last configuration
+	reloadState.stop = true;
+	while (!reloadState.finished)
+		engine.process(output, input, period);
+	if (reloader.joinable())
+		reloader.join();
+
+	if (waitTimer != NULL)
+		CloseHandle(waitTimer);
+	if (avrtHandle != NULL)
+		AvRevertMmThreadCharacteristics(avrtHandle);
+
+	delete[] input;
+	delete[] output;
+
+	printf("Processed %llu frames in %g seconds\n\n", processedFrames, totalTime);
+	printPercentiles("Processing time", histogram, periodTime);
+	printf("%llu callbacks (%g %%) took longer than their period\n", missedDeadlines, missedDeadlines * 100.0 / histogram.getCount());
+
+	if (reloadInterval > 0.0)
+	{
+		printf("\nReloaded the configuration %d times\n", (unsigned)reloadState.count);
+		if (transitionHistogram.getCount() > 0)
+			printPercentiles("Processing time during transitions", transitionHistogram, periodTime);
+	}
+}
@@ -0,0 +1,29 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+class FilterEngine;
+
+// Calls process of the initialized engine like an audio host, with blocks of period +- jitter frames of interleaved
+// float samples that are passed in real time unless pacing is disabled. Reports the distribution of processing times
+// relative to the period and, if reloadInterval is greater than zero, reloads the configuration in that interval
+// to show the processing times during transitions separately.
+void reportRealtimeSimulation(FilterEngine& engine, double seconds, const float* buf, unsigned frameCount, unsigned channelCount,
+	unsigned sampleRate, unsigned period, unsigned jitter, double reloadInterval, bool pacing);
@@ -0,0 +1,351 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <malloc.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "../helpers/SimdHelper.h"
+#include "../helpers/StringHelper.h"
+#include "SimdCheck.h"
+
+using namespace std;
+
+// only the fused multiply-add and the order of additions may differ from the scalar kernels
+static const double doubleTolerance = 1e-10;
+static const double floatTolerance = 1e-5;
+// mismatches of the same kernel beyond these are only counted
+static const unsigned maxPrintedMismatches = 5;
+
+template<class T>
+class AlignedBuffer
+{
+public:
+	AlignedBuffer(size_t count)
+		: data((T*)_aligned_malloc(max(count, (size_t)1) * sizeof(T), 64))
+	{
+	}
+
+	~AlignedBuffer()
+	{
+		_aligned_free(data);
+	}
+
+	AlignedBuffer(const AlignedBuffer&) = delete;
+	AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+	T* data;
+};
+
+class SimdChecker
+{
+public:
+	SimdChecker(const SimdKernels& kernels, const SimdKernels& reference)
+		: kernels(kernels), reference(reference), random(1234)
+	{
+		levelName = StringHelper::toString(SimdHelper::getLevelName(kernels.level), CP_ACP);
+	}
+
+	unsigned run()
+	{
+		vector<size_t> counts;
+		for (size_t count = 0; count < 68; count++)
+			counts.push_back(count);
+		for (size_t count : {127, 128, 129, 1000, 4099})
+			counts.push_back(count);
+
+		for (size_t count : counts)
+		{
+			checkConversions(count);
+			checkComplex(count);
+			checkMix((unsigned)count);
+		}
+		for (unsigned channelCount = 1; channelCount < 20; channelCount++)
+		{
+			for (unsigned frameCount : {0, 1, 2, 3, 17, 256})
+			{
+				checkBiQuad(channelCount, frameCount);
+			}
+		}
+
+		return mismatchCount;
+	}
+
+private:
+	double next()
+	{
+		return distribution(random);
+	}
+
+	template<class T>
+	void fill(T* data, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			data[i] = (T)next();
+	}
+
+	template<class T>
+	void compare(const char* kernel, size_t count, const T* expected, const T* actual, size_t valueCount, double tolerance)
+	{
+		for (size_t i = 0; i < valueCount; i++)
+		{
+			double difference = fabs((double)actual[i] - (double)expected[i]);
+			if (difference > tolerance * max(1.0, fabs((double)expected[i])) || actual[i] != actual[i])
+			{
+				if (mismatchCount < maxPrintedMismatches)
+					printf("%s of %s differs for size %u at %u: %.17g instead of %.17g\n", kernel, levelName.c_str(), (unsigned)count, (unsigned)i, (double)actual[i], (double)expected[i]);
+				mismatchCount++;
+				return;
+			}
+		}
+	}
+
+	void checkConversions(size_t count)
+	{
+		vector<float> floats(count), expectedFloats(count), actualFloats(count);
+		vector<double> doubles(count), expected(count), actual(count);
+		fill(floats.data(), count);
+		fill(doubles.data(), count);
+
+		reference.convertFloatToDouble(expected.data(), floats.data(), count);
+		kernels.convertFloatToDouble(actual.data(), floats.data(), count);
+		compare("convertFloatToDouble", count, expected.data(), actual.data(), count, 0.0);
+
+		reference.convertDoubleToFloat(expectedFloats.data(), doubles.data(), count);
+		kernels.convertDoubleToFloat(actualFloats.data(), doubles.data(), count);
+		compare("convertDoubleToFloat", count, expectedFloats.data(), actualFloats.data(), count, 0.0);
+
+		reference.scale(expected.data(), doubles.data(), 0.3, count);
+		kernels.scale(actual.data(), doubles.data(), 0.3, count);
+		compare("scale", count, expected.data(), actual.data(), count, 0.0);
+
+		// in place like PreampFilter
+		expected = doubles;
+		actual = doubles;
+		reference.scale(expected.data(), expected.data(), -1.7, count);
+		kernels.scale(actual.data(), actual.data(), -1.7, count);
+		compare("scale in place", count, expected.data(), actual.data(), count, 0.0);
+
+		vector<double> a(count), b(count);
+		fill(a.data(), count);
+		fill(b.data(), count);
+		double expectedSum = reference.dotProduct(a.data(), b.data(), count);
+		double actualSum = kernels.dotProduct(a.data(), b.data(), count);
+		compare("dotProduct", count, &expectedSum, &actualSum, 1, doubleTolerance * max((size_t)1, count));
+	}
+
+	void checkComplex(size_t count)
+	{
+		vector<double> complex(2 * count), expectedReal(count), expectedImag(count), actualReal(count), actualImag(count);
+		fill(complex.data(), 2 * count);
+		reference.deinterleave(expectedReal.data(), expectedImag.data(), complex.data(), count);
+		kernels.deinterleave(actualReal.data(), actualImag.data(), complex.data(), count);
+		compare("deinterleave", count, expectedReal.data(), actualReal.data(), count, 0.0);
+		compare("deinterleave", count, expectedImag.data(), actualImag.data(), count, 0.0);
+
+		vector<float> complexFloat(2 * count), expectedRealFloat(count), expectedImagFloat(count), actualRealFloat(count), actualImagFloat(count);
+		fill(complexFloat.data(), 2 * count);
+		reference.deinterleaveFloat(expectedRealFloat.data(), expectedImagFloat.data(), complexFloat.data(), count);
+		kernels.deinterleaveFloat(actualRealFloat.data(), actualImagFloat.data(), complexFloat.data(), count);
+		compare("deinterleaveFloat", count, expectedRealFloat.data(), actualRealFloat.data(), count, 0.0);
+		compare("deinterleaveFloat", count, expectedImagFloat.data(), actualImagFloat.data(), count, 0.0);
+
+		vector<double> xReal(count), xImag(count), hReal(count), hImag(count);
+		fill(xReal.data(), count);
+		fill(xImag.data(), count);
+		fill(hReal.data(), count);
+		fill(hImag.data(), count);
+		fill(expectedReal.data(), count);
+		fill(expectedImag.data(), count);
+		actualReal = expectedReal;
+		actualImag = expectedImag;
+		reference.complexMultiplyAdd(expectedReal.data(), expectedImag.data(), xReal.data(), xImag.data(), hReal.data(), hImag.data(), count);
+		kernels.complexMultiplyAdd(actualReal.data(), actualImag.data(), xReal.data(), xImag.data(), hReal.data(), hImag.data(), count);
+		compare("complexMultiplyAdd", count, expectedReal.data(), actualReal.data(), count, doubleTolerance);
+		compare("complexMultiplyAdd", count, expectedImag.data(), actualImag.data(), count, doubleTolerance);
+
+		// y and h have to be aligned
+		AlignedBuffer<float> yRealFloat(count), yImagFloat(count), hRealFloat(count), hImagFloat(count);
+		vector<float> xRealFloat(count), xImagFloat(count);
+		fill(xRealFloat.data(), count);
+		fill(xImagFloat.data(), count);
+		fill(hRealFloat.data, count);
+		fill(hImagFloat.data, count);
+		fill(expectedRealFloat.data(), count);
+		fill(expectedImagFloat.data(), count);
+		copy(expectedRealFloat.begin(), expectedRealFloat.end(), yRealFloat.data);
+		copy(expectedImagFloat.begin(), expectedImagFloat.end(), yImagFloat.data);
+		reference.complexMultiplyAddFloat(expectedRealFloat.data(), expectedImagFloat.data(), xRealFloat.data(), xImagFloat.data(), hRealFloat.data, hImagFloat.data, count);
+		kernels.complexMultiplyAddFloat(yRealFloat.data, yImagFloat.data, xRealFloat.data(), xImagFloat.data(), hRealFloat.data, hImagFloat.data, count);
+		compare("complexMultiplyAddFloat", count, expectedRealFloat.data(), yRealFloat.data, count, floatTolerance);
+		compare("complexMultiplyAddFloat", count, expectedImagFloat.data(), yImagFloat.data, count, floatTolerance);
+	}
+
+	void checkMix(unsigned frameCount)
+	{
+		const unsigned size = SimdKernels::MIX_SIZE;
+		const unsigned channelCount = 6;
+		vector<vector<double>> input(channelCount, vector<double>(frameCount));
+		vector<double*> inputPointers;
+		for (vector<double>& channel : input)
+		{
+			fill(channel.data(), frameCount);
+			inputPointers.push_back(channel.data());
+		}
+
+		for (unsigned inputCount = 0; inputCount <= channelCount; inputCount++)
+		{
+			// every other channel first, to not only read them in order
+			vector<unsigned> inputs;
+			for (unsigned k = 0; k < inputCount; k++)
+				inputs.push_back((2 * k + 1) % channelCount);
+			vector<double> factors(max(inputCount, 1u) * size);
+			fill(factors.data(), factors.size());
+			double constants[size];
+			fill(constants, size);
+
+			vector<vector<double>> expected(size, vector<double>(frameCount, 0.0));
+			vector<vector<double>> actual(size, vector<double>(frameCount, 0.0));
+			double* expectedPointers[size];
+			double* actualPointers[size];
+			for (unsigned j = 0; j < size; j++)
+			{
+				expectedPointers[j] = expected[j].data();
+				actualPointers[j] = actual[j].data();
+			}
+
+			// also starting behind the first frame like the groups of CopyFilter that share output buffers
+			unsigned startFrame = min(frameCount, 3u);
+			reference.mix(expectedPointers, inputPointers.data(), inputs.data(), inputCount, factors.data(), constants, startFrame, frameCount);
+			kernels.mix(actualPointers, inputPointers.data(), inputs.data(), inputCount, factors.data(), constants, startFrame, frameCount);
+			for (unsigned j = 0; j < size; j++)
+				compare("mix", frameCount, expected[j].data(), actual[j].data(), frameCount, doubleTolerance);
+		}
+	}
+
+	// stable random coefficients with poles inside the unit circle
+	void fillFeedback(double& a1, double& a2)
+	{
+		double radius = 0.5 + 0.45 * fabs(next());
+		double angle = 3.0 * fabs(next());
+		a1 = -2.0 * radius * cos(angle);
+		a2 = radius * radius;
+	}
+
+	void checkBiQuad(unsigned channelCount, unsigned frameCount)
+	{
+		vector<double> a0(channelCount), a1(channelCount), a2(channelCount), b1(channelCount), b2(channelCount);
+		fill(a0.data(), channelCount);
+		fill(b1.data(), channelCount);
+		fill(b2.data(), channelCount);
+		for (unsigned i = 0; i < channelCount; i++)
+			fillFeedback(a1[i], a2[i]);
+
+		vector<double> steps(5 * channelCount);
+		for (double& step : steps)
+			step = next() * 1e-5;
+		const double* s = steps.data();
+
+		for (unsigned rampFrames : {0u, frameCount / 2, frameCount})
+		{
+			vector<double> expectedState(4 * channelCount);
+			fill(expectedState.data(), expectedState.size());
+			vector<double> actualState = expectedState;
+			double* e = expectedState.data();
+			double* a = actualState.data();
+			BiQuadBank expectedBank = {a0.data(), a1.data(), a2.data(), b1.data(), b2.data(), e, e + channelCount, e + 2 * channelCount, e + 3 * channelCount,
+				rampFrames, s, s + channelCount, s + 2 * channelCount, s + 3 * channelCount, s + 4 * channelCount};
+			BiQuadBank actualBank = {a0.data(), a1.data(), a2.data(), b1.data(), b2.data(), a, a + channelCount, a + 2 * channelCount, a + 3 * channelCount,
+				rampFrames, s, s + channelCount, s + 2 * channelCount, s + 3 * channelCount, s + 4 * channelCount};
+
+			checkChannels("biQuad", channelCount, frameCount, expectedState, actualState, [&](double** output, double** input, bool actual) {
+				if (actual)
+					kernels.biQuad(actualBank, output, input, frameCount, 0, channelCount);
+				else
+					reference.biQuad(expectedBank, output, input, frameCount, 0, channelCount);
+			});
+		}
+	}
+
+	// runs process for both kernels, in place for the actual ones like the filters, and compares output and state
+	template<class Function>
+	void checkChannels(const char* kernel, unsigned channelCount, unsigned frameCount,
+		const vector<double>& expectedState, const vector<double>& actualState, Function process)
+	{
+		vector<vector<double>> input(channelCount, vector<double>(frameCount));
+		vector<vector<double>> expected(channelCount, vector<double>(frameCount));
+		vector<double*> inputPointers, expectedPointers, actualPointers;
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			fill(input[i].data(), frameCount);
+			inputPointers.push_back(input[i].data());
+			expectedPointers.push_back(expected[i].data());
+		}
+		vector<vector<double>> actual = input;
+		for (unsigned i = 0; i < channelCount; i++)
+			actualPointers.push_back(actual[i].data());
+
+		process(expectedPointers.data(), inputPointers.data(), false);
+		process(actualPointers.data(), actualPointers.data(), true);
+
+		for (unsigned i = 0; i < channelCount; i++)
+			compare(kernel, channelCount, expected[i].data(), actual[i].data(), frameCount, doubleTolerance);
+		compare(kernel, channelCount, expectedState.data(), actualState.data(), expectedState.size(), doubleTolerance);
+	}
+
+	const SimdKernels& kernels;
+	const SimdKernels& reference;
+	string levelName;
+	mt19937 random;
+	uniform_real_distribution<double> distribution = uniform_real_distribution<double>(-1.0, 1.0);
+	unsigned mismatchCount = 0;
+};
+
+bool reportSimdCheck()
+{
+	const SimdKernels& reference = SimdHelper::getKernels(SimdLevel::SCALAR);
+
+	unsigned totalMismatchCount = 0;
+	for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON})
+	{
+		string name = StringHelper::toString(SimdHelper::getLevelName(level), CP_ACP);
+		if (!SimdHelper::isSupported(level))
+		{
+			printf("Skipping %s kernels, which are not supported\n", name.c_str());
+			continue;
+		}
+
+		SimdChecker checker(SimdHelper::getKernels(level), reference);
+		unsigned mismatchCount = checker.run();
+		if (mismatchCount == 0)
+			printf("%s kernels match the scalar kernels\n", name.c_str());
+		else
+			printf("%s kernels differ from the scalar kernels in %u cases\n", name.c_str(), mismatchCount);
+		totalMismatchCount += mismatchCount;
+	}
+
+	return totalMismatchCount == 0;
+}
@@ -0,0 +1,121 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <cstring>
+
+#include "../helpers/PrecisionTimer.h"
+#include "StandInPlugin.h"
+
+static double standInLoad = 0.0;
+
+struct StandInEffect
+{
+	vst_effect_t effect;
+	double state[2];
+};
+
+static void waitForLoad()
+{
+	// busy, like a plugin doing real work
+	PrecisionTimer timer;
+	timer.start();
+	while (timer.stop() < standInLoad)
+		;
+}
+
+template<typename T> static void processStandIn(vst_effect_t* self, const T* const* inputs, T** outputs, int32_t samples)
+{
+	StandInEffect* standIn = (StandInEffect*)self->effect_internal;
+	waitForLoad();
+
+	for (int c = 0; c < 2; c++)
+	{
+		double state = standIn->state[c];
+		for (int i = 0; i < samples; i++)
+		{
+			state += 0.25 * (inputs[c][i] - state);
+			outputs[c][i] = (T)state;
+		}
+		standIn->state[c] = state;
+	}
+}
+
+static void VST_FUNCTION_INTERFACE processFloat(vst_effect_t* self, const float* const* inputs, float** outputs, int32_t samples)
+{
+	processStandIn(self, inputs, outputs, samples);
+}
+
+static void VST_FUNCTION_INTERFACE processDouble(vst_effect_t* self, const double* const* inputs, double** outputs, int32_t samples)
+{
+	processStandIn(self, inputs, outputs, samples);
+}
+
+static intptr_t VST_FUNCTION_INTERFACE control(vst_effect_t* self, int32_t opcode, int32_t p_int1, intptr_t p_int2, void* p_ptr, float p_float)
+{
+	StandInEffect* standIn = (StandInEffect*)self->effect_internal;
+
+	switch (opcode)
+	{
+	case VST_EFFECT_OPCODE_DESTROY:
+		delete standIn;
+		return 1;
+	case VST_EFFECT_OPCODE_EFFECT_NAME:
+		strcpy((char*)p_ptr, "Stand-in plugin");
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static void VST_FUNCTION_INTERFACE setParameter(vst_effect_t* self, uint32_t index, float value)
+{
+}
+
+static float VST_FUNCTION_INTERFACE getParameter(vst_effect_t* self, uint32_t index)
+{
+	return 0.0f;
+}
+
+void setStandInPluginLoad(double secondsPerBlock)
+{
+	standInLoad = secondsPerBlock;
+}
+
+vst_effect_t* standInPluginMain(vst_host_callback_t audioMaster)
+{
+	StandInEffect* standIn = new StandInEffect();
+	memset(standIn, 0, sizeof(StandInEffect));
+
+	vst_effect_t& effect = standIn->effect;
+	effect.magic_number = VST_MAGICNUMBER;
+	effect.control = &control;
+	effect.set_parameter = &setParameter;
+	effect.get_parameter = &getParameter;
+	effect.num_inputs = 2;
+	effect.num_outputs = 2;
+	effect.flags = VST_EFFECT_FLAG_SUPPORTS_FLOAT | VST_EFFECT_FLAG_SUPPORTS_DOUBLE;
+	effect.effect_internal = standIn;
+	effect.unique_id = VST_FOURCC('E', 'A', 'S', 'I');
+	effect.version = 1;
+	effect.process_float = &processFloat;
+	effect.process_double = &processDouble;
+
+	return &effect;
+}
@@ -0,0 +1,27 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include "../helpers/aeffectx.h"
+
+// Stereo VST effect implemented by the host, to measure the processing of plugin instances without a plugin DLL.
+// Each block takes at least the given time to simulate a heavy plugin, the output is a one-pole lowpass of the input.
+void setStandInPluginLoad(double secondsPerBlock);
+vst_effect_t* standInPluginMain(vst_host_callback_t audioMaster);
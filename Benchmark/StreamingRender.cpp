@@ -0,0 +1,271 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../FilterEngine.h"
+#include "../helpers/PrecisionTimer.h"
+#include "StreamingRender.h"
+
+using namespace std;
+
+// enough for the reader to be one chunk ahead and the writer one chunk behind the chunk being processed
+static const unsigned chunkCount = 4;
+static const unsigned minChunkFrameCount = 65536;
+
+struct Chunk
+{
+	vector<float> samples;
+	unsigned frameCount;
+};
+
+// Hands chunks from one thread to the next; a chunk with a frameCount of 0 marks the end of the stream
+class ChunkQueue
+{
+public:
+	void push(Chunk* chunk)
+	{
+		{
+			lock_guard<mutex> lock(queueMutex);
+			chunks.push_back(chunk);
+		}
+		condition.notify_one();
+	}
+
+	// returns the next chunk and the seconds that were spent waiting for it
+	Chunk* pop(double& waitTime)
+	{
+		unique_lock<mutex> lock(queueMutex);
+		if (chunks.empty())
+		{
+			PrecisionTimer timer;
+			timer.start();
+			condition.wait(lock, [this] {return !chunks.empty();});
+			waitTime += timer.stop();
+		}
+
+		Chunk* chunk = chunks.front();
+		chunks.pop_front();
+		return chunk;
+	}
+
+private:
+	mutex queueMutex;
+	condition_variable condition;
+	deque<Chunk*> chunks;
+};
+
+struct StreamState
+{
+	SNDFILE* inFile;
+	SNDFILE* outFile;
+	SweepParameters sweep;
+	unsigned long long frameCount;
+	unsigned channelCount;
+	unsigned sampleRate;
+	unsigned chunkFrameCount;
+
+	ChunkQueue freeChunks;
+	ChunkQueue readChunks;
+	ChunkQueue processedChunks;
+
+	double readTime = 0.0;
+	double readWaitTime = 0.0;
+	double writeTime = 0.0;
+	double writeWaitTime = 0.0;
+	unsigned long long framesWritten = 0;
+	bool writeFailed = false;
+};
+
+static void readThread(StreamState* state)
+{
+	unsigned long long position = 0;
+	PrecisionTimer timer;
+	while (true)
+	{
+		Chunk* chunk = state->freeChunks.pop(state->readWaitTime);
+
+		timer.start();
+		unsigned frameCount = (unsigned)min((unsigned long long)state->chunkFrameCount, state->frameCount - position);
+		if (state->inFile != NULL)
+		{
+			// the header may claim more frames than the file contains
+			sf_count_t numRead = 0;
+			while (numRead < frameCount)
+			{
+				sf_count_t count = sf_readf_float(state->inFile, chunk->samples.data() + numRead * state->channelCount, frameCount - numRead);
+				if (count <= 0)
+					break;
+				numRead += count;
+			}
+			frameCount = (unsigned)numRead;
+		}
+		else
+		{
+			const SweepParameters& sweep = state->sweep;
+			float sweepDiff = sweep.to - sweep.from;
+			for (unsigned i = 0; i < frameCount; i++)
+			{
+				double t = (position + i) * 1.0 / state->sampleRate;
+				float s = (float)sin(((sweep.from + sweepDiff * (t / sweep.length) / 2) * t) * 2 * M_PI);
+
+				for (unsigned j = 0; j < state->channelCount; j++)
+					chunk->samples[(size_t)i * state->channelCount + j] = s;
+			}
+		}
+		state->readTime += timer.stop();
+
+		chunk->frameCount = frameCount;
+		position += frameCount;
+		state->readChunks.push(chunk);
+
+		if (frameCount == 0)
+			break;
+	}
+}
+
+static void writeThread(StreamState* state)
+{
+	PrecisionTimer timer;
+	while (true)
+	{
+		Chunk* chunk = state->processedChunks.pop(state->writeWaitTime);
+		if (chunk->frameCount == 0)
+			break;
+
+		timer.start();
+		if (!state->writeFailed)
+		{
+			sf_count_t numWritten = sf_writef_float(state->outFile, chunk->samples.data(), chunk->frameCount);
+			state->framesWritten += numWritten;
+			if (numWritten != chunk->frameCount)
+				state->writeFailed = true;
+		}
+		state->writeTime += timer.stop();
+
+		state->freeChunks.push(chunk);
+	}
+}
+
+void reportStreamingRender(FilterEngine& engine, SNDFILE* inFile, const SweepParameters& sweep, unsigned long long frameCount,
+	unsigned channelCount, unsigned sampleRate, unsigned batchSize, const string& outputPath)
+{
+	SF_INFO info = {0, (int)sampleRate, (int)channelCount, SF_FORMAT_WAV | SF_FORMAT_PCM_16, 0};
+	SNDFILE* outFile = sf_open(outputPath.c_str(), SFM_WRITE, &info);
+	if (outFile == NULL)
+	{
+		fprintf(stderr, "%s", sf_strerror(outFile));
+		return;
+	}
+
+	StreamState state;
+	state.inFile = inFile;
+	state.outFile = outFile;
+	state.sweep = sweep;
+	state.frameCount = frameCount;
+	state.channelCount = channelCount;
+	state.sampleRate = sampleRate;
+	// a multiple of the batch size, so that process is called with full batches except at the end
+	state.chunkFrameCount = max(minChunkFrameCount / batchSize, 1u) * batchSize;
+
+	vector<Chunk> chunks(chunkCount);
+	for (Chunk& chunk : chunks)
+	{
+		chunk.samples.resize((size_t)state.chunkFrameCount * channelCount);
+		state.freeChunks.push(&chunk);
+	}
+
+	printf("\nStreaming %llu frames from %d channel(s) to %s in chunks of %d frames\n",
+		frameCount, channelCount, outputPath.c_str(), state.chunkFrameCount);
+
+	PrecisionTimer totalTimer;
+	totalTimer.start();
+
+	thread reader(readThread, &state);
+	thread writer(writeThread, &state);
+
+	PrecisionTimer timer;
+	double processTime = 0.0;
+	double inputWaitTime = 0.0;
+	unsigned long long processedFrameCount = 0;
+	unsigned long long clipCount = 0;
+	float maxLevel = 0;
+	while (true)
+	{
+		Chunk* chunk = state.readChunks.pop(inputWaitTime);
+		if (chunk->frameCount == 0)
+		{
+			state.processedChunks.push(chunk);
+			break;
+		}
+
+		timer.start();
+		// in place, as the engine converts the whole input before writing the output
+		for (unsigned i = 0; i < chunk->frameCount; i += batchSize)
+		{
+			float* samples = chunk->samples.data() + (size_t)i * channelCount;
+			engine.process(samples, samples, min(batchSize, chunk->frameCount - i));
+		}
+		processTime += timer.stop();
+
+		for (size_t i = 0; i < (size_t)chunk->frameCount * channelCount; i++)
+		{
+			float f = fabs(chunk->samples[i]);
+			if (f > maxLevel)
+				maxLevel = f;
+			if (f > 1.0f)
+				clipCount++;
+		}
+
+		processedFrameCount += chunk->frameCount;
+		state.processedChunks.push(chunk);
+	}
+
+	reader.join();
+	writer.join();
+
+	if (state.writeFailed)
+		fprintf(stderr, "Writing the output failed after %llu frames: %s\n", state.framesWritten, sf_strerror(outFile));
+
+	sf_close(outFile);
+	double totalTime = totalTimer.stop();
+
+	double length = double(processedFrameCount) / sampleRate;
+	printf("%llu samples processed in %f seconds\n", processedFrameCount * channelCount, processTime);
+	printf("This is equivalent to %.2f%% CPU load (one core) when processing in real time\n", 100.0 * processTime / length);
+	printf("Reading took %f seconds and writing %f seconds on their own threads\n", state.readTime, state.writeTime);
+	// waiting for free chunks means that writing is slower than reading and processing
+	printf("Processing waited %f seconds for input and reading waited %f seconds for the writer\n", inputWaitTime, state.readWaitTime);
+	printf("Streaming took %f seconds in total (%.1f times real time), using %llu KiB of sample buffers\n",
+		totalTime, length / totalTime, (unsigned long long)chunkCount * state.chunkFrameCount * channelCount * sizeof(float) / 1024);
+
+	printf("Max output level: %f (%f dB)", maxLevel, log10(maxLevel) * 20.0f);
+	if (clipCount > 0)
+		printf(" (%llu samples clipped!)", clipCount);
+	printf("\n");
+}
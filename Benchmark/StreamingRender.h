@@ -0,0 +1,38 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <sndfile.h>
+
+class FilterEngine;
+
+struct SweepParameters
+{
+	float from;
+	float to;
+	float length;
+};
+
+// Processes the input file, or the linear sine sweep if inFile is NULL, with the initialized engine in chunks of
+// interleaved float samples and writes the result to outputPath. Reading and writing happen on their own threads
+// with a few chunks in flight, so they overlap the processing and the memory use does not depend on the length.
+void reportStreamingRender(FilterEngine& engine, SNDFILE* inFile, const SweepParameters& sweep, unsigned long long frameCount,
+	unsigned channelCount, unsigned sampleRate, unsigned batchSize, const std::string& outputPath);
@@ -0,0 +1,110 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <cstdio>
+#include <cstring>
+
+#include "../FilterEngine.h"
+#include "../helpers/PrecisionTimer.h"
+#include "../VoicemeeterClient/VoicemeeterBusProcessor.h"
+#include "VoicemeeterSimulation.h"
+
+using namespace std;
+
+void reportVoicemeeterSimulation(unsigned busCount, const wstring& customPath, const float* buf, unsigned frameCount,
+	unsigned channelCount, unsigned sampleRate, unsigned blockSize)
+{
+	printf("\nComparing serial and parallel processing of %d Voicemeeter buses in blocks of %d frames\n", busCount, blockSize);
+
+	unsigned busChannelCount = 8 * busCount;
+	VoicemeeterBusProcessor* processors[2];
+	float* outputs[2];
+	VBVMR_T_AUDIOBUFFER audioBuffers[2];
+	float* input = new float[busChannelCount * blockSize];
+	for (int mode = 0; mode < 2; mode++)
+	{
+		processors[mode] = new VoicemeeterBusProcessor(mode == 1, customPath);
+		vector<FilterEngine*> engines;
+		for (unsigned i = 0; i < busCount; i++)
+		{
+			wstring output = L"Output A" + to_wstring(i + 1);
+			FilterEngine* engine = new FilterEngine();
+			engine->setDeviceInfo(false, true, L"Voicemeeter", output, L"", L"Voicemeeter " + output);
+			engines.push_back(engine);
+		}
+		processors[mode]->setEngines(engines);
+
+		VBVMR_T_AUDIOINFO audioInfo = {(long)sampleRate, (long)blockSize};
+		processors[mode]->handle(VBVMR_CBCOMMAND_STARTING, &audioInfo);
+
+		outputs[mode] = new float[busChannelCount * blockSize];
+		VBVMR_T_AUDIOBUFFER& audioBuffer = audioBuffers[mode];
+		memset(&audioBuffer, 0, sizeof(VBVMR_T_AUDIOBUFFER));
+		audioBuffer.audiobuffer_sr = sampleRate;
+		audioBuffer.audiobuffer_nbs = blockSize;
+		audioBuffer.audiobuffer_nbi = busChannelCount;
+		audioBuffer.audiobuffer_nbo = busChannelCount;
+		for (unsigned c = 0; c < busChannelCount; c++)
+		{
+			audioBuffer.audiobuffer_r[c] = input + c * blockSize;
+			audioBuffer.audiobuffer_w[c] = outputs[mode] + c * blockSize;
+		}
+	}
+
+	unsigned blockCount = frameCount / blockSize;
+	double totalTimes[2] = {0.0, 0.0};
+	double maxTimes[2] = {0.0, 0.0};
+	unsigned differentBlocks = 0;
+	PrecisionTimer timer;
+	for (unsigned b = 0; b < blockCount; b++)
+	{
+		// every bus gets the input channels, repeated to fill its 8 channels
+		for (unsigned c = 0; c < busChannelCount; c++)
+			for (unsigned i = 0; i < blockSize; i++)
+				input[c * blockSize + i] = buf[((size_t)b * blockSize + i) * channelCount + c % 8 % channelCount];
+
+		for (int mode = 0; mode < 2; mode++)
+		{
+			timer.start();
+			processors[mode]->handle(VBVMR_CBCOMMAND_BUFFER_OUT, &audioBuffers[mode]);
+			double time = timer.stop();
+			totalTimes[mode] += time;
+			maxTimes[mode] = max(maxTimes[mode], time);
+		}
+
+		if (memcmp(outputs[0], outputs[1], busChannelCount * blockSize * sizeof(float)) != 0)
+			differentBlocks++;
+	}
+
+	for (int mode = 0; mode < 2; mode++)
+	{
+		processors[mode]->handle(VBVMR_CBCOMMAND_ENDING, NULL);
+		printf("%s: %f ms per callback on average, %f ms at most, callback period %f ms\n", mode == 1 ? "Parallel" : "Serial",
+			totalTimes[mode] * 1000.0 / blockCount, maxTimes[mode] * 1000.0, blockSize * 1000.0 / sampleRate);
+
+		delete processors[mode];
+		delete[] outputs[mode];
+	}
+	delete[] input;
+
+	printf("%d of %d callbacks differ from serial processing\n", differentBlocks, blockCount);
+	if (totalTimes[1] > 0.0)
+		printf("Speedup: %.2f\n", totalTimes[0] / totalTimes[1]);
+}
@@ -0,0 +1,28 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <string>
+
+// Stands in for Voicemeeter by calling VoicemeeterBusProcessor like its audio callback, with busCount output buses
+// of 8 channels that each get the input signal and process it with the configuration. Serial and parallel processing
+// run on the same blocks of blockSize frames, so their processing times per callback and their outputs can be compared.
+void reportVoicemeeterSimulation(unsigned busCount, const std::wstring& customPath, const float* buf, unsigned frameCount,
+	unsigned channelCount, unsigned sampleRate, unsigned blockSize);
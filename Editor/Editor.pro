@@ -22,7 +22,17 @@ DEFINES += MUP_USE_WIDE_STRING
 SOURCES += main.cpp\
 	../helpers/LogHelper.cpp \
 	../helpers/StringHelper.cpp \
+	../helpers/FileWatcher.cpp \
+	../helpers/ConfigFile.cpp \
+	../helpers/DelayLineHelper.cpp \
+	../helpers/ConfigService.cpp \
 	../helpers/RegistryHelper.cpp \
+	../helpers/SimdHelper.cpp \
+	../helpers/SimdKernelsAVX2.cpp \
+	../helpers/SimdKernelsAVX512.cpp \
+	../helpers/SimdKernelsNEON.cpp \
+	../helpers/SimdKernelsSSE2.cpp \
+	../helpers/SimdKernelsScalar.cpp \
 	../parser/LogicalOperators.cpp \
 	IFilterGUIFactory.cpp \
 	IFilterGUI.cpp \
@@ -79,6 +89,8 @@ SOURCES += main.cpp\
 	../filters/GraphicEQFilterFactory.cpp \
 	../libHybridConv-0.1.1/libHybridConv_eapo.cpp \
 	../helpers/GainIterator.cpp \
+	../helpers/ThreadedConvolver.cpp \
+	../helpers/RealtimeWorkerPool.cpp \
 	guis/GraphicEQFilterGUIScene.cpp \
 	widgets/FrequencyPlotView.cpp \
 	widgets/FrequencyPlotHRuler.cpp \
@@ -111,6 +123,7 @@ SOURCES += main.cpp\
 	../filters/IncludeFilterFactory.cpp \
 	../filters/ChannelFilter.cpp \
 	../filters/ConvolutionFilter.cpp \
+	../parser/ExpressionCache.cpp \
 	../parser/RegexFunctions.cpp \
 	../parser/RegistryFunctions.cpp \
 	../parser/StringOperators.cpp \
@@ -133,6 +146,8 @@ SOURCES += main.cpp\
 	../filters/loudnessCorrection/LoudnessCorrectionFilter.cpp \
 	../filters/loudnessCorrection/LoudnessCorrectionFilterFactory.cpp \
 	../filters/loudnessCorrection/VolumeController.cpp \
+	../filters/loudnessCorrection/VolumeMonitor.cpp \
+	../filters/loudnessCorrection/LoudnessCurve.cpp \
 	guis/LoudnessCorrectionFilterGUIDialog.cpp \
 	helpers/QtSndfileHandle.cpp \
 	widgets/MiddleClickTabWidget.cpp \
@@ -181,7 +196,15 @@ SOURCES += main.cpp\
 HEADERS  += \
 	../helpers/LogHelper.h \
 	../helpers/StringHelper.h \
+	../helpers/FileWatcher.h \
+	../helpers/ConfigFile.h \
+	../helpers/DelayLineHelper.h \
+	../helpers/ConfigService.h \
 	../helpers/RegistryHelper.h \
+	../helpers/SimdHelper.h \
+	../helpers/SimdKernels.h \
+	../helpers/SimdKernelsImpl.h \
+	../helpers/SimdVector.h \
 	../parser/LogicalOperators.h \
 	IFilterGUIFactory.h \
 	helpers/GUIHelper.h \
@@ -240,6 +263,8 @@ HEADERS  += \
 	../filters/GraphicEQFilterFactory.h \
 	../libHybridConv-0.1.1/libHybridConv_eapo.h \
 	../helpers/GainIterator.h \
+	../helpers/ThreadedConvolver.h \
+	../helpers/RealtimeWorkerPool.h \
 	guis/GraphicEQFilterGUIScene.h \
 	widgets/FrequencyPlotView.h \
 	widgets/FrequencyPlotHRuler.h \
@@ -274,6 +299,7 @@ HEADERS  += \
 	../filters/IncludeFilterFactory.h \
 	../filters/ChannelFilter.h \
 	../filters/ConvolutionFilter.h \
+	../parser/ExpressionCache.h \
 	../parser/RegexFunctions.h \
 	../parser/RegistryFunctions.h \
 	../parser/StringOperators.h \
@@ -297,6 +323,10 @@ HEADERS  += \
 	../filters/loudnessCorrection/LoudnessCorrectionFilterFactory.h \
 	../filters/loudnessCorrection/ParameterArchive.h \
 	../filters/loudnessCorrection/VolumeController.h \
+	../filters/loudnessCorrection/VolumeMonitor.h \
+	../filters/loudnessCorrection/LoudnessCurve.h \
+	../helpers/MpscRing.h \
+	../helpers/SeqLock.h \
 	guis/LoudnessCorrectionFilterGUIDialog.h \
 	helpers/QtSndfileHandle.h \
 	widgets/MiddleClickTabWidget.h \
@@ -353,7 +383,7 @@ isEmpty(MUPARSERX_INCLUDE) {
 
 
 INCLUDEPATH += $$PWD/.. $$LIBSNDFILE_INCLUDE $$FFTW_INCLUDE $$MUPARSERX_INCLUDE
-LIBS += user32.lib advapi32.lib version.lib ole32.lib Shlwapi.lib authz.lib crypt32.lib dbghelp.lib winmm.lib sndfile.lib libfftw3-3.lib
+LIBS += user32.lib advapi32.lib version.lib ole32.lib Shlwapi.lib authz.lib crypt32.lib dbghelp.lib winmm.lib sndfile.lib libfftw3-3.lib libfftw3f-3.lib
 
 # LIBS += muparserx.lib removed for source build
 
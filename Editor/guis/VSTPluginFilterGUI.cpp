@@ -37,8 +37,8 @@
 using namespace std;
 using namespace std::placeholders;
 
-VSTPluginFilterGUI::VSTPluginFilterGUI(std::shared_ptr<VSTPluginLibrary> library, const std::wstring& chunkData, const std::unordered_map<std::wstring, float>& paramMap)
-	: ui(new Ui::VSTPluginFilterGUI), library(library), chunkData(chunkData), paramMap(paramMap)
+VSTPluginFilterGUI::VSTPluginFilterGUI(std::shared_ptr<VSTPluginLibrary> library, const std::wstring& chunkData, const std::unordered_map<std::wstring, float>& paramMap, bool parallel)
+	: ui(new Ui::VSTPluginFilterGUI), library(library), chunkData(chunkData), paramMap(paramMap), parallel(parallel)
 {
 	ui->setupUi(this);
 	ui->frame->setVisible(false);
@@ -186,6 +186,8 @@ void VSTPluginFilterGUI::store(QString& command, QString& parameters)
 	if (relativePath.contains(" "))
 		relativePath = "\"" + relativePath + "\"";
 	parameters = "Library " + relativePath;
+	if (parallel)
+		parameters += " Parallel true";
 
 	if (chunkData != L"")
 	{
@@ -38,7 +38,7 @@ class VSTPluginFilterGUI : public IFilterGUI
 	Q_OBJECT
 
 public:
-	explicit VSTPluginFilterGUI(std::shared_ptr<VSTPluginLibrary> library, const std::wstring& chunkData, const std::unordered_map<std::wstring, float>& paramMap);
+	explicit VSTPluginFilterGUI(std::shared_ptr<VSTPluginLibrary> library, const std::wstring& chunkData, const std::unordered_map<std::wstring, float>& paramMap, bool parallel = false);
 	~VSTPluginFilterGUI();
 
 	void store(QString& command, QString& parameters) override;
@@ -68,6 +68,7 @@ private:
 	VSTPluginInstance* effect = NULL;
 	std::wstring chunkData;
 	std::unordered_map<std::wstring, float> paramMap;
+	bool parallel;
 	bool embedded = false;
 	bool dialogOpen = false;
 	bool autoApplyDialog = false;
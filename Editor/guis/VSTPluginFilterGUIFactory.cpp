@@ -46,7 +46,7 @@ IFilterGUI* VSTPluginFilterGUIFactory::createFilterGUI(QString& command, QString
 		if (!filters.empty())
 		{
 			VSTPluginFilter* filter = (VSTPluginFilter*)filters[0];
-			result = new VSTPluginFilterGUI(filter->getLibrary(), filter->getChunkData(), filter->getParamMap());
+			result = new VSTPluginFilterGUI(filter->getLibrary(), filter->getChunkData(), filter->getParamMap(), filter->getParallel());
 		}
 		else
 		{
@@ -130,6 +130,7 @@ if errorlevel 1 (
     echo [INFO] Copying external DLLs...
     copy /Y "..\external-lib\libsndfile\libsndfile-1.2.2-win64\bin\sndfile.dll" "release\" >nul
     copy /Y "..\external-lib\fftw\libfftw3-3.dll" "release\" >nul
+    copy /Y "..\external-lib\fftw\libfftw3f-3.dll" "release\" >nul
     
     echo [INFO] Deployment complete.
 )
@@ -52,12 +52,17 @@ EqualizerAPO::EqualizerAPO(IUnknown* pUnkOuter)
 	childAPO = NULL;
 	childRT = NULL;
 	childCfg = NULL;
+	logWriterStarted = false;
 
 	InterlockedIncrement(&instCount);
 }
 
 EqualizerAPO::~EqualizerAPO()
 {
+	// the log writer pins the module, so it has to be stopped when the last instance is released
+	if (logWriterStarted)
+		LogHelper::stopWriter();
+
 	InterlockedDecrement(&instCount);
 
 	resetChild();
@@ -90,12 +95,23 @@ HRESULT EqualizerAPO::GetLatency(HNSTIME* pTime)
 	if (childAPO)
 		childAPO->GetLatency(pTime);
 
+	// HNSTIME is in units of 100 nanoseconds
+	float sampleRate = engine.getSampleRate();
+	if (sampleRate > 0)
+		*pTime += (HNSTIME)(engine.getLatency() * 10000000.0 / sampleRate);
+
 	return S_OK;
 }
 
 HRESULT EqualizerAPO::Initialize(UINT32 cbDataSize, BYTE* pbyData)
 {
 	LogHelper::reset();
+	// start the log writer here, so that logging from the audio thread never has to start it
+	if (!logWriterStarted)
+	{
+		LogHelper::startWriter();
+		logWriterStarted = true;
+	}
 
 	TraceF(L"Initialize");
 
@@ -74,6 +74,7 @@ private:
 	IUnknown* pUnkOuter;
 	FilterEngine engine;
 	bool allowSilentBufferModification;
+	bool logWriterStarted;
 
 	void resetChild();
 	void sendMessage(std::wstring& deviceTestPipeName, const std::wstring& deviceGuid, GUID apoGuid, const std::string& phase);
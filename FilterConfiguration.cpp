@@ -21,45 +21,124 @@
 #include <algorithm>
 
 #include "FilterEngine.h"
+#include "helpers/LogHelper.h"
 #include "helpers/MemoryHelper.h"
 #include "FilterConfiguration.h"
 
 using namespace std;
 
+// channels with delays realized by buffer offsets hold this many blocks in addition to the delay,
+// so the history only has to be moved to the start of the buffer once every RING_BLOCK_COUNT blocks
+static const unsigned RING_BLOCK_COUNT = 16;
+
 FilterConfiguration::FilterConfiguration(FilterEngine* engine, const vector<FilterInfo*>& filterInfos, unsigned allChannelCount)
 {
 	this->allChannelCount = allChannelCount;
 	realChannelCount = engine->getRealChannelCount();
 	outputChannelCount = engine->getOutputChannelCount();
-	unsigned maxFrameCount = engine->getMaxFrameCount();
+	maxFrameCount = engine->getMaxFrameCount();
+	lastFrameCount = 0;
 
-	allSamples = (double**)MemoryHelper::alloc(allChannelCount * sizeof(double*));
+	filterCount = (unsigned)filterInfos.size();
+	configuredFilterCount = filterCount;
+	this->filterInfos = (FilterInfo**)MemoryHelper::alloc(filterCount * sizeof(FilterInfo*));
+	for (size_t i = 0; i < filterCount; i++)
+		this->filterInfos[i] = filterInfos[i];
+
+	resolveChannels();
+	optimizeFilters();
+	TraceF(L"Processing %d of %d filters after optimization", filterCount, configuredFilterCount);
+
+	// A delay can be realized by letting the following filters read further back in the channel buffer
+	// as long as the channel buffer still contains the history, i.e. no filter that is not in-place
+	// has swapped it for its output buffer before.
+	ringDelays = (unsigned*)MemoryHelper::alloc(allChannelCount * sizeof(unsigned));
+	memset(ringDelays, 0, allChannelCount * sizeof(unsigned));
+	vector<bool> swapped(allChannelCount, false);
+	unsigned bufferDelayCount = 0;
+	for (size_t i = 0; i < filterCount; i++)
+	{
+		FilterInfo* filterInfo = this->filterInfos[i];
+		filterInfo->bufferDelay = 0;
+
+		unsigned delay = filterInfo->filter->getBufferDelay();
+		if (delay > 0 && filterInfo->inChannelCount == filterInfo->outChannelCount)
+		{
+			bool possible = true;
+			for (size_t j = 0; j < filterInfo->inChannelCount; j++)
+			{
+				if (filterInfo->inChannels[j] != filterInfo->outChannels[j] || swapped[filterInfo->inChannels[j]])
+					possible = false;
+			}
+
+			if (possible)
+			{
+				filterInfo->bufferDelay = delay;
+				for (size_t j = 0; j < filterInfo->inChannelCount; j++)
+					ringDelays[filterInfo->inChannels[j]] += delay;
+				bufferDelayCount++;
+				continue;
+			}
+		}
+
+		if (!filterInfo->inPlace)
+		{
+			for (size_t j = 0; j < filterInfo->outChannelCount; j++)
+				swapped[filterInfo->outChannels[j]] = true;
+		}
+	}
+
+	if (bufferDelayCount > 0)
+		TraceF(L"Realizing %d delay filter(s) by channel buffer offsets", bufferDelayCount);
+
+	ringPositions = (unsigned*)MemoryHelper::alloc(allChannelCount * sizeof(unsigned));
+	sampleBuffers = (double**)MemoryHelper::alloc(allChannelCount * sizeof(double*));
+	for (size_t i = 0; i < allChannelCount; i++)
+	{
+		if (ringDelays[i] > 0)
+		{
+			size_t size = (ringDelays[i] + RING_BLOCK_COUNT * maxFrameCount) * sizeof(double);
+			sampleBuffers[i] = (double*)MemoryHelper::alloc(size);
+			memset(sampleBuffers[i], 0, size);
+		}
+		else
+		{
+			sampleBuffers[i] = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
+		}
+		ringPositions[i] = ringDelays[i];
+	}
+	sampleBuffers2 = (double**)MemoryHelper::alloc(allChannelCount * sizeof(double*));
 	for (size_t i = 0; i < allChannelCount; i++)
-		allSamples[i] = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
+		sampleBuffers2[i] = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
+
+	allSamples = (double**)MemoryHelper::alloc(allChannelCount * sizeof(double*));
 	allSamples2 = (double**)MemoryHelper::alloc(allChannelCount * sizeof(double*));
 	for (size_t i = 0; i < allChannelCount; i++)
-		allSamples2[i] = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
+	{
+		allSamples[i] = sampleBuffers[i] + ringPositions[i];
+		allSamples2[i] = sampleBuffers2[i];
+	}
 	currentSamples = (double**)MemoryHelper::alloc(allChannelCount * sizeof(double*));
 	currentSamples2 = (double**)MemoryHelper::alloc(allChannelCount * sizeof(double*));
-
-	filterCount = (unsigned)filterInfos.size();
-	this->filterInfos = (FilterInfo**)MemoryHelper::alloc(filterCount * sizeof(FilterInfo*));
-	for (size_t i = 0; i < filterCount; i++)
-		this->filterInfos[i] = filterInfos[i];
 }
 
 FilterConfiguration::~FilterConfiguration()
 {
 	MemoryHelper::free(currentSamples2);
 	MemoryHelper::free(currentSamples);
+	MemoryHelper::free(allSamples2);
+	MemoryHelper::free(allSamples);
 
 	for (size_t i = 0; i < allChannelCount; i++)
-		MemoryHelper::free(allSamples2[i]);
-	MemoryHelper::free(allSamples2);
+		MemoryHelper::free(sampleBuffers2[i]);
+	MemoryHelper::free(sampleBuffers2);
 
 	for (size_t i = 0; i < allChannelCount; i++)
-		MemoryHelper::free(allSamples[i]);
-	MemoryHelper::free(allSamples);
+		MemoryHelper::free(sampleBuffers[i]);
+	MemoryHelper::free(sampleBuffers);
+
+	MemoryHelper::free(ringPositions);
+	MemoryHelper::free(ringDelays);
 
 	for (size_t i = 0; i < filterCount; i++)
 	{
@@ -74,9 +153,175 @@ FilterConfiguration::~FilterConfiguration()
 	MemoryHelper::free(filterInfos);
 }
 
+void FilterConfiguration::resolveChannels()
+{
+	// FilterEngine leaves the channel lists empty if they are the same as for the previous filter,
+	// but process needs the explicit lists to rebuild the pointers after shifting channel buffers
+	for (size_t i = 1; i < filterCount; i++)
+	{
+		FilterInfo* filterInfo = filterInfos[i];
+		FilterInfo* previousInfo = filterInfos[i - 1];
+
+		if (filterInfo->inChannels == NULL)
+		{
+			// after a filter that is not in-place, its output channels become the input
+			size_t* channels = previousInfo->inPlace ? previousInfo->inChannels : previousInfo->outChannels;
+			filterInfo->inChannelCount = previousInfo->inPlace ? previousInfo->inChannelCount : previousInfo->outChannelCount;
+			if (channels != NULL)
+			{
+				filterInfo->inChannels = (size_t*)MemoryHelper::alloc(filterInfo->inChannelCount * sizeof(size_t));
+				memcpy(filterInfo->inChannels, channels, filterInfo->inChannelCount * sizeof(size_t));
+			}
+		}
+
+		if (filterInfo->outChannels == NULL && previousInfo->outChannels != NULL)
+		{
+			filterInfo->outChannelCount = previousInfo->outChannelCount;
+			filterInfo->outChannels = (size_t*)MemoryHelper::alloc(filterInfo->outChannelCount * sizeof(size_t));
+			memcpy(filterInfo->outChannels, previousInfo->outChannels, filterInfo->outChannelCount * sizeof(size_t));
+		}
+	}
+}
+
+bool FilterConfiguration::mergeFilters()
+{
+	// consecutive filters that support it, like Copy filters, are combined into one
+	bool merged = false;
+	size_t i = 1;
+	while (i < filterCount)
+	{
+		FilterInfo* previousInfo = filterInfos[i - 1];
+		FilterInfo* filterInfo = filterInfos[i];
+		if (filterInfo->inChannels != NULL && previousInfo->inChannels != NULL
+			&& filterInfo->outChannels != NULL && previousInfo->outChannels != NULL)
+		{
+			vector<size_t> previousIn(previousInfo->inChannels, previousInfo->inChannels + previousInfo->inChannelCount);
+			vector<size_t> previousOut(previousInfo->outChannels, previousInfo->outChannels + previousInfo->outChannelCount);
+			vector<size_t> in(filterInfo->inChannels, filterInfo->inChannels + filterInfo->inChannelCount);
+			vector<size_t> out(filterInfo->outChannels, filterInfo->outChannels + filterInfo->outChannelCount);
+			if (previousInfo->filter->mergeNext(filterInfo->filter, previousIn, previousOut, in, out))
+			{
+				MemoryHelper::free(previousInfo->outChannels);
+				previousInfo->outChannelCount = previousOut.size();
+				previousInfo->outChannels = (size_t*)MemoryHelper::alloc(previousOut.size() * sizeof(size_t));
+				memcpy(previousInfo->outChannels, previousOut.data(), previousOut.size() * sizeof(size_t));
+				removeFilter(i);
+				merged = true;
+				continue;
+			}
+		}
+
+		i++;
+	}
+
+	return merged;
+}
+
+void FilterConfiguration::optimizeFilters()
+{
+	// each step may enable another one, e.g. Preamps folded into each other can cancel out
+	bool changed = true;
+	while (changed)
+	{
+		changed = mergeFilters();
+
+		for (size_t i = 0; i < filterCount; i++)
+		{
+			FilterInfo* filterInfo = filterInfos[i];
+			if (filterInfo->filter->isIdentity())
+			{
+				removeFilter(i);
+				changed = true;
+				break;
+			}
+
+			double gain;
+			if (filterInfo->filter->getConstantGain(gain))
+			{
+				if ((i > 0 && foldGain(filterInfos[i - 1], filterInfo->inChannels, filterInfo->inChannelCount, gain, false))
+					|| (i + 1 < filterCount && foldGain(filterInfos[i + 1], filterInfo->inChannels, filterInfo->inChannelCount, gain, true)))
+				{
+					removeFilter(i);
+					changed = true;
+					break;
+				}
+			}
+		}
+	}
+}
+
+bool FilterConfiguration::foldGain(FilterInfo* target, const size_t* channels, size_t channelCount, double gain, bool following)
+{
+	// a following filter can only absorb a gain on its input if it processes each channel in place
+	if (following)
+	{
+		if (!target->inPlace || target->inChannelCount != target->outChannelCount)
+			return false;
+		for (size_t j = 0; j < target->inChannelCount; j++)
+		{
+			if (target->inChannels[j] != target->outChannels[j])
+				return false;
+		}
+	}
+
+	vector<size_t> positions;
+	for (size_t j = 0; j < channelCount; j++)
+	{
+		size_t* pos = find(target->outChannels, target->outChannels + target->outChannelCount, channels[j]);
+		if (pos == target->outChannels + target->outChannelCount)
+			return false;
+		positions.push_back(pos - target->outChannels);
+	}
+
+	return target->filter->applyGain(positions, gain);
+}
+
+void FilterConfiguration::removeFilter(size_t index)
+{
+	// the channel lists of all filters are explicit after resolveChannels, so no other filter refers to this one
+	FilterInfo* filterInfo = filterInfos[index];
+	filterInfo->filter->~IFilter();
+	MemoryHelper::free(filterInfo->filter);
+	if (filterInfo->inChannels != NULL)
+		MemoryHelper::free(filterInfo->inChannels);
+	if (filterInfo->outChannels != NULL)
+		MemoryHelper::free(filterInfo->outChannels);
+	MemoryHelper::free(filterInfo);
+
+	for (size_t i = index + 1; i < filterCount; i++)
+		filterInfos[i - 1] = filterInfos[i];
+	filterCount--;
+}
+
 #pragma AVRT_CODE_BEGIN
+void FilterConfiguration::rewindChannels(unsigned frameCount)
+{
+	for (unsigned c = 0; c < allChannelCount; c++)
+	{
+		unsigned delay = ringDelays[c];
+		if (delay > 0)
+		{
+			unsigned position = ringPositions[c] + lastFrameCount;
+			if (position + maxFrameCount > delay + RING_BLOCK_COUNT * maxFrameCount)
+			{
+				// only the history that delayed reads still need is kept
+				memmove(sampleBuffers[c], sampleBuffers[c] + position - delay, delay * sizeof(double));
+				position = delay;
+			}
+			ringPositions[c] = position;
+		}
+
+		allSamples[c] = sampleBuffers[c] + ringPositions[c];
+		allSamples2[c] = sampleBuffers2[c];
+	}
+
+	lastFrameCount = frameCount;
+}
+
 void FilterConfiguration::read(double* input, unsigned frameCount)
 {
+	rewindChannels(frameCount);
+
 #define DEINTERLEAVE_MACRO(ccount)\
 	{\
 		for (size_t c = 0; c < ccount; c++)\
@@ -111,6 +356,7 @@ void FilterConfiguration::read(double* input, unsigned frameCount)
 
 void FilterConfiguration::read(double** input, unsigned frameCount)
 {
+	rewindChannels(frameCount);
 	for (unsigned c = 0; c < realChannelCount; c++)
 		memcpy(allSamples[c], input[c], frameCount * sizeof(double));
 }
@@ -127,6 +373,14 @@ void FilterConfiguration::process(unsigned frameCount)
 	for (size_t i = 0; i < filterCount; i++)
 	{
 		FilterInfo* filterInfo = filterInfos[i];
+		if (filterInfo->bufferDelay > 0)
+		{
+			// the following filters read the samples from bufferDelay frames before
+			for (size_t j = 0; j < filterInfo->inChannelCount; j++)
+				allSamples[filterInfo->inChannels[j]] -= filterInfo->bufferDelay;
+			continue;
+		}
+
 		for (size_t j = 0; j < filterInfo->inChannelCount; j++)
 			currentSamples[j] = allSamples[filterInfo->inChannels[j]];
 		if (filterInfo->inPlace)
@@ -210,7 +464,34 @@ void FilterConfiguration::write(double** output, unsigned frameCount)
 }
 #pragma AVRT_CODE_END
 
+void FilterConfiguration::reset()
+{
+	for (size_t i = 0; i < filterCount; i++)
+		filterInfos[i]->filter->reset();
+
+	for (size_t i = 0; i < allChannelCount; i++)
+	{
+		if (ringDelays[i] > 0)
+		{
+			memset(sampleBuffers[i], 0, (ringDelays[i] + RING_BLOCK_COUNT * maxFrameCount) * sizeof(double));
+			ringPositions[i] = ringDelays[i];
+		}
+	}
+	lastFrameCount = 0;
+}
+
 bool FilterConfiguration::isEmpty()
 {
-	return filterCount == 0;
+	// if all filters were optimized away, processing is still needed to convert the channel count
+	return filterCount == 0 && (configuredFilterCount == 0 || realChannelCount == outputChannelCount);
+}
+
+unsigned FilterConfiguration::getLatency()
+{
+	// filters on different channels may run in parallel, so this is an upper bound
+	unsigned latency = 0;
+	for (size_t i = 0; i < filterCount; i++)
+		latency += filterInfos[i]->filter->getLatency();
+
+	return latency;
 }
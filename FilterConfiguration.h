@@ -34,6 +34,8 @@ struct FilterInfo
 	size_t inChannelCount;
 	size_t* outChannels;
 	size_t outChannelCount;
+	// delay realized by shifting the channel buffers instead of calling process, 0 if process is called
+	unsigned bufferDelay;
 };
 
 #pragma AVRT_VTABLES_BEGIN
@@ -50,9 +52,19 @@ public:
 	void write(double* output, unsigned frameCount);
 	void write(double** output, unsigned frameCount);
 	double** getOutputSamples() {return allSamples;}
+	// clears the state of the filters and the channel history, so that an unrelated signal can follow
+	void reset();
 	bool isEmpty();
+	unsigned getLatency();
 
 private:
+	void resolveChannels();
+	bool mergeFilters();
+	void optimizeFilters();
+	bool foldGain(FilterInfo* target, const size_t* channels, size_t channelCount, double gain, bool following);
+	void removeFilter(size_t index);
+	void rewindChannels(unsigned frameCount);
+
 	unsigned realChannelCount;
 	unsigned outputChannelCount;
 	unsigned allChannelCount;
@@ -60,7 +72,14 @@ private:
 	double** allSamples2;
 	double** currentSamples;
 	double** currentSamples2;
+	double** sampleBuffers;
+	double** sampleBuffers2;
+	unsigned* ringDelays;
+	unsigned* ringPositions;
+	unsigned maxFrameCount;
+	unsigned lastFrameCount;
 	FilterInfo** filterInfos;
 	unsigned filterCount;
+	unsigned configuredFilterCount;
 };
 #pragma AVRT_VTABLES_END
@@ -39,7 +39,10 @@
 #include "helpers/StringHelper.h"
 #include "helpers/LogHelper.h"
 #include "helpers/MemoryHelper.h"
+#include "helpers/SimdHelper.h"
 #include "helpers/ChannelHelper.h"
+#include "helpers/ConfigFile.h"
+#include "helpers/ConfigService.h"
 #include "FilterEngine.h"
 #include "filters/ExpressionFilterFactory.h"
 #include "filters/DeviceFilterFactory.h"
@@ -71,15 +74,21 @@ FilterEngine::FilterEngine()
       outputChannelCount(0),
 	  lastInputWasSilent(false),
 	  threadHandle(nullptr),
+	  fileChangeEvent(nullptr),
+	  watchingFiles(false),
 	  currentConfig(nullptr),
 	  nextConfig(nullptr),
 	  previousConfig(nullptr),
+	  sampleRate(0.0f),
+	  latency(0),
 	  transitionCounter(0)
 {
 	InitializeCriticalSection(&loadSection);
 	loadSemaphore = CreateSemaphore(NULL, 1, 1, NULL);
 	parser = new ParserX();
 	parser->EnableAutoCreateVar(true);
+	// selects the kernels here, so the first call to process does not have to
+	SimdHelper::getKernels();
 
 	factories.push_back(new DeviceFilterFactory());
 	factories.push_back(new IfFilterFactory());
@@ -96,6 +105,8 @@ FilterEngine::FilterEngine()
 	factories.push_back(new GraphicEQFilterFactory());
 	factories.push_back(new VSTPluginFilterFactory());
 	factories.push_back(new LoudnessCorrectionFilterFactory());
+
+	initializeCommandFactories();
 }
 
 FilterEngine::~FilterEngine()
@@ -113,6 +124,17 @@ FilterEngine::~FilterEngine()
 		threadHandle = NULL;
 	}
 
+	if (watchingFiles)
+	{
+		ConfigService::getInstance().unwatchFiles(this);
+		watchingFiles = false;
+	}
+	if (fileChangeEvent != NULL)
+	{
+		CloseHandle(fileChangeEvent);
+		fileChangeEvent = NULL;
+	}
+
 	cleanupConfigurations();
 
 	for (IFilterFactory* factory : factories)
@@ -195,15 +217,24 @@ void FilterEngine::initialize(float sampleRate, unsigned inputChannelCount, unsi
 	vector<wstring> channelNames = ChannelHelper::getChannelNames(deviceChannelCount, channelMask);
 	TraceF(L"%d channels for this device: %s", deviceChannelCount, StringHelper::join(channelNames, L" ").c_str());
 
-	try
+	if (!customPath.empty())
 	{
-		configPath = RegistryHelper::readValue(APP_REGPATH, L"ConfigPath");
+		// a given configuration file can be loaded without an installation, e.g. for offline rendering
+		size_t pos = customPath.find_last_of(L"\\/");
+		configPath = pos == wstring::npos ? L"." : customPath.substr(0, pos);
 	}
-	catch (RegistryException e)
+	else
 	{
-		LogF(L"Can't read config path because of: %s", e.getMessage().c_str());
-		LeaveCriticalSection(&loadSection);
-		return;
+		try
+		{
+			configPath = RegistryHelper::readValue(APP_REGPATH, L"ConfigPath");
+		}
+		catch (RegistryException e)
+		{
+			LogF(L"Can't read config path because of: %s", e.getMessage().c_str());
+			LeaveCriticalSection(&loadSection);
+			return;
+		}
 	}
 
 	parser->ClearConst();
@@ -224,6 +255,12 @@ void FilterEngine::initialize(float sampleRate, unsigned inputChannelCount, unsi
 
 	if (configPath != L"")
 	{
+		if (!watchingFiles && customPath.empty())
+		{
+			fileChangeEvent = CreateEventW(NULL, true, false, NULL);
+			watchingFiles = ConfigService::getInstance().watchFiles(this, vector<wstring>());
+		}
+
 		loadConfig(customPath);
 
 		if (threadHandle == NULL && customPath.empty())
@@ -233,7 +270,7 @@ void FilterEngine::initialize(float sampleRate, unsigned inputChannelCount, unsi
 			if (threadHandle == INVALID_HANDLE_VALUE)
 				threadHandle = NULL;
 			else
-				TraceF(L"Successfully created directory change notification thread %d for %s and its subtree", GetThreadId(threadHandle), configPath.c_str());
+				TraceF(L"Successfully created change notification thread %d", GetThreadId(threadHandle));
 		}
 	}
 	LeaveCriticalSection(&loadSection);
@@ -256,6 +293,7 @@ void FilterEngine::loadConfig(const wstring& customPath)
 	lastChannelNames.clear();
 	lastNewChannelNames.clear();
 	watchRegistryKeys.clear();
+	watchFiles.clear();
 	parser->ClearVar();
 
 	for (vector<IFilterFactory*>::const_iterator it = factories.cbegin(); it != factories.cend(); it++)
@@ -284,6 +322,23 @@ void FilterEngine::loadConfig(const wstring& customPath)
 
 	filterInfos.clear();
 
+	unsigned configLatency = config->getLatency();
+	latency.store(configLatency, memory_order_relaxed);
+	if (configLatency > 0)
+		TraceF(L"Configuration adds a latency of %d frames", configLatency);
+
+	// forget the contents of files that are not used anymore
+	for (auto it = configFiles.begin(); it != configFiles.end();)
+	{
+		if (watchFiles.find(it->first) == watchFiles.end())
+			it = configFiles.erase(it);
+		else
+			it++;
+	}
+
+	if (watchingFiles)
+		ConfigService::getInstance().watchFiles(this, vector<wstring>(watchFiles.begin(), watchFiles.end()));
+
 	double loadTime = timer.stop();
 	TraceF(L"Finished loading configuration after %lf milliseconds", loadTime * 1000.0);
 
@@ -295,40 +350,25 @@ void FilterEngine::loadConfig(const wstring& customPath)
 	LeaveCriticalSection(&loadSection);
 }
 
+void FilterEngine::reloadConfig(const wstring& customPath)
+{
+	WaitForSingleObject(loadSemaphore, INFINITE);
+	loadConfig(customPath);
+}
+
 void FilterEngine::loadConfigFile(const wstring& path)
 {
 	TraceF(L"Loading configuration from %s", path.c_str());
 
-	HANDLE hFile = INVALID_HANDLE_VALUE;
-	while (hFile == INVALID_HANDLE_VALUE)
-	{
-		hFile = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-		if (hFile == INVALID_HANDLE_VALUE)
-		{
-			DWORD error = GetLastError();
-			if (error != ERROR_SHARING_VIOLATION)
-			{
-				LogF(L"Error while reading configuration file %s: %s", path.c_str(), StringHelper::getSystemErrorString(error).c_str());
-				return;
-			}
-
-			// file is being written, so wait
-			Sleep(1);
-		}
-	}
-
-	stringstream inputStream;
+	watchFile(path);
 
-	char buf[8192];
-	unsigned long bytesRead = -1;
-	while (ReadFile(hFile, buf, sizeof(buf), &bytesRead, NULL) && bytesRead != 0)
+	shared_ptr<const ConfigFile> file = ConfigService::getInstance().loadFile(path);
+	if (file == nullptr)
 	{
-		inputStream.write(buf, bytesRead);
+		configFiles.erase(path);
+		return;
 	}
-
-	CloseHandle(hFile);
-
-	inputStream.seekg(0);
+	configFiles[path] = file;
 
 	vector<wstring> savedChannelNames = currentChannelNames;
 
@@ -340,27 +380,16 @@ void FilterEngine::loadConfigFile(const wstring& path)
 			addFilters(newFilters);
 	}
 
-	while (inputStream.good())
+	const wstring& text = file->getText();
+	for (const ConfigFile::Line& line : file->getLines())
 	{
-		string encodedLine;
-		getline(inputStream, encodedLine);
-		if (encodedLine.size() > 0 && encodedLine[encodedLine.size() - 1] == '\r')
-			encodedLine.resize(encodedLine.size() - 1);
-
-		wstring line = StringHelper::toWString(encodedLine, CP_UTF8);
-		if (line.find(L'\uFFFD') != -1)
-			line = StringHelper::toWString(encodedLine, CP_ACP);
-
-		size_t pos = line.find(L':');
-		if (pos != -1)
+		if (line.commandOffset != wstring::npos)
 		{
-			wstring key = line.substr(0, pos);
-			wstring value = line.substr(pos + 1);
+			wstring key(text, line.commandOffset, line.commandLength);
+			wstring value(text, line.parametersOffset, line.offset + line.length - line.parametersOffset);
 
-			// allow to use indentation
-			key = StringHelper::trim(key);
-
-			for (vector<IFilterFactory*>::const_iterator it = factories.cbegin(); it != factories.cend(); it++)
+			const vector<IFilterFactory*>& keyFactories = getCommandFactories(key);
+			for (vector<IFilterFactory*>::const_iterator it = keyFactories.cbegin(); it != keyFactories.cend(); it++)
 			{
 				IFilterFactory* factory = *it;
 
@@ -397,86 +426,107 @@ void FilterEngine::loadConfigFile(const wstring& path)
 	currentChannelNames = savedChannelNames;
 }
 
+void FilterEngine::initializeCommandFactories()
+{
+	vector<vector<wstring>> commands;
+	for (IFilterFactory* factory : factories)
+		commands.push_back(factory->getCommands());
+
+	// collects the factories for a command or, if prefix is true, for all commands starting with it
+	auto collect = [&](const wstring& command, bool prefix)
+	{
+		vector<IFilterFactory*> result;
+		for (size_t i = 0; i < factories.size(); i++)
+		{
+			bool matches = commands[i].empty();
+			for (const wstring& c : commands[i])
+			{
+				if (c.length() > 0 && c[c.length() - 1] == L'*')
+					matches |= command.compare(0, c.length() - 1, c, 0, c.length() - 1) == 0;
+				else if (!prefix)
+					matches |= command == c;
+			}
+
+			if (matches)
+				result.push_back(factories[i]);
+		}
+
+		return result;
+	};
+
+	for (const vector<wstring>& factoryCommands : commands)
+	{
+		for (const wstring& c : factoryCommands)
+		{
+			if (c.length() > 0 && c[c.length() - 1] == L'*')
+			{
+				wstring prefix = c.substr(0, c.length() - 1);
+				auto it = find_if(prefixFactories.begin(), prefixFactories.end(), [&](const pair<wstring, vector<IFilterFactory*>>& p) {return p.first == prefix;});
+				if (it == prefixFactories.end())
+					prefixFactories.push_back(make_pair(prefix, collect(prefix, true)));
+			}
+			else
+			{
+				commandFactories[c] = collect(c, false);
+			}
+		}
+	}
+
+	// a command matching a longer prefix also matches all shorter ones, so their factories are already included
+	sort(prefixFactories.begin(), prefixFactories.end(), [](const pair<wstring, vector<IFilterFactory*>>& a, const pair<wstring, vector<IFilterFactory*>>& b)
+	{
+		return a.first.length() > b.first.length();
+	});
+
+	for (size_t i = 0; i < factories.size(); i++)
+	{
+		if (commands[i].empty())
+			lineFactories.push_back(factories[i]);
+	}
+}
+
+const vector<IFilterFactory*>& FilterEngine::getCommandFactories(const wstring& command) const
+{
+	auto it = commandFactories.find(command);
+	if (it != commandFactories.end())
+		return it->second;
+
+	for (const pair<wstring, vector<IFilterFactory*>>& p : prefixFactories)
+	{
+		if (command.compare(0, p.first.length(), p.first) == 0)
+			return p.second;
+	}
+
+	return lineFactories;
+}
+
 void FilterEngine::watchRegistryKey(const std::wstring& key)
 {
 	watchRegistryKeys.insert(key);
 }
 
-#pragma AVRT_CODE_BEGIN
-void convertFloatToDouble(double* dest, const float* src, size_t count) {
-#if defined(__AVX512F__) && !defined(_M_ARM64) // AVX-512 Path (e.g., Zen 4, some Intel CPUs)
-	size_t i = 0;
-	for (; i + 16 <= count; i += 16) {
-		// Load 16 floats
-		__m512 float_vec = _mm512_loadu_ps(src + i);
-		// Convert the lower 8 floats to 8 doubles
-		__m512d double_vec_lo = _mm512_cvtps_pd(_mm512_extractf32x8_ps(float_vec, 0));
-		// Convert the upper 8 floats to 8 doubles
-		__m512d double_vec_hi = _mm512_cvtps_pd(_mm512_extractf32x8_ps(float_vec, 1));
-		// Store the 16 resulting doubles
-		_mm512_storeu_pd(dest + i, double_vec_lo);
-		_mm512_storeu_pd(dest + i + 8, double_vec_hi);
-	}
-	// Handle any remaining elements
-	for (; i < count; ++i) dest[i] = static_cast<double>(src[i]);
-#elif defined(__AVX2__) && !defined(_M_ARM64) // AVX2 / AVX Fallback Path (e.g., Zen 2/3)
-	size_t i = 0;
-	for (; i + 8 <= count; i += 8) {
-		// Load 8 floats into a 256-bit register
-		__m256 float_vec = _mm256_loadu_ps(src + i);
-		// Convert the lower 4 floats to 4 doubles
-		__m256d double_vec_lo = _mm256_cvtps_pd(_mm256_extractf128_ps(float_vec, 0));
-		// Convert the upper 4 floats to 4 doubles
-		__m256d double_vec_hi = _mm256_cvtps_pd(_mm256_extractf128_ps(float_vec, 1));
-		// Store the 8 resulting doubles
-		_mm256_storeu_pd(dest + i, double_vec_lo);
-		_mm256_storeu_pd(dest + i + 4, double_vec_hi);
-	}
-	// Handle any remaining elements
-	for (; i < count; ++i) dest[i] = static_cast<double>(src[i]);
-#else // Scalar fallback for non-x86 or very old CPUs
-	for (size_t i = 0; i < count; ++i) dest[i] = static_cast<double>(src[i]);
-#endif
+void FilterEngine::watchFile(const std::wstring& path)
+{
+	watchFiles.insert(path);
 }
 
-// Converts a block of doubles back to floats.
-void convertDoubleToFloat(float* dest, const double* src, size_t count) {
-#if defined(__AVX512F__) && !defined(_M_ARM64) // AVX-512 Path
-	size_t i = 0;
-	for (; i + 16 <= count; i += 16) {
-		// Load 16 doubles from memory
-		__m512d double_vec_lo = _mm512_loadu_pd(src + i);
-		__m512d double_vec_hi = _mm512_loadu_pd(src + i + 8);
-		// Convert 8 doubles to 8 floats
-		__m256 float_vec_lo = _mm512_cvtpd_ps(double_vec_lo);
-		// Convert another 8 doubles to 8 floats
-		__m256 float_vec_hi = _mm512_cvtpd_ps(double_vec_hi);
-		// Combine the two 256-bit float vectors into one 512-bit vector
-		__m512 float_vec = _mm512_insertf32x8(_mm512_castps256_ps512(float_vec_lo), float_vec_hi, 1);
-		_mm512_storeu_ps(dest + i, float_vec);
-	}
-	for (; i < count; ++i) dest[i] = static_cast<float>(src[i]);
-#elif defined(__AVX2__) && !defined(_M_ARM64) // AVX2 / AVX Fallback Path
-	size_t i = 0;
-	for (; i + 8 <= count; i += 8) {
-		// Load 8 doubles from memory
-		__m256d double_vec_lo = _mm256_loadu_pd(src + i);
-		__m256d double_vec_hi = _mm256_loadu_pd(src + i + 4);
-		// Convert 4 doubles to 4 floats
-		__m128 float_vec_lo = _mm256_cvtpd_ps(double_vec_lo);
-		// Convert another 4 doubles to 4 floats
-		__m128 float_vec_hi = _mm256_cvtpd_ps(double_vec_hi);
-		// Combine the two 128-bit float vectors into one 256-bit vector
-		__m256 float_vec = _mm256_insertf128_ps(_mm256_castps128_ps256(float_vec_lo), float_vec_hi, 1);
-		_mm256_storeu_ps(dest + i, float_vec);
-	}
-	for (; i < count; ++i) dest[i] = static_cast<float>(src[i]);
-#else // Scalar fallback
-	for (size_t i = 0; i < count; ++i) dest[i] = static_cast<float>(src[i]);
-#endif
+void FilterEngine::reset()
+{
+	EnterCriticalSection(&loadSection);
+	if (currentConfig != NULL)
+		currentConfig->reset();
+	if (nextConfig != NULL)
+		nextConfig->reset();
+	LeaveCriticalSection(&loadSection);
 }
 
+void FilterEngine::fileChanged(const std::wstring& path)
+{
+	TraceF(L"%s has changed", path.c_str());
+	SetEvent(fileChangeEvent);
+}
 
+#pragma AVRT_CODE_BEGIN
 // Process interleaved audio (float*)
 void FilterEngine::process(float* output, float* input, unsigned frameCount)
 {
@@ -494,7 +544,7 @@ void FilterEngine::process(float* output, float* input, unsigned frameCount)
 
 	// Conversion from float to double using SIMD
 	const unsigned inputSampleCount = inputChannelCount * frameCount;
-	convertFloatToDouble(inputBuf1D.data(), input, inputSampleCount);
+	SimdHelper::getKernels().convertFloatToDouble(inputBuf1D.data(), input, inputSampleCount);
 
 	// The core processing logic remains unchanged
 	currentConfig->read(inputBuf1D.data(), frameCount);
@@ -511,7 +561,7 @@ void FilterEngine::process(float* output, float* input, unsigned frameCount)
 
 	// Conversion from double back to float using SIMD
 	const unsigned outputSampleCount = outputChannelCount * frameCount;
-	convertDoubleToFloat(output, outputBuf1D.data(), outputSampleCount);
+	SimdHelper::getKernels().convertDoubleToFloat(output, outputBuf1D.data(), outputSampleCount);
 
 	if (nextConfig != NULL && transitionCounter >= transitionLength)
 	{
@@ -545,8 +595,9 @@ void FilterEngine::process(float** output, float** input, unsigned frameCount)
 	for (unsigned i = 0; i < outputChannelCount; ++i) tempOutputPtrs[i] = outputBuf2D[i].get();
 
 	// Optimized conversion for each channel
+	const SimdKernels& kernels = SimdHelper::getKernels();
 	for (unsigned c = 0; c < inputChannelCount; c++) {
-		convertFloatToDouble(inputBuf2D[c].get(), input[c], frameCount);
+		kernels.convertFloatToDouble(inputBuf2D[c].get(), input[c], frameCount);
 	}
 
 	// Core processing logic is the same
@@ -564,7 +615,7 @@ void FilterEngine::process(float** output, float** input, unsigned frameCount)
 
 	// Optimized conversion back for each channel
 	for (unsigned c = 0; c < outputChannelCount; c++) {
-		convertDoubleToFloat(output[c], outputBuf2D[c].get(), frameCount);
+		kernels.convertDoubleToFloat(output[c], outputBuf2D[c].get(), frameCount);
 	}
 
 	// Transition logic remains the same
@@ -753,13 +804,11 @@ unsigned long __stdcall FilterEngine::notificationThread(void* parameter)
 {
 	FilterEngine* engine = (FilterEngine*)parameter;
 
-	HANDLE notificationHandle = FindFirstChangeNotificationW(engine->configPath.c_str(), true, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
-	if (notificationHandle == INVALID_HANDLE_VALUE)
-		notificationHandle = NULL;
-
 	HANDLE registryEvent = CreateEventW(NULL, true, false, NULL);
 
-	HANDLE handles[3] = {engine->shutdownEvent, notificationHandle, registryEvent};
+	// without a file watcher, only registry changes are noticed
+	HANDLE handles[3] = {engine->shutdownEvent, registryEvent, engine->fileChangeEvent};
+	DWORD handleCount = engine->watchingFiles ? 3 : 2;
 	while (true)
 	{
 		vector<HKEY> keyHandles;
@@ -777,7 +826,7 @@ unsigned long __stdcall FilterEngine::notificationThread(void* parameter)
 			}
 		}
 
-		DWORD which = WaitForMultipleObjects(3, handles, false, INFINITE);
+		DWORD which = WaitForMultipleObjects(handleCount, handles, false, INFINITE);
 
 		for (auto it = keyHandles.begin(); it != keyHandles.end(); it++)
 		{
@@ -791,11 +840,12 @@ unsigned long __stdcall FilterEngine::notificationThread(void* parameter)
 		}
 		else
 		{
-			if (which == WAIT_OBJECT_0 + 1)
+			if (which == WAIT_OBJECT_0 + 2)
 			{
-				FindNextChangeNotification(notificationHandle);
-				// Wait for second event within 10 milliseconds to avoid loading twice
-				WaitForMultipleObjects(1, &notificationHandle, false, 10);
+				// Wait 10 milliseconds for further changes to avoid loading twice
+				if (WaitForSingleObject(engine->shutdownEvent, 10) == WAIT_OBJECT_0)
+					break;
+				ResetEvent(engine->fileChangeEvent);
 			}
 
 			HANDLE handles[2] = {engine->shutdownEvent, engine->loadSemaphore};
@@ -807,12 +857,10 @@ unsigned long __stdcall FilterEngine::notificationThread(void* parameter)
 			}
 
 			engine->loadConfig();
-			FindNextChangeNotification(notificationHandle);
 			ResetEvent(registryEvent);
 		}
 	}
 
-	FindCloseChangeNotification(notificationHandle);
 	CloseHandle(registryEvent);
 
 	return 0;
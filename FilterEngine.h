@@ -19,8 +19,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -29,13 +32,16 @@
 #include "FilterConfiguration.h"
 #include "helpers/PrecisionTimer.h"
 #include "helpers/MemoryHelper.h"
+#include "helpers/FileWatcher.h"
+
+class ConfigFile;
 
 namespace mup {
 class ParserX;
 }
 
 #pragma AVRT_VTABLES_BEGIN
-class FilterEngine
+class FilterEngine : private IFileChangeListener
 {
 public:
 	FilterEngine();
@@ -45,8 +51,15 @@ public:
 	void setDeviceInfo(bool capture, bool postMixInstalled, const std::wstring& deviceName, const std::wstring& connectionName, const std::wstring& deviceGuid, const std::wstring& deviceString);
 	void initialize(float sampleRate, unsigned inputChannelCount, unsigned realChannelCount, unsigned outputChannelCount, unsigned channelMask, unsigned maxFrameCount, const std::wstring& customPath = L"");
 	void loadConfig(const std::wstring& customPath = L"");
+	// loads the configuration on another thread than process, after waiting for the transition to the last one to finish
+	void reloadConfig(const std::wstring& customPath = L"");
 	void loadConfigFile(const std::wstring& path);
 	void watchRegistryKey(const std::wstring& key);
+	// the configuration is reloaded when the file is created, changed or deleted
+	void watchFile(const std::wstring& path);
+	// clears the state of the filters without loading the configuration again, e.g. before rendering another file.
+	// Must not be called concurrently with process.
+	void reset();
 	void process(float* output, float* input, unsigned frameCount);
 	void process(float** output, float** input, unsigned frameCount);
 	void process(double* output, double* input, unsigned frameCount);
@@ -65,15 +78,27 @@ public:
 	unsigned getChannelMask() const {return channelMask;}
 	float getSampleRate() const {return sampleRate;}
 	unsigned getMaxFrameCount() const {return maxFrameCount;}
+	unsigned getLatency() const {return latency.load(std::memory_order_relaxed);}
+	// whether process is crossfading to a newly loaded configuration
+	bool isInTransition() const {return nextConfig != NULL;}
 	mup::ParserX* getParser() {return parser;}
 
 private:
 	void addFilters(std::vector<IFilter*> filters);
+	void initializeCommandFactories();
+	const std::vector<IFilterFactory*>& getCommandFactories(const std::wstring& command) const;
 	void cleanupConfigurations();
 	static unsigned long __stdcall notificationThread(void* parameter);
+	void fileChanged(const std::wstring& path) override;
 	void resizeBuffers(unsigned frameCount);
 
 	std::vector<IFilterFactory*> factories;
+	// factories that a line is passed to, in the order of factories, by the commands they declare
+	std::unordered_map<std::wstring, std::vector<IFilterFactory*>> commandFactories;
+	// by command prefix, longest prefix first
+	std::vector<std::pair<std::wstring, std::vector<IFilterFactory*>>> prefixFactories;
+	// for lines with other commands, only the factories that see every line
+	std::vector<IFilterFactory*> lineFactories;
 
 	std::vector<std::unique_ptr<double[]>> inputBuf2D, outputBuf2D;
 	std::vector<double> inputBuf1D, outputBuf1D;
@@ -109,6 +134,8 @@ private:
 	FilterConfiguration* nextConfig;
 	FilterConfiguration* previousConfig;
 
+	// read by the audio engine while a configuration is being loaded
+	std::atomic<unsigned> latency;
 	unsigned transitionCounter;
 	unsigned transitionLength;
 	HANDLE loadSemaphore;
@@ -116,7 +143,12 @@ private:
 	PrecisionTimer timer;
 	void* threadHandle;
 	void* shutdownEvent;
+	void* fileChangeEvent;
+	bool watchingFiles;
 	std::unordered_set<std::wstring> watchRegistryKeys;
+	std::unordered_set<std::wstring> watchFiles;
+	// contents of the files of the last configuration, which keeps them cached in the ConfigService
+	std::unordered_map<std::wstring, std::shared_ptr<const ConfigFile>> configFiles;
 	bool lastInputWasSilent;
 };
 #pragma AVRT_VTABLES_END
@@ -39,6 +39,27 @@ public:
 	// return value is the channelNames vector, which may contain additional or fewer channel names
 	virtual std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) = 0;
 	virtual void process(double** output, double** input, unsigned frameCount) = 0;
+	// clears the state kept from previous calls to process, so that an unrelated signal can follow
+	// without reinitialization. Not called concurrently with process.
+	virtual void reset() {}
+	// number of frames by which the output is delayed relative to the input, reported to the audio engine
+	virtual unsigned getLatency() {return 0;}
+	// number of frames by which all channels are delayed without any other change,
+	// so that the configuration may shift its channel buffers instead of calling process
+	virtual unsigned getBufferDelay() {return 0;}
+	// return true if process leaves the audio unchanged, so that the filter can be left out
+	virtual bool isIdentity() {return false;}
+	// multiplies the output on the given channels (indices into the vector returned by initialize) by gain,
+	// for in-place filters this must be the same as multiplying the input. Returns false if not supported.
+	virtual bool applyGain(const std::vector<size_t>& channels, double gain) {return false;}
+	// return true if process only multiplies all channels by the same constant gain, so that the gain can be
+	// folded into a neighbouring filter with applyGain and this filter can be left out
+	virtual bool getConstantGain(double& gain) {return false;}
+	// Combines the directly following filter into this one, so that the following filter does not need to be processed.
+	// The channel indices are those of both filters in the filter configuration. Returns false if this is not
+	// supported for the following filter, otherwise outChannels is set to the combined output channels.
+	virtual bool mergeNext(IFilter* next, const std::vector<size_t>& inChannels, std::vector<size_t>& outChannels,
+		const std::vector<size_t>& nextInChannels, const std::vector<size_t>& nextOutChannels) {return false;}
 
 protected:
 };
@@ -36,6 +36,9 @@ public:
 	virtual void initialize(FilterEngine* engine) {}
 	virtual std::vector<IFilter*> startOfConfiguration() {return std::vector<IFilter*>();}
 	virtual std::vector<IFilter*> startOfFile(const std::wstring& configPath) {return std::vector<IFilter*>();}
+	// commands passed to createFilter, a trailing '*' also matches all commands starting with the text before it.
+	// Without commands, createFilter is called for every line, e.g. to skip lines or to modify the parameters.
+	virtual std::vector<std::wstring> getCommands() {return std::vector<std::wstring>();}
 	// command and parameter may be altered by the factory
 	virtual std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) = 0;
 	virtual std::vector<IFilter*> endOfFile(const std::wstring& configPath) {return std::vector<IFilter*>();}
@@ -0,0 +1,197 @@
+/*
+	This file is part of Equalizer APO, a system-wide equalizer.
+	Copyright (C) 2026  Jonas Thedering
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <thread>
+
+#include "../helpers/PrecisionTimer.h"
+#include "../helpers/LogHelper.h"
+#include "VoicemeeterBusProcessor.h"
+
+using namespace std;
+
+// waking the workers takes some microseconds, so buses are only processed in parallel if they took longer than this
+static const double PARALLEL_MIN_TIME = 0.0001;
+
+VoicemeeterBusProcessor::VoicemeeterBusProcessor(bool parallel, const wstring& customPath)
+	: parallel(parallel), customPath(customPath)
+{
+}
+
+VoicemeeterBusProcessor::~VoicemeeterBusProcessor()
+{
+	workerPool.cleanup();
+	deleteEngines();
+}
+
+void VoicemeeterBusProcessor::setEngines(const vector<FilterEngine*>& engines)
+{
+	workerPool.cleanup();
+	deleteEngines();
+
+	unsigned engineCount = 0;
+	for (FilterEngine* engine : engines)
+	{
+		if (engine != NULL)
+		{
+			if (sampleRate != 0.0f && maxFrameCount != 0)
+				engine->initialize(sampleRate, 8, 8, 8, 0, maxFrameCount, customPath);
+			engineCount++;
+		}
+
+		Bus bus;
+		bus.engine = engine;
+		bus.idleSampleCount = 0;
+		bus.inputSilent = true;
+		bus.time = 0.0;
+		buses.push_back(bus);
+	}
+	activeBuses.reserve(buses.size());
+
+	// one bus is always processed by the callback itself, which waits for the workers by spinning,
+	// so there must not be more workers than other processors
+	unsigned parallelCount = min(engineCount, thread::hardware_concurrency());
+	if (parallel && parallelCount > 1)
+	{
+		workerPool.initialize(parallelCount - 1, &runWorkerTask, this);
+		TraceF(L"Processing up to %d Voicemeeter buses in parallel", parallelCount);
+	}
+}
+
+void VoicemeeterBusProcessor::handle(long nCommand, void* lpData)
+{
+	switch (nCommand)
+	{
+	case VBVMR_CBCOMMAND_STARTING:
+	{
+		VBVMR_LPT_AUDIOINFO audioInfo = (VBVMR_LPT_AUDIOINFO)lpData;
+		sampleRate = (float)audioInfo->samplerate;
+		maxFrameCount = audioInfo->nbSamplePerFrame;
+		for (Bus& bus : buses)
+			if (bus.engine != NULL)
+				bus.engine->initialize(sampleRate, 8, 8, 8, 0, maxFrameCount, customPath);
+	}
+	break;
+	case VBVMR_CBCOMMAND_BUFFER_OUT:
+		process((VBVMR_LPT_AUDIOBUFFER)lpData);
+		break;
+	}
+}
+
+void VoicemeeterBusProcessor::deleteEngines()
+{
+	for (Bus& bus : buses)
+		if (bus.engine != NULL)
+			delete bus.engine;
+	buses.clear();
+}
+
+void VoicemeeterBusProcessor::process(VBVMR_LPT_AUDIOBUFFER audioBuffer)
+{
+	this->audioBuffer = audioBuffer;
+	unsigned n = min(audioBuffer->audiobuffer_nbi, audioBuffer->audiobuffer_nbo) / 8;
+
+	activeBuses.clear();
+	double totalTime = 0.0;
+	for (unsigned i = 0; i < n; i++)
+	{
+		bool idle = true;
+		if (i < buses.size() && buses[i].engine != NULL)
+		{
+			Bus& bus = buses[i];
+			bus.inputSilent = isBufferSilent(audioBuffer->audiobuffer_r + 8 * i, audioBuffer->audiobuffer_nbs);
+			idle = bus.inputSilent && bus.idleSampleCount > 10 * bus.engine->getSampleRate();
+		}
+
+		// avoid processing when idle (Voicemeeter does still call this when no audio is played)
+		if (!idle)
+		{
+			activeBuses.push_back(i);
+			totalTime += buses[i].time;
+		}
+		else
+		{
+			for (int j = 0; j < 8; j++)
+				memcpy(audioBuffer->audiobuffer_w[8 * i + j], audioBuffer->audiobuffer_r[8 * i + j], audioBuffer->audiobuffer_nbs * sizeof(float));
+		}
+	}
+
+	unsigned workerCount = 0;
+	if (activeBuses.size() > 1 && totalTime >= PARALLEL_MIN_TIME)
+		workerCount = min((unsigned)activeBuses.size() - 1, workerPool.getWorkerCount());
+
+	// fork: the first active bus stays on the callback, the next ones go to the workers
+	for (unsigned i = 0; i < workerCount; i++)
+		workerPool.start(i, activeBuses[i + 1]);
+
+	for (size_t i = 0; i < activeBuses.size(); i++)
+		if (i == 0 || i > workerCount)
+			processBus(activeBuses[i]);
+
+	// join: the workers write into the buffers of Voicemeeter, so they are waited for without a deadline
+	for (unsigned i = 0; i < workerCount; i++)
+		workerPool.join(i, LLONG_MAX);
+
+	this->audioBuffer = NULL;
+}
+
+void VoicemeeterBusProcessor::processBus(unsigned index)
+{
+	Bus& bus = buses[index];
+	float** output = audioBuffer->audiobuffer_w + 8 * index;
+	float** input = audioBuffer->audiobuffer_r + 8 * index;
+	long frameCount = audioBuffer->audiobuffer_nbs;
+
+	PrecisionTimer timer;
+	timer.start();
+	bus.engine->process(output, input, frameCount);
+	bus.time = timer.stop();
+
+	bool outputSilent = isBufferSilent(output, frameCount);
+	if (bus.inputSilent && outputSilent)
+		bus.idleSampleCount += frameCount;
+	else
+		bus.idleSampleCount = 0;
+}
+
+void VoicemeeterBusProcessor::runWorkerTask(void* context, unsigned task)
+{
+	VoicemeeterBusProcessor* processor = (VoicemeeterBusProcessor*)context;
+	processor->processBus(task);
+}
+
+bool VoicemeeterBusProcessor::isBufferSilent(float** sampleData, long sampleCount)
+{
+	bool silent = true;
+
+	for (int j = 0; j < 8; j++)
+	{
+		float* buf = sampleData[j];
+		for (int k = 0; k < sampleCount; k++)
+		{
+			if (buf[k] != 0.0f)
+			{
+				silent = false;
+				break;
+			}
+		}
+	}
+
+	return silent;
+}
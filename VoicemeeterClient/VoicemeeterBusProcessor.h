@@ -0,0 +1,69 @@
+/*
+    This file is part of Equalizer APO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../FilterEngine.h"
+#include "../helpers/RealtimeWorkerPool.h"
+#include "VoicemeeterRemote.h"
+
+// Processes the output buses of Voicemeeter, 8 channels each, with one FilterEngine per bus in the audio callback.
+// When several buses have enough work, they are processed on worker threads while the callback processes one of them.
+class VoicemeeterBusProcessor
+{
+public:
+	// customPath is passed to FilterEngine::initialize
+	VoicemeeterBusProcessor(bool parallel, const std::wstring& customPath = L"");
+	~VoicemeeterBusProcessor();
+
+	// takes ownership of the engines, buses without an engine are passed through
+	void setEngines(const std::vector<FilterEngine*>& engines);
+	bool isParallel() const {return parallel;}
+
+	// handles VBVMR_CBCOMMAND_STARTING and VBVMR_CBCOMMAND_BUFFER_OUT of the audio callback
+	void handle(long nCommand, void* lpData);
+
+private:
+	struct Bus
+	{
+		FilterEngine* engine;
+		int idleSampleCount;
+		bool inputSilent;
+		// processing time of the last buffer in seconds
+		double time;
+	};
+
+	void deleteEngines();
+	void process(VBVMR_LPT_AUDIOBUFFER audioBuffer);
+	void processBus(unsigned index);
+	static void runWorkerTask(void* context, unsigned task);
+	static bool isBufferSilent(float** sampleData, long sampleCount);
+
+	bool parallel;
+	std::wstring customPath;
+	float sampleRate = 0.0f;
+	unsigned maxFrameCount = 0;
+	std::vector<Bus> buses;
+	std::vector<unsigned> activeBuses;
+	RealtimeWorkerPool workerPool;
+	// only valid during process
+	VBVMR_LPT_AUDIOBUFFER audioBuffer = NULL;
+};
@@ -23,6 +23,7 @@
 #include <windows.h>
 #include <shellapi.h>
 #include "../helpers/RegistryHelper.h"
+#include "../helpers/LogHelper.h"
 #include "VoicemeeterClient.h"
 #include "../VoicemeeterAPOInfo.h"
 
@@ -55,21 +56,24 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 		LocalFree(argv);
 	}
 
+	LogHelper::startWriter();
 	try
 	{
 		VoicemeeterClient client(outputs);
 		client.run();
+		LogHelper::stopWriter();
 		return 0;
 	}
 	catch (InitError e)
 	{
+		LogHelper::stopWriter();
 		MessageBoxW(NULL, e.getMessage().c_str(), L"Equalizer APO Voicemeeter Client Initialization Error", MB_APPLMODAL | MB_OK | MB_ICONERROR);
 		return -1;
 	}
 }
 
 VoicemeeterClient::VoicemeeterClient(const vector<wstring>& outputs)
-	: outputs(outputs)
+	: outputs(outputs), busProcessor(true)
 {
 	mainThreadId = GetCurrentThreadId();
 
@@ -150,16 +154,13 @@ void VoicemeeterClient::run()
 
 void VoicemeeterClient::handle(long nCommand, void* lpData, long nnn)
 {
+	busProcessor.handle(nCommand, lpData);
+
 	switch (nCommand)
 	{
 	case VBVMR_CBCOMMAND_STARTING:
 	{
 		VBVMR_LPT_AUDIOINFO audioInfo = (VBVMR_LPT_AUDIOINFO)lpData;
-		sampleRate = (float)audioInfo->samplerate;
-		maxFrameCount = audioInfo->nbSamplePerFrame;
-		for (FilterEngine* engine : engines)
-			if (engine != NULL)
-				engine->initialize(sampleRate, 8, 8, 8, 0, maxFrameCount);
 		VoicemeeterAPOInfo::saveVoicemeeterSampleRate((unsigned)audioInfo->samplerate);
 	}
 	break;
@@ -168,46 +169,6 @@ void VoicemeeterClient::handle(long nCommand, void* lpData, long nnn)
 	case VBVMR_CBCOMMAND_CHANGE:
 		PostThreadMessage(mainThreadId, WM_COMMAND, IDM_RESTART, 0);
 		break;
-	case VBVMR_CBCOMMAND_BUFFER_OUT:
-	{
-		VBVMR_LPT_AUDIOBUFFER audioBuffer = (VBVMR_LPT_AUDIOBUFFER)lpData;
-		int nbi = audioBuffer->audiobuffer_nbi;
-		int nbo = audioBuffer->audiobuffer_nbo;
-		unsigned n = min(nbi, nbo) / 8;
-
-		for (unsigned i = 0; i < n; i++)
-		{
-			FilterEngine* engine = NULL;
-			if (i < engines.size())
-				engine = engines[i];
-
-			bool idle = true;
-			bool inputSilent = true;
-			if (engine != NULL)
-			{
-				inputSilent = isBufferSilent(audioBuffer->audiobuffer_r + 8 * i, audioBuffer->audiobuffer_nbs);
-				idle = inputSilent && idleSampleCounts[i] > 10 * engine->getSampleRate();
-			}
-
-			// avoid processing when idle (Voicemeeter does still call this when no audio is played)
-			if (!idle)
-			{
-				engine->process(audioBuffer->audiobuffer_w + 8 * i, audioBuffer->audiobuffer_r + 8 * i, audioBuffer->audiobuffer_nbs);
-
-				bool outputSilent = isBufferSilent(audioBuffer->audiobuffer_w + 8 * i, audioBuffer->audiobuffer_nbs);
-				if (inputSilent && outputSilent)
-					idleSampleCounts[i] += audioBuffer->audiobuffer_nbs;
-				else
-					idleSampleCounts[i] = 0;
-			}
-			else
-			{
-				for (int j = 0; j < 8; j++)
-					memcpy(audioBuffer->audiobuffer_w[8 * i + j], audioBuffer->audiobuffer_r[8 * i + j], audioBuffer->audiobuffer_nbs * sizeof(float));
-			}
-		}
-	}
-	break;
 	}
 }
 
@@ -266,14 +227,9 @@ void VoicemeeterClient::detectVoicemeeterType()
 		else
 			outputCount = 1;
 
-		if (outputCount != engines.size())
+		if (outputCount != busCount)
 		{
-			idleSampleCounts.clear();
-			for (FilterEngine* engine : engines)
-				if (engine != NULL)
-					delete engine;
-			engines.clear();
-
+			vector<FilterEngine*> engines;
 			for (unsigned i = 0; i < outputCount; i++)
 			{
 				wstringstream sstream;
@@ -283,17 +239,16 @@ void VoicemeeterClient::detectVoicemeeterType()
 				{
 					FilterEngine* engine = new FilterEngine();
 					engine->setDeviceInfo(false, true, L"Voicemeeter", output, L"", L"Voicemeeter " + output);
-					if (sampleRate != 0.0f && maxFrameCount != 0)
-						engine->initialize(sampleRate, 8, 8, 8, 0, maxFrameCount);
 					engines.push_back(engine);
 				}
 				else
 				{
 					engines.push_back(NULL);
 				}
-
-				idleSampleCounts.push_back(0);
 			}
+
+			busProcessor.setEngines(engines);
+			busCount = outputCount;
 		}
 	}
 }
@@ -318,26 +273,6 @@ void VoicemeeterClient::handleCommand(WPARAM wparam, LPARAM lparam)
 	}
 }
 
-bool VoicemeeterClient::isBufferSilent(float** sampleData, long sampleCount)
-{
-	bool silent = true;
-
-	for (int j = 0; j < 8; j++)
-	{
-		float* buf = sampleData[j];
-		for (int k = 0; k < sampleCount; k++)
-		{
-			if (buf[k] != 0.0f)
-			{
-				silent = false;
-				break;
-			}
-		}
-	}
-
-	return silent;
-}
-
 static long __stdcall callback(void* lpUser, long nCommand, void* lpData, long nnn)
 {
 	VoicemeeterClient* client = (VoicemeeterClient*)lpUser;
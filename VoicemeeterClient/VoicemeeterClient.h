@@ -23,6 +23,7 @@
 #include <vector>
 #include "../FilterEngine.h"
 #include "VoicemeeterRemote.h"
+#include "VoicemeeterBusProcessor.h"
 
 class VoicemeeterClient
 {
@@ -37,18 +38,15 @@ private:
 	void detectVoicemeeterType();
 	void endSoftware();
 	void handleCommand(WPARAM wparam, LPARAM lparam);
-	bool isBufferSilent(float** sampleData, long sampleCount);
 
 	std::vector<std::wstring> outputs;
 	unsigned long mainThreadId;
 	T_VBVMR_INTERFACE vmr;
 	size_t wTimer = 0;
 	bool connected = true;
-	float sampleRate = 0.0f;
-	unsigned maxFrameCount = 0;
+	unsigned busCount = 0;
 
-	std::vector<FilterEngine*> engines;
-	std::vector<int> idleSampleCounts;
+	VoicemeeterBusProcessor busProcessor;
 };
 
 class InitError
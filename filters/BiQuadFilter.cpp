@@ -18,6 +18,7 @@
 */
 
 #include "stdafx.h"
+#include "helpers/SimdHelper.h"
 #include "BiQuadFilter.h"
 #ifndef _M_ARM64
 #include <immintrin.h>
@@ -116,226 +117,51 @@ std::vector<std::wstring> BiQuadFilter::initialize(float sampleRate, unsigned ma
     return channelNames;
 }
 
-#pragma AVRT_CODE_BEGIN
-
-void BiQuadFilter::process(double** output, double** input, unsigned frameCount)
+bool BiQuadFilter::isIdentity()
 {
-#if !defined(_M_ARM64)
-    unsigned old_mxcsr = _mm_getcsr();
-    _mm_setcsr(old_mxcsr | 0x8040);
-#endif
-
-    unsigned processedChannels = 0;
-
-#if defined(__AVX512F__) && !defined(_M_ARM64)
-    const unsigned avx512_width = 8;
-    unsigned num_avx512_chunks = ((unsigned)channelCount - processedChannels) / avx512_width;
-    if (num_avx512_chunks > 0) {
-        process_avx512(output, input, frameCount, processedChannels, num_avx512_chunks * avx512_width);
-        processedChannels += num_avx512_chunks * avx512_width;
-    }
-#endif
-
-#if defined(__AVX2__) && !defined(_M_ARM64)
-    const unsigned avx256_width = 4;
-    unsigned num_avx256_chunks = ((unsigned)channelCount - processedChannels) / avx256_width;
-    if (num_avx256_chunks > 0) {
-        process_avx256(output, input, frameCount, processedChannels, num_avx256_chunks * avx256_width);
-        processedChannels += num_avx256_chunks * avx256_width;
-    }
-#endif
-#if !defined(_M_ARM64)
-
-    const unsigned sse128_width = 2;
-    unsigned num_sse128_chunks = ((unsigned)channelCount - processedChannels) / sse128_width;
-    if (num_sse128_chunks > 0) {
-        process_sse128(output, input, frameCount, processedChannels, num_sse128_chunks * sse128_width);
-        processedChannels += num_sse128_chunks * sse128_width;
-    }
-#endif
-
-    if (processedChannels < (unsigned)channelCount) {
-        process_scalar(output, input, frameCount, processedChannels);
+    // numerator equal to denominator, e.g. peaking and shelf filters with 0 dB gain
+    for (size_t i = 0; i < channelCount; ++i)
+    {
+        if (a0[i] != 1.0 || b1[i] != a1[i] || b2[i] != a2[i])
+            return false;
     }
 
-#if !defined(_M_ARM64)
-    _mm_setcsr(old_mxcsr);
-#endif
+    return true;
 }
 
-
-#if defined(__AVX512F__) && !defined(_M_ARM64)
-// AVX-512 optimized processing for 8 channels at a time
-void BiQuadFilter::process_avx512(double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned numChannels)
+bool BiQuadFilter::applyGain(const std::vector<size_t>& channels, double gain)
 {
-    const unsigned simd_width = 8;
-    for (unsigned i = startChannel; i < startChannel + numChannels; i += simd_width)
+    // scaling the feed-forward coefficients scales the output, the feedback path only sees the scaled output
+    for (size_t c : channels)
     {
-        const __m512d _a0 = _mm512_loadu_pd(&a0[i]);
-        const __m512d _b1 = _mm512_loadu_pd(&b1[i]);
-        const __m512d _b2 = _mm512_loadu_pd(&b2[i]);
-        const __m512d _a1 = _mm512_loadu_pd(&a1[i]);
-        const __m512d _a2 = _mm512_loadu_pd(&a2[i]);
-
-        __m512d _x1 = _mm512_loadu_pd(&x1[i]);
-        __m512d _x2 = _mm512_loadu_pd(&x2[i]);
-        __m512d _y1 = _mm512_loadu_pd(&y1[i]);
-        __m512d _y2 = _mm512_loadu_pd(&y2[i]);
-
-        for (unsigned j = 0; j < frameCount; ++j)
-        {
-            __m512d _sample = _mm512_set_pd(input[i + 7][j], input[i + 6][j], input[i + 5][j], input[i + 4][j],
-                input[i + 3][j], input[i + 2][j], input[i + 1][j], input[i + 0][j]);
-
-            __m512d result = _mm512_mul_pd(_a0, _sample);
-            result = _mm512_fmadd_pd(_b1, _x1, result);
-            result = _mm512_fmadd_pd(_b2, _x2, result);
-            result = _mm512_fnmadd_pd(_a1, _y1, result);
-            result = _mm512_fnmadd_pd(_a2, _y2, result);
-
-            _x2 = _x1; _x1 = _sample;
-            _y2 = _y1; _y1 = result;
-
-            double result_array[8]; // Use a temporary array for the scatter operation
-            _mm512_storeu_pd(result_array, result);
-            for (int k = 0; k < 8; ++k) output[i + k][j] = result_array[k];
-        }
-
-        _mm512_storeu_pd(&x1[i], _x1);
-        _mm512_storeu_pd(&x2[i], _x2);
-        _mm512_storeu_pd(&y1[i], _y1);
-        _mm512_storeu_pd(&y2[i], _y2);
+        a0[c] *= gain;
+        b1[c] *= gain;
+        b2[c] *= gain;
     }
-}
-#endif
 
-#if defined(__AVX2__) && !defined(_M_ARM64)
-// AVX2 optimized processing for 4 channels at a time
-void BiQuadFilter::process_avx256(double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned numChannels)
-{
-    const unsigned simd_width = 4;
-    for (unsigned i = startChannel; i < startChannel + numChannels; i += simd_width)
-    {
-        const __m256d _a0 = _mm256_loadu_pd(&a0[i]);
-        const __m256d _b1 = _mm256_loadu_pd(&b1[i]);
-        const __m256d _b2 = _mm256_loadu_pd(&b2[i]);
-        const __m256d _a1 = _mm256_loadu_pd(&a1[i]);
-        const __m256d _a2 = _mm256_loadu_pd(&a2[i]);
-
-        __m256d _x1 = _mm256_loadu_pd(&x1[i]);
-        __m256d _x2 = _mm256_loadu_pd(&x2[i]);
-        __m256d _y1 = _mm256_loadu_pd(&y1[i]);
-        __m256d _y2 = _mm256_loadu_pd(&y2[i]);
-
-        for (unsigned j = 0; j < frameCount; ++j)
-        {
-            __m256d _sample = _mm256_set_pd(input[i + 3][j], input[i + 2][j], input[i + 1][j], input[i + 0][j]);
-
-            __m256d result = _mm256_mul_pd(_a0, _sample);
-            result = _mm256_fmadd_pd(_b1, _x1, result);
-            result = _mm256_fmadd_pd(_b2, _x2, result);
-            result = _mm256_fnmadd_pd(_a1, _y1, result);
-            result = _mm256_fnmadd_pd(_a2, _y2, result);
-
-            _x2 = _x1; _x1 = _sample;
-            _y2 = _y1; _y1 = result;
-
-            double result_array[4];
-            _mm256_storeu_pd(result_array, result);
-            output[i + 0][j] = result_array[0];
-            output[i + 1][j] = result_array[1];
-            output[i + 2][j] = result_array[2];
-            output[i + 3][j] = result_array[3];
-        }
-
-        _mm256_storeu_pd(&x1[i], _x1);
-        _mm256_storeu_pd(&x2[i], _x2);
-        _mm256_storeu_pd(&y1[i], _y1);
-        _mm256_storeu_pd(&y2[i], _y2);
-    }
+    return true;
 }
-#endif
 
-#if !defined(_M_ARM64)
-// SSE optimized processing for 2 channels (stereo) at a time
-void BiQuadFilter::process_sse128(double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned numChannels)
-{
-    const unsigned simd_width = 2;
-    for (unsigned i = startChannel; i < startChannel + numChannels; i += simd_width)
-    {
-        const __m128d _a0 = _mm_loadu_pd(&a0[i]);
-        const __m128d _b1 = _mm_loadu_pd(&b1[i]);
-        const __m128d _b2 = _mm_loadu_pd(&b2[i]);
-        const __m128d _a1 = _mm_loadu_pd(&a1[i]);
-        const __m128d _a2 = _mm_loadu_pd(&a2[i]);
+#pragma AVRT_CODE_BEGIN
 
-        __m128d _x1 = _mm_loadu_pd(&x1[i]);
-        __m128d _x2 = _mm_loadu_pd(&x2[i]);
-        __m128d _y1 = _mm_loadu_pd(&y1[i]);
-        __m128d _y2 = _mm_loadu_pd(&y2[i]);
+void BiQuadFilter::process(double** output, double** input, unsigned frameCount)
+{
+#if !defined(_M_ARM64)
+    unsigned old_mxcsr = _mm_getcsr();
+    _mm_setcsr(old_mxcsr | 0x8040);
+#endif
 
-        for (unsigned j = 0; j < frameCount; ++j)
-        {
-            __m128d _sample = _mm_set_pd(input[i + 1][j], input[i + 0][j]);
+    BiQuadBank bank = {a0.data(), a1.data(), a2.data(), b1.data(), b2.data(), x1.data(), x2.data(), y1.data(), y2.data()};
+    SimdHelper::getKernels().biQuad(bank, output, input, frameCount, 0, (unsigned)channelCount);
 
-            // Use FMA if available (AVX+), otherwise it will fallback to mul/add sequence with SSE2
-#if defined(__AVX2__)
-            __m128d result = _mm_mul_pd(_a0, _sample);
-            result = _mm_fmadd_pd(_b1, _x1, result);
-            result = _mm_fmadd_pd(_b2, _x2, result);
-            result = _mm_fnmadd_pd(_a1, _y1, result);
-            result = _mm_fnmadd_pd(_a2, _y2, result);
-#else // Fallback for pure SSE2 CPUs (no FMA)
-            __m128d term1 = _mm_mul_pd(_a0, _sample);
-            __m128d term2 = _mm_mul_pd(_b1, _x1);
-            __m128d term3 = _mm_mul_pd(_b2, _x2);
-            __m128d term4 = _mm_mul_pd(_a1, _y1);
-            __m128d term5 = _mm_mul_pd(_a2, _y2);
-            __m128d result = _mm_add_pd(term1, term2);
-            result = _mm_add_pd(result, term3);
-            result = _mm_sub_pd(result, term4);
-            result = _mm_sub_pd(result, term5);
+#if !defined(_M_ARM64)
+    _mm_setcsr(old_mxcsr);
 #endif
-            _x2 = _x1; _x1 = _sample;
-            _y2 = _y1; _y1 = result;
-
-            double result_array[2];
-            _mm_storeu_pd(result_array, result);
-            output[i + 0][j] = result_array[0];
-            output[i + 1][j] = result_array[1];
-        }
-        _mm_storeu_pd(&x1[i], _x1);
-        _mm_storeu_pd(&x2[i], _x2);
-        _mm_storeu_pd(&y1[i], _y1);
-        _mm_storeu_pd(&y2[i], _y2);
-    }
 }
-#endif
+#pragma AVRT_CODE_END
 
-
-// Scalar processing for any final leftover channels (e.g., the 7th channel in a 7.1 setup)
-void BiQuadFilter::process_scalar(double** output, double** input, unsigned frameCount, unsigned startChannel)
+void BiQuadFilter::reset()
 {
-    for (unsigned i = startChannel; i < channelCount; ++i)
-    {
-        double cur_x1 = x1[i], cur_x2 = x2[i];
-        double cur_y1 = y1[i], cur_y2 = y2[i];
-        const double c_a0 = a0[i], c_b1 = b1[i], c_b2 = b2[i];
-        const double c_a1 = a1[i], c_a2 = a2[i];
-        double* inputChannel = input[i];
-        double* outputChannel = output[i];
-        for (unsigned j = 0; j < frameCount; ++j)
-        {
-            double sample = inputChannel[j];
-            double result = c_a0 * sample + c_b1 * cur_x1 + c_b2 * cur_x2 - c_a1 * cur_y1 - c_a2 * cur_y2;
-            cur_x2 = cur_x1;
-            cur_x1 = sample;
-            cur_y2 = cur_y1;
-            cur_y1 = result;
-            outputChannel[j] = result;
-        }
-        x1[i] = cur_x1; x2[i] = cur_x2;
-        y1[i] = cur_y1; y2[i] = cur_y2;
-    }
-}
-#pragma AVRT_CODE_END
\ No newline at end of file
+    x1.assign(channelCount, 0.0); x2.assign(channelCount, 0.0);
+    y1.assign(channelCount, 0.0); y2.assign(channelCount, 0.0);
+}
\ No newline at end of file
@@ -37,6 +37,9 @@ public:
     bool getInPlace() override { return true; }
     std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) override;
     void process(double** output, double** input, unsigned frameCount) override;
+    void reset() override;
+    bool isIdentity() override;
+    bool applyGain(const std::vector<size_t>& channels, double gain) override;
 
     BiQuad::Type getType() const;
     double getDbGain() const;
@@ -58,17 +61,5 @@ private:
     // Coefficient and state vectors (using unaligned SIMD loads/stores)
     std::vector<double> a0, a1, a2, b1, b2; // Coefficients
     std::vector<double> x1, x2, y1, y2;     // State variables
-
-#if defined(__AVX512F__) && !defined(_M_ARM64)
-    void process_avx512(double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned numChannels);
-#endif
-#if (defined(__AVX2__) || defined(__AVX512F__)) && !defined(_M_ARM64) // AVX2 is part of AVX
-    void process_avx256(double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned numChannels);
-#endif
-    // Use AVX for the 128-bit FMA path if available, otherwise plain SSE2
-#if !defined(_M_ARM64)
-    void process_sse128(double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned numChannels);
-#endif
-    void process_scalar(double** output, double** input, unsigned frameCount, unsigned startChannel);
 };
 #pragma AVRT_VTABLES_END
\ No newline at end of file
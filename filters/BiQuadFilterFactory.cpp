@@ -20,7 +20,6 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "stdafx.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
-#include <regex>
 #include <sstream>
 
 #include "helpers/MemoryHelper.h"
@@ -31,12 +30,47 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 using namespace std;
 
-static wregex regexType(L"^\\s*ON\\s+([A-Za-z]+)");
-static wregex regexFreq(L"\\s+Fc\\s*([-+0-9.eE\u00A0]+)\\s*H\\s*z");
-static wregex regexGain(L"\\s+Gain\\s*([-+0-9.eE]+)\\s*dB");
-static wregex regexQ(L"\\s+Q\\s*([-+0-9.eE]+)");
-static wregex regexBW(L"\\s+BW\\s+Oct\\s*([-+0-9.eE]+)");
-static wregex regexSlope(L"^\\s*([-+0-9.eE]+)\\s*dB");
+// Matches s at pos against a pattern in which ' ' stands for optional and '_' for required whitespace.
+// Returns the end of the match or wstring::npos.
+static size_t matchPattern(const wstring& s, size_t pos, const wchar_t* pattern)
+{
+	for (const wchar_t* p = pattern; *p != L'\0'; p++)
+	{
+		if (*p == L' ' || *p == L'_')
+		{
+			size_t end = StringHelper::skipWhitespace(s, pos);
+			if (*p == L'_' && end == pos)
+				return wstring::npos;
+			pos = end;
+		}
+		else if (pos < s.length() && s[pos] == *p)
+		{
+			pos++;
+		}
+		else
+		{
+			return wstring::npos;
+		}
+	}
+
+	return pos;
+}
+
+// Scans a parameter like "Fc 100 Hz" at pos and stores its number in value
+static bool scanParameter(const wstring& s, size_t pos, const wchar_t* keyword, const wchar_t* unit, bool allowNbsp, wstring& value)
+{
+	pos = matchPattern(s, pos, keyword);
+	if (pos == wstring::npos)
+		return false;
+
+	pos = StringHelper::skipWhitespace(s, pos);
+	size_t end = StringHelper::skipNumber(s, pos, allowNbsp);
+	if (end == pos || matchPattern(s, end, unit) == wstring::npos)
+		return false;
+
+	value = s.substr(pos, end - pos);
+	return true;
+}
 
 BiQuadFilterFactory::BiQuadFilterFactory()
 {
@@ -74,18 +108,17 @@ vector<IFilter*> BiQuadFilterFactory::createFilter(const wstring& configPath, ws
 		// Conversion to period as decimal mark, if needed
 		parameters = StringHelper::replaceCharacters(parameters, L",", L".");
 
-		wsmatch match;
 		wstring typeString;
 
-		bool found = regex_search(parameters, match, regexType);
-		if (found)
+		FilterStrings strings;
+		if (scanFilterStrings(parameters, strings))
 		{
-			typeString = match.str(1);
+			typeString = strings.type;
 			if (filterNameToTypeMap.find(typeString) != filterNameToTypeMap.end())
 			{
 				BiQuad::Type type = filterNameToTypeMap[typeString];
 				wstring typeDescription = filterTypeToDescriptionMap[type];
-				parameters = match.suffix().str();
+				parameters = strings.rest;
 
 				wstringstream stream;
 				stream << L"Adding " << typeDescription << L" filter";
@@ -97,11 +130,9 @@ vector<IFilter*> BiQuadFilterFactory::createFilter(const wstring& configPath, ws
 				bool isCornerFreq = false;
 				bool error = false;
 
-				found = regex_search(parameters, match, regexFreq);
-				if (found)
+				if (!strings.freq.empty())
 				{
-					wstring freqString = match.str(1);
-					freq = getFreq(freqString);
+					freq = getFreq(strings.freq);
 					stream << " with frequency " << freq << " Hz";
 				}
 				else
@@ -110,15 +141,13 @@ vector<IFilter*> BiQuadFilterFactory::createFilter(const wstring& configPath, ws
 					error = true;
 				}
 
-				found = regex_search(parameters, match, regexGain);
-				if (found)
+				if (!strings.gain.empty())
 				{
 					if (type == BiQuad::LOW_PASS || type == BiQuad::HIGH_PASS || type == BiQuad::NOTCH || type == BiQuad::ALL_PASS)
 						TraceF(L"Ignoring gain for filter of type %s", typeDescription.c_str());
 					else
 					{
-						wstring gainString = match.str(1);
-						gain = wcstod(gainString.c_str(), NULL);
+						gain = wcstod(strings.gain.c_str(), NULL);
 						if (type == BiQuad::PEAKING)
 							stream << ", gain " << gain << " dB";
 						else
@@ -131,37 +160,31 @@ vector<IFilter*> BiQuadFilterFactory::createFilter(const wstring& configPath, ws
 					error = true;
 				}
 
-				found = regex_search(parameters, match, regexQ);
-				if (found)
+				if (!strings.q.empty())
 				{
-					wstring qString = match.str(1);
-					bandwidthOrQOrS = wcstod(qString.c_str(), NULL);
+					bandwidthOrQOrS = wcstod(strings.q.c_str(), NULL);
 					stream << " and Q " << bandwidthOrQOrS;
 				}
 
-				found = regex_search(parameters, match, regexBW);
-				if (found)
+				if (!strings.bw.empty())
 				{
 					if (type == BiQuad::LOW_SHELF || type == BiQuad::HIGH_SHELF)
 						TraceF(L"Ignoring bandwidth for filter of type %s", typeDescription.c_str());
 					else
 					{
-						wstring bwString = match.str(1);
-						bandwidthOrQOrS = wcstod(bwString.c_str(), NULL);
+						bandwidthOrQOrS = wcstod(strings.bw.c_str(), NULL);
 						isBandwidthOrS = true;
 						stream << " and bandwidth " << bandwidthOrQOrS << " octaves";
 					}
 				}
 
-				found = regex_search(parameters, match, regexSlope);
-				if (found)
+				if (!strings.slope.empty())
 				{
 					if (!(type == BiQuad::LOW_SHELF || type == BiQuad::HIGH_SHELF))
 						TraceF(L"Ignoring slope for filter of type %s", typeDescription.c_str());
 					else
 					{
-						wstring slopeString = match.str(1);
-						bandwidthOrQOrS = wcstod(slopeString.c_str(), NULL);
+						bandwidthOrQOrS = wcstod(strings.slope.c_str(), NULL);
 						isBandwidthOrS = true;
 						stream << " and slope " << bandwidthOrQOrS << " dB";
 					}
@@ -217,6 +240,51 @@ vector<IFilter*> BiQuadFilterFactory::createFilter(const wstring& configPath, ws
 	return vector<IFilter*>(1, filter);
 }
 
+bool BiQuadFilterFactory::scanFilterStrings(const wstring& parameters, FilterStrings& strings)
+{
+	size_t typeStart = matchPattern(parameters, 0, L" ON_");
+	size_t typeEnd = typeStart;
+	while (typeEnd < parameters.length() && (parameters[typeEnd] >= L'A' && parameters[typeEnd] <= L'Z' || parameters[typeEnd] >= L'a' && parameters[typeEnd] <= L'z'))
+		typeEnd++;
+
+	if (typeStart == wstring::npos || typeEnd == typeStart)
+		return false;
+
+	strings.type = parameters.substr(typeStart, typeEnd - typeStart);
+	strings.rest = parameters.substr(typeEnd);
+	const wstring& rest = strings.rest;
+
+	// single pass over the rest, each keyword has to follow whitespace and the first valid occurrence is used
+	for (size_t i = 1; i < rest.length(); i++)
+	{
+		if (!iswspace(rest[i - 1]) || iswspace(rest[i]))
+			continue;
+
+		switch (rest[i])
+		{
+		case L'F':
+			if (strings.freq.empty())
+				scanParameter(rest, i, L"Fc", L" H z", true, strings.freq);
+			break;
+		case L'G':
+			if (strings.gain.empty())
+				scanParameter(rest, i, L"Gain", L" dB", false, strings.gain);
+			break;
+		case L'Q':
+			if (strings.q.empty())
+				scanParameter(rest, i, L"Q", L"", false, strings.q);
+			break;
+		case L'B':
+			if (strings.bw.empty())
+				scanParameter(rest, i, L"BW_Oct", L"", false, strings.bw);
+			break;
+		}
+	}
+	scanParameter(rest, 0, L"", L" dB", false, strings.slope);
+
+	return true;
+}
+
 double BiQuadFilterFactory::getFreq(const wstring& freqString)
 {
 	double result;
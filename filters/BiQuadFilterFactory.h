@@ -30,8 +30,25 @@ class BiQuadFilterFactory : public IFilterFactory
 {
 public:
 	BiQuadFilterFactory();
+	std::vector<std::wstring> getCommands() override {return {L"Filter*"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
 
+	// strings found in the parameters of a Filter line, empty if not found
+	struct FilterStrings
+	{
+		std::wstring type;
+		// the parameters after the type
+		std::wstring rest;
+		std::wstring freq;
+		std::wstring gain;
+		std::wstring q;
+		std::wstring bw;
+		std::wstring slope;
+	};
+
+	// scans parameters with a period as decimal mark, returns false if there is no filter type
+	static bool scanFilterStrings(const std::wstring& parameters, FilterStrings& strings);
+
 private:
 	double getFreq(const std::wstring& freqString);
 
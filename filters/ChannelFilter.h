@@ -34,6 +34,8 @@ public:
 	bool getSelectChannels() override {return true;}
 	std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) override;
 	void process(double** output, double** input, unsigned frameCount) override;
+	// the selection is resolved when building the configuration, so process has nothing to do
+	bool isIdentity() override {return true;}
 
 private:
 	std::vector<std::wstring> words;
@@ -27,5 +27,6 @@
 class ChannelFilterFactory : public IFilterFactory
 {
 public:
+	std::vector<std::wstring> getCommands() override {return {L"Channel"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
 };
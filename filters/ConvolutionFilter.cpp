@@ -19,6 +19,7 @@
 
 #include "stdafx.h"
 #include <cmath>
+#include <mutex>
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #define ENABLE_SNDFILE_WINDOWS_PROTOTYPES 1
@@ -27,19 +28,40 @@
 
 #include "helpers/LogHelper.h"
 #include "helpers/MemoryHelper.h"
+#include "helpers/DelayLineHelper.h"
 #include "ConvolutionFilter.h"
 
 using namespace std;
 
-ConvolutionFilter::ConvolutionFilter(wstring filename)
+// leading samples below this level relative to the peak are replaced by a delay line
+static const double PRE_DELAY_THRESHOLD_DB = -90.0;
+// the tail is cut where the remaining energy falls below this level relative to the total energy
+static const double TAIL_ENERGY_THRESHOLD_DB = -90.0;
+// impulse responses longer than this use single precision spectra with PRECISION_AUTO
+static const double FLOAT_PRECISION_MIN_SECONDS = 1.0;
+
+ConvolutionFilter::ConvolutionFilter(wstring filename, Mode mode, Precision precision)
 {
 	this->filename = filename;
+	this->mode = mode;
+	this->precision = precision;
 	filters = NULL;
+	floatFilters = NULL;
+	zeroLatencyFilters = NULL;
+	threadedConvolver = NULL;
+	preDelays = NULL;
+	delayBuffers = NULL;
+	delayOffsets = NULL;
+	delayedInput = NULL;
+	gains = NULL;
 }
 
 ConvolutionFilter::~ConvolutionFilter()
 {
 	cleanup();
+
+	if (gains != NULL)
+		MemoryHelper::free(gains);
 }
 
 vector<wstring> ConvolutionFilter::initialize(float sampleRate, unsigned maxFrameCount, vector<wstring> channelNames)
@@ -51,6 +73,12 @@ vector<wstring> ConvolutionFilter::initialize(float sampleRate, unsigned maxFram
 	channelCount = (unsigned)channelNames.size();
 	beforeFirstProcess = true;
 
+	if (gains != NULL)
+		MemoryHelper::free(gains);
+	gains = (double*)MemoryHelper::alloc(sizeof(double) * channelCount);
+	for (unsigned i = 0; i < channelCount; i++)
+		gains[i] = 1.0;
+
 	initializeFilters(maxFrameCount);
 
 	return channelNames;
@@ -59,7 +87,25 @@ vector<wstring> ConvolutionFilter::initialize(float sampleRate, unsigned maxFram
 #pragma AVRT_CODE_BEGIN
 void ConvolutionFilter::process(double** output, double** input, unsigned frameCount)
 {
-	if (filters == NULL)
+	if (zeroLatencyFilters != NULL)
+	{
+		// works with any frame count, so no reinitialization is needed
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			double* inputChannel = input[i];
+			if (preDelays[i] > 0)
+			{
+				delayInput(delayedInput, inputChannel, i, frameCount);
+				inputChannel = delayedInput;
+			}
+
+			hcProcessZeroLatency(&zeroLatencyFilters[i], inputChannel, output[i], frameCount);
+		}
+
+		return;
+	}
+
+	if (filters == NULL && floatFilters == NULL && threadedConvolver == NULL)
 		return;
 
 	if (beforeFirstProcess && frameCount != maxFrameCount)
@@ -67,24 +113,154 @@ void ConvolutionFilter::process(double** output, double** input, unsigned frameC
 		// should hopefully not happen, but happens with merged Bluetooth devices on Windows 11
 		cleanup();
 		initializeFilters(frameCount);
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			if (gains[i] != 1.0)
+				scaleFilter(i, gains[i]);
+		}
 	}
 
 	// only allow reinitialization before first process call
 	beforeFirstProcess = false;
 
+	if (threadedConvolver != NULL)
+	{
+		threadedConvolver->beginBlock();
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			double* inputChannel = input[i];
+			if (preDelays[i] > 0)
+			{
+				delayInput(delayedInput, inputChannel, i, frameCount);
+				inputChannel = delayedInput;
+			}
+
+			threadedConvolver->process(i, output[i], inputChannel);
+		}
+		threadedConvolver->endBlock();
+
+		return;
+	}
+
+	if (floatFilters != NULL)
+	{
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			double* inputChannel = input[i];
+			if (preDelays[i] > 0)
+			{
+				delayInput(delayedInput, inputChannel, i, frameCount);
+				inputChannel = delayedInput;
+			}
+
+			HConvSingleF* filter = &floatFilters[i];
+			hcPutSingleF(filter, inputChannel);
+			hcProcessSingleF(filter);
+			hcGetSingleF(filter, output[i]);
+		}
+
+		return;
+	}
+
 	for (unsigned i = 0; i < channelCount; i++)
 	{
 		double* inputChannel = input[i];
 		double* outputChannel = output[i];
 		HConvSingle* filter = &filters[i];
 
+		if (preDelays != NULL && preDelays[i] > 0)
+		{
+			delayInput(delayedInput, inputChannel, i, frameCount);
+			inputChannel = delayedInput;
+		}
+
 		hcPutSingle(filter, inputChannel);
 		hcProcessSingle(filter);
 		hcGetSingle(filter, outputChannel);
 	}
 }
+
+void ConvolutionFilter::delayInput(double* output, const double* input, unsigned channel, unsigned frameCount)
+{
+	DelayLineHelper::process(output, input, delayBuffers[channel], preDelays[channel], delayOffsets[channel], frameCount);
+	delayOffsets[channel] = DelayLineHelper::nextOffset(preDelays[channel], delayOffsets[channel], frameCount);
+}
 #pragma AVRT_CODE_END
 
+void ConvolutionFilter::reset()
+{
+	if (threadedConvolver != NULL)
+	{
+		// blocks of the tail are in flight on the worker thread, so the convolver is set up again
+		cleanup();
+		initializeFilters(maxFrameCount);
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			if (gains[i] != 1.0)
+				scaleFilter(i, gains[i]);
+		}
+		beforeFirstProcess = true;
+		return;
+	}
+
+	for (unsigned i = 0; i < channelCount; i++)
+	{
+		if (filters != NULL)
+			hcResetSingle(&filters[i]);
+		else if (floatFilters != NULL)
+			hcResetSingleF(&floatFilters[i]);
+		else if (zeroLatencyFilters != NULL)
+			hcResetZeroLatency(&zeroLatencyFilters[i]);
+	}
+
+	if (delayBuffers != NULL)
+	{
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			if (delayBuffers[i] != NULL)
+				memset(delayBuffers[i], 0, sizeof(double) * preDelays[i]);
+			delayOffsets[i] = 0;
+		}
+	}
+}
+
+ConvolutionFilter::Mode ConvolutionFilter::getMode() const
+{
+	return mode;
+}
+
+ConvolutionFilter::Precision ConvolutionFilter::getPrecision() const
+{
+	return precision;
+}
+
+bool ConvolutionFilter::applyGain(const vector<size_t>& channels, double gain)
+{
+	// without an impulse response, the input is passed through unchanged
+	if (filters == NULL && floatFilters == NULL && zeroLatencyFilters == NULL && threadedConvolver == NULL)
+		return false;
+
+	for (size_t c : channels)
+	{
+		gains[c] *= gain;
+		scaleFilter((unsigned)c, gain);
+	}
+
+	return true;
+}
+
+void ConvolutionFilter::scaleFilter(unsigned channel, double gain)
+{
+	if (filters != NULL)
+		hcScaleSingle(&filters[channel], gain);
+	else if (floatFilters != NULL)
+		hcScaleSingleF(&floatFilters[channel], gain);
+	else if (zeroLatencyFilters != NULL)
+		hcScaleZeroLatency(&zeroLatencyFilters[channel], gain);
+	else if (threadedConvolver != NULL)
+		threadedConvolver->scale(channel, gain);
+}
+
 void ConvolutionFilter::cleanup()
 {
 	if (filters != NULL)
@@ -95,61 +271,332 @@ void ConvolutionFilter::cleanup()
 		MemoryHelper::free(filters);
 		filters = NULL;
 	}
+
+	if (floatFilters != NULL)
+	{
+		for (unsigned i = 0; i < channelCount; i++)
+			hcCloseSingleF(&floatFilters[i]);
+
+		MemoryHelper::free(floatFilters);
+		floatFilters = NULL;
+	}
+
+	if (zeroLatencyFilters != NULL)
+	{
+		for (unsigned i = 0; i < channelCount; i++)
+			hcCloseZeroLatency(&zeroLatencyFilters[i]);
+
+		MemoryHelper::free(zeroLatencyFilters);
+		zeroLatencyFilters = NULL;
+	}
+
+	if (threadedConvolver != NULL)
+	{
+		threadedConvolver->~ThreadedConvolver();
+		MemoryHelper::free(threadedConvolver);
+		threadedConvolver = NULL;
+	}
+
+	if (delayBuffers != NULL)
+	{
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			if (delayBuffers[i] != NULL)
+				MemoryHelper::free(delayBuffers[i]);
+		}
+
+		MemoryHelper::free(delayBuffers);
+		delayBuffers = NULL;
+	}
+
+	if (preDelays != NULL)
+	{
+		MemoryHelper::free(preDelays);
+		preDelays = NULL;
+	}
+
+	if (delayOffsets != NULL)
+	{
+		MemoryHelper::free(delayOffsets);
+		delayOffsets = NULL;
+	}
+
+	if (delayedInput != NULL)
+	{
+		MemoryHelper::free(delayedInput);
+		delayedInput = NULL;
+	}
 }
 
-void ConvolutionFilter::initializeFilters(unsigned frameCount)
+void ConvolutionFilter::analyzeImpulseResponse(const double* buf, unsigned length, unsigned& preDelay, unsigned& usedLength)
 {
-	SF_INFO info;
+	double peak = 0.0;
+	double totalEnergy = 0.0;
+	for (unsigned i = 0; i < length; i++)
+	{
+		peak = max(peak, abs(buf[i]));
+		totalEnergy += buf[i] * buf[i];
+	}
+
+	if (peak == 0.0)
+	{
+		preDelay = 0;
+		usedLength = min(length, 1u);
+		return;
+	}
+
+	double threshold = peak * pow(10.0, PRE_DELAY_THRESHOLD_DB / 20.0);
+	unsigned start = 0;
+	while (abs(buf[start]) < threshold)
+		start++;
 
+	// backward integration of the energy decay (Schroeder integral)
+	double energyThreshold = totalEnergy * pow(10.0, TAIL_ENERGY_THRESHOLD_DB / 10.0);
+	double remainingEnergy = 0.0;
+	unsigned end = length;
+	while (end > start + 1)
+	{
+		remainingEnergy += buf[end - 1] * buf[end - 1];
+		if (remainingEnergy > energyThreshold)
+			break;
+		end--;
+	}
+
+	preDelay = start;
+	usedLength = end - start;
+}
+
+// Impulse response as read from the file and analyzed. As that does not depend on the device, it is shared
+// by the filters of all engines in the process until the file changes.
+struct ConvolutionFilter::ImpulseResponse
+{
+	unsigned long long size;
+	unsigned long long lastWriteTime;
+	int sampleRate;
+	vector<vector<double>> channels;
+	vector<unsigned> preDelays;
+	vector<unsigned> usedLengths;
+};
+
+// Cache entry of one file. Its mutex is only held while that file is read, so that engines loading the same file
+// wait for the first one, while other files are read in parallel.
+struct ConvolutionFilter::ImpulseResponseCacheEntry
+{
+	mutex loadMutex;
+	weak_ptr<const ImpulseResponse> impulseResponse;
+};
+
+shared_ptr<const ConvolutionFilter::ImpulseResponse> ConvolutionFilter::loadImpulseResponse(const wstring& filename)
+{
+	static mutex cacheMutex;
+	static unordered_map<wstring, shared_ptr<ImpulseResponseCacheEntry>> cache;
+
+	unsigned long long size = 0;
+	unsigned long long lastWriteTime = 0;
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (GetFileAttributesExW(filename.c_str(), GetFileExInfoStandard, &data))
+	{
+		size = (unsigned long long)data.nFileSizeHigh << 32 | data.nFileSizeLow;
+		lastWriteTime = (unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32 | data.ftLastWriteTime.dwLowDateTime;
+	}
+
+	shared_ptr<ImpulseResponseCacheEntry> entry;
+	{
+		lock_guard<mutex> lock(cacheMutex);
+
+		// forget the impulse responses that no filter uses anymore, unless they are being loaded
+		for (auto it = cache.begin(); it != cache.end();)
+		{
+			if (it->second.use_count() == 1 && it->second->impulseResponse.expired())
+				it = cache.erase(it);
+			else
+				it++;
+		}
+
+		shared_ptr<ImpulseResponseCacheEntry>& slot = cache[filename];
+		if (slot == nullptr)
+			slot = make_shared<ImpulseResponseCacheEntry>();
+		entry = slot;
+	}
+
+	// engines loading the same configuration wait here for the first one to read the file
+	lock_guard<mutex> lock(entry->loadMutex);
+
+	shared_ptr<const ImpulseResponse> cached = entry->impulseResponse.lock();
+	if (cached != nullptr && cached->size == size && cached->lastWriteTime == lastWriteTime)
+	{
+		TraceFStatic(L"Using cached impulse response file %s", filename.c_str());
+		return cached;
+	}
+
+	SF_INFO info;
 	SNDFILE* inFile = sf_wchar_open(filename.c_str(), SFM_READ, &info);
 	if (inFile == NULL)
 	{
-		LogF(L"Error while reading impulse response file: %S", sf_strerror(inFile));
+		LogFStatic(L"Error while reading impulse response file: %S", sf_strerror(inFile));
+		return nullptr;
 	}
-	else if (abs(sampleRate - info.samplerate) > 1.0)
+
+	unsigned fileChannelCount = info.channels;
+	unsigned fileFrameCount = (unsigned)info.frames;
+
+	double* interleavedBuf = new double[fileFrameCount * fileChannelCount];
+
+	sf_count_t numRead = 0;
+	while (numRead < fileFrameCount)
+		numRead += sf_readf_double(inFile, interleavedBuf + numRead * fileChannelCount, fileFrameCount - numRead);
+
+	sf_close(inFile);
+	inFile = NULL;
+
+	shared_ptr<ImpulseResponse> impulseResponse = make_shared<ImpulseResponse>();
+	impulseResponse->size = size;
+	impulseResponse->lastWriteTime = lastWriteTime;
+	impulseResponse->sampleRate = info.samplerate;
+	impulseResponse->channels.resize(fileChannelCount);
+	impulseResponse->preDelays.resize(fileChannelCount);
+	impulseResponse->usedLengths.resize(fileChannelCount);
+	for (unsigned i = 0; i < fileChannelCount; i++)
 	{
-		LogF(L"Impulse response sample rate (%d Hz) does not match device sample rate (%f Hz)", info.samplerate, sampleRate);
+		vector<double>& buf = impulseResponse->channels[i];
+		buf.resize(fileFrameCount);
+		double* p = interleavedBuf + i;
+		for (unsigned j = 0; j < fileFrameCount; j++)
+		{
+			buf[j] = p[j * fileChannelCount];
+		}
+
+		unsigned& preDelay = impulseResponse->preDelays[i];
+		unsigned& usedLength = impulseResponse->usedLengths[i];
+		analyzeImpulseResponse(buf.data(), fileFrameCount, preDelay, usedLength);
+		if (preDelay > 0 || usedLength < fileFrameCount)
+		{
+			TraceFStatic(L"Impulse response channel %d: using %d samples pre-delay, trimmed %d of %d samples from tail, %d samples remaining",
+				i, preDelay, fileFrameCount - preDelay - usedLength, fileFrameCount, usedLength);
+		}
+	}
+
+	delete[] interleavedBuf;
+
+	entry->impulseResponse = impulseResponse;
+
+	return impulseResponse;
+}
+
+void ConvolutionFilter::initializeFilters(unsigned frameCount)
+{
+	// The filters keep their own copy of the impulse response, so it is only held while they are initialized.
+	// Reinitialization with another frame count takes it from the cache again or reads the file once more.
+	shared_ptr<const ImpulseResponse> impulseResponse = loadImpulseResponse(filename);
+
+	if (impulseResponse == nullptr)
+	{
+		// the error has already been logged
+	}
+	else if (abs(sampleRate - impulseResponse->sampleRate) > 1.0)
+	{
+		LogF(L"Impulse response sample rate (%d Hz) does not match device sample rate (%f Hz)", impulseResponse->sampleRate, sampleRate);
 	}
 	else
 	{
 		TraceF(L"Convolving using impulse response file %s", filename.c_str());
-		unsigned fileChannelCount = info.channels;
-		unsigned fileFrameCount = (unsigned)info.frames;
+		unsigned fileChannelCount = (unsigned)impulseResponse->channels.size();
+		const vector<unsigned>& filePreDelays = impulseResponse->preDelays;
+		const vector<unsigned>& fileUsedLengths = impulseResponse->usedLengths;
+
+		preDelays = (unsigned*)MemoryHelper::alloc(sizeof(unsigned) * channelCount);
+		delayOffsets = (unsigned*)MemoryHelper::alloc(sizeof(unsigned) * channelCount);
+		delayBuffers = (double**)MemoryHelper::alloc(sizeof(double*) * channelCount);
+		delayedInput = (double*)MemoryHelper::alloc(sizeof(double) * frameCount);
 
-		double* interleavedBuf = new double[fileFrameCount * fileChannelCount];
+		int headLength = hcZeroLatencyHeadLength();
+		// the tail after the first segments uses partitions of about the block size, like the default mode
+		int tailPartitionLength = headLength;
+		while (tailPartitionLength < (int)frameCount)
+			tailPartitionLength *= 2;
+		if (mode == MODE_ZERO_LATENCY)
+			TraceF(L"Using zero latency convolution with %d taps in time domain and tail partitions of %d samples", headLength, tailPartitionLength);
 
-		sf_count_t numRead = 0;
-		while (numRead < fileFrameCount)
-			numRead += sf_readf_double(inFile, interleavedBuf + numRead * fileChannelCount, fileFrameCount - numRead);
+		bool useThreads = false;
+		if (mode == MODE_THREADED)
+		{
+			for (unsigned i = 0; i < fileChannelCount; i++)
+			{
+				if (fileUsedLengths[i] > ThreadedConvolver::HEAD_PARTITIONS * frameCount)
+					useThreads = true;
+			}
 
-		sf_close(inFile);
-		inFile = NULL;
+			if (!useThreads)
+				TraceF(L"Impulse response is too short for threaded convolution, using single thread");
+		}
 
-		double** bufs = new double* [fileChannelCount];
-		for (unsigned i = 0; i < fileChannelCount; i++)
+		bool useFloat = false;
+		if (mode == MODE_DEFAULT)
 		{
-			double* buf = new double[fileFrameCount];
-			double* p = interleavedBuf + i;
-			for (unsigned j = 0; j < fileFrameCount; j++)
+			if (precision == PRECISION_FLOAT)
+			{
+				useFloat = true;
+			}
+			else if (precision == PRECISION_AUTO)
 			{
-				buf[j] = p[j * fileChannelCount];
+				for (unsigned i = 0; i < fileChannelCount; i++)
+				{
+					if (fileUsedLengths[i] > FLOAT_PRECISION_MIN_SECONDS * sampleRate)
+						useFloat = true;
+				}
 			}
 
-			bufs[i] = buf;
+			if (useFloat)
+				TraceF(L"Using single precision convolution");
+		}
+		else if (precision == PRECISION_FLOAT)
+		{
+			TraceF(L"Single precision is not supported in this convolution mode, using double precision");
 		}
 
+		double** channelBufs = new double*[channelCount];
+		unsigned* channelLengths = new unsigned[channelCount];
+
 		fftw_make_planner_thread_safe();
-		filters = (HConvSingle*)MemoryHelper::alloc(sizeof(HConvSingle) * channelCount);
+		if (useFloat)
+			fftwf_make_planner_thread_safe();
+		if (mode == MODE_ZERO_LATENCY)
+			zeroLatencyFilters = (HConvZeroLatency*)MemoryHelper::alloc(sizeof(HConvZeroLatency) * channelCount);
+		else if (useFloat)
+			floatFilters = (HConvSingleF*)MemoryHelper::alloc(sizeof(HConvSingleF) * channelCount);
+		else if (!useThreads)
+			filters = (HConvSingle*)MemoryHelper::alloc(sizeof(HConvSingle) * channelCount);
 		for (unsigned i = 0; i < channelCount; i++)
 		{
-			hcInitSingle(&filters[i], bufs[i % fileChannelCount], fileFrameCount, frameCount, 1);
+			unsigned fileChannel = i % fileChannelCount;
+			preDelays[i] = filePreDelays[fileChannel];
+			delayOffsets[i] = 0;
+			delayBuffers[i] = NULL;
+			if (preDelays[i] > 0)
+			{
+				delayBuffers[i] = (double*)MemoryHelper::alloc(sizeof(double) * preDelays[i]);
+				memset(delayBuffers[i], 0, sizeof(double) * preDelays[i]);
+			}
+
+			// the filters only read the impulse response
+			channelBufs[i] = const_cast<double*>(impulseResponse->channels[fileChannel].data()) + preDelays[i];
+			channelLengths[i] = fileUsedLengths[fileChannel];
+			if (mode == MODE_ZERO_LATENCY)
+				hcInitZeroLatency(&zeroLatencyFilters[i], channelBufs[i], channelLengths[i], headLength, tailPartitionLength);
+			else if (useFloat)
+				hcInitSingleF(&floatFilters[i], channelBufs[i], channelLengths[i], frameCount, 1);
+			else if (!useThreads)
+				hcInitSingle(&filters[i], channelBufs[i], channelLengths[i], frameCount, 1);
 		}
 
-		for (unsigned i = 0; i < fileChannelCount; i++)
+		if (useThreads)
 		{
-			delete[] bufs[i];
+			void* mem = MemoryHelper::alloc(sizeof(ThreadedConvolver));
+			threadedConvolver = new(mem) ThreadedConvolver();
+			threadedConvolver->initialize(channelBufs, channelLengths, channelCount, frameCount);
 		}
-		delete bufs;
-		delete interleavedBuf;
+
+		delete[] channelBufs;
+		delete[] channelLengths;
 	}
 }
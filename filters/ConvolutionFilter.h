@@ -19,18 +19,44 @@
 
 #pragma once
 
+#include <memory>
+
 #include "IFilter.h"
 #include "libHybridConv-0.1.1/libHybridConv_eapo.h"
+#include "helpers/ThreadedConvolver.h"
 
 #pragma AVRT_VTABLES_BEGIN
 class ConvolutionFilter : public IFilter
 {
 public:
-	ConvolutionFilter(std::wstring filename);
+	enum Mode
+	{
+		// uniformly partitioned convolution with the host block size as partition length
+		MODE_DEFAULT,
+		// direct-form head and partitioned tail, independent of the host block size
+		MODE_ZERO_LATENCY,
+		// partitions after the first few are computed ahead of time on a worker thread
+		MODE_THREADED
+	};
+
+	enum Precision
+	{
+		PRECISION_DOUBLE,
+		PRECISION_FLOAT,
+		// single precision for impulse responses longer than one second, otherwise double precision
+		PRECISION_AUTO
+	};
+
+	ConvolutionFilter(std::wstring filename, Mode mode = MODE_DEFAULT, Precision precision = PRECISION_DOUBLE);
 	virtual ~ConvolutionFilter();
 	bool getInPlace() override { return true; }
 	std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) override;
 	void process(double** output, double** input, unsigned frameCount) override;
+	void reset() override;
+	bool applyGain(const std::vector<size_t>& channels, double gain) override;
+
+	Mode getMode() const;
+	Precision getPrecision() const;
 
 protected:
 	virtual void initializeFilters(unsigned frameCount);
@@ -39,10 +65,28 @@ protected:
 	unsigned channelCount;
 
 private:
+	struct ImpulseResponse;
+	struct ImpulseResponseCacheEntry;
+
 	void cleanup();
+	static std::shared_ptr<const ImpulseResponse> loadImpulseResponse(const std::wstring& filename);
+	static void analyzeImpulseResponse(const double* buf, unsigned length, unsigned& preDelay, unsigned& usedLength);
+	void scaleFilter(unsigned channel, double gain);
+	void delayInput(double* output, const double* input, unsigned channel, unsigned frameCount);
 
 	std::wstring filename;
+	Mode mode;
+	Precision precision;
+	HConvSingleF* floatFilters;
+	HConvZeroLatency* zeroLatencyFilters;
+	ThreadedConvolver* threadedConvolver;
 	unsigned maxFrameCount;
 	bool beforeFirstProcess;
+	unsigned* preDelays;
+	double** delayBuffers;
+	unsigned* delayOffsets;
+	double* delayedInput;
+	// gains applied to the filters of each channel, reapplied after reinitialization
+	double* gains;
 };
 #pragma AVRT_VTABLES_END
@@ -23,39 +23,84 @@
 #include "helpers/MemoryHelper.h"
 #include "helpers/StringHelper.h"
 #include "helpers/LogHelper.h"
+#include "FilterEngine.h"
 #include "ConvolutionFilter.h"
 #include "ConvolutionFilterFactory.h"
 
 using namespace std;
 
+static wstring resolvePath(const wstring& configPath, const wstring& value)
+{
+	if (!PathIsRelativeW(value.c_str()))
+		return value;
+
+	wchar_t filePath[MAX_PATH];
+	configPath._Copy_s(filePath, sizeof(filePath) / sizeof(wchar_t), MAX_PATH);
+	if (configPath.size() < MAX_PATH)
+		filePath[configPath.size()] = L'\0';
+	else
+		filePath[MAX_PATH - 1] = L'\0';
+	PathRemoveFileSpecW(filePath);
+	PathAppendW(filePath, value.c_str());
+	return filePath;
+}
+
+void ConvolutionFilterFactory::initialize(FilterEngine* engine)
+{
+	this->engine = engine;
+}
+
 vector<IFilter*> ConvolutionFilterFactory::createFilter(const wstring& configPath, wstring& command, wstring& parameters)
 {
 	ConvolutionFilter* filter = NULL;
 
 	if (command == L"Convolution")
 	{
-		wstring value = parameters;
-		while (value.length() > 0 && iswspace(value[0]))
-			value = value.substr(1);
+		wstring value = StringHelper::trim(parameters);
 
-		wstring absolutePath;
-		if (PathIsRelativeW(value.c_str()))
+		// optional mode and precision keywords, which are only taken as such if the text before them names an
+		// existing file, so that unquoted file names ending in a keyword keep working
+		ConvolutionFilter::Mode mode = ConvolutionFilter::MODE_DEFAULT;
+		ConvolutionFilter::Precision precision = ConvolutionFilter::PRECISION_DOUBLE;
+		wstring absolutePath = resolvePath(configPath, value);
+		ConvolutionFilter::Mode keywordMode = ConvolutionFilter::MODE_DEFAULT;
+		ConvolutionFilter::Precision keywordPrecision = ConvolutionFilter::PRECISION_DOUBLE;
+		wstring remaining = value;
+		while (!PathFileExistsW(absolutePath.c_str()))
 		{
-			wchar_t filePath[MAX_PATH];
-			configPath._Copy_s(filePath, sizeof(filePath) / sizeof(wchar_t), MAX_PATH);
-			if (configPath.size() < MAX_PATH)
-				filePath[configPath.size()] = L'\0';
+			size_t pos = remaining.find_last_of(L" \t");
+			if (pos == wstring::npos)
+				break;
+
+			wstring keyword = remaining.substr(pos + 1);
+			if (keyword == L"ZeroLatency")
+				keywordMode = ConvolutionFilter::MODE_ZERO_LATENCY;
+			else if (keyword == L"Threaded")
+				keywordMode = ConvolutionFilter::MODE_THREADED;
+			else if (keyword == L"Float")
+				keywordPrecision = ConvolutionFilter::PRECISION_FLOAT;
+			else if (keyword == L"Double")
+				keywordPrecision = ConvolutionFilter::PRECISION_DOUBLE;
+			else if (keyword == L"Auto")
+				keywordPrecision = ConvolutionFilter::PRECISION_AUTO;
 			else
-				filePath[MAX_PATH - 1] = L'\0';
-			PathRemoveFileSpecW(filePath);
-			PathAppendW(filePath, value.c_str());
-			absolutePath = filePath;
+				break;
+
+			remaining = StringHelper::trim(remaining.substr(0, pos));
+			wstring remainingPath = resolvePath(configPath, remaining);
+			if (PathFileExistsW(remainingPath.c_str()))
+			{
+				mode = keywordMode;
+				precision = keywordPrecision;
+				absolutePath = remainingPath;
+			}
 		}
-		else
-			absolutePath = value;
+
+		if (engine != NULL)
+			engine->watchFile(absolutePath);
 
 		void* mem = MemoryHelper::alloc(sizeof(ConvolutionFilter));
-		filter = new(mem) ConvolutionFilter(absolutePath);
+		filter = new(mem) ConvolutionFilter(absolutePath, mode, precision);
 	}
 
 	if (filter == NULL)
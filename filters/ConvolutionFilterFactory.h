@@ -27,5 +27,10 @@
 class ConvolutionFilterFactory : public IFilterFactory
 {
 public:
+	void initialize(FilterEngine* engine) override;
+	std::vector<std::wstring> getCommands() override {return {L"Convolution"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
+
+private:
+	FilterEngine* engine = NULL;
 };
@@ -23,6 +23,7 @@
 
 #include "helpers/LogHelper.h"
 #include "helpers/MemoryHelper.h"
+#include "helpers/SimdHelper.h"
 #include "helpers/ChannelHelper.h"
 #include "CopyFilter.h"
 
@@ -32,8 +33,10 @@ CopyFilter::CopyFilter(const vector<Assignment>& assignments)
 {
 	this->assignments = assignments;
 
-	internalAssignments = NULL;
-	assignmentCount = 0;
+	mixGroups = NULL;
+	mixGroupCount = 0;
+	discardBuffer = NULL;
+	identity = false;
 }
 
 CopyFilter::~CopyFilter()
@@ -45,14 +48,16 @@ vector<wstring> CopyFilter::initialize(float sampleRate, unsigned maxFrameCount,
 {
 	cleanup();
 
-	assignmentCount = (unsigned)assignments.size();
-	internalAssignments = (InternalAssignment*)MemoryHelper::alloc(assignmentCount * sizeof(Assignment));
+	this->maxFrameCount = maxFrameCount;
+	matrix.clear();
+	constants.clear();
 
 	vector<wstring> outChannelNames;
 
-	for (unsigned i = 0; i < assignmentCount; i++)
+	wstringstream stream;
+	stream << "Copying ";
+	for (unsigned i = 0; i < assignments.size(); i++)
 	{
-		InternalAssignment& ia = internalAssignments[i];
 		Assignment& a = assignments[i];
 
 		wstring channelName = a.targetChannel;
@@ -60,111 +65,270 @@ vector<wstring> CopyFilter::initialize(float sampleRate, unsigned maxFrameCount,
 		if (channelIndex != -1)
 			channelName = channelNames[channelIndex];
 		vector<wstring>::const_iterator it = find(outChannelNames.begin(), outChannelNames.end(), channelName);
-		ia.targetChannel = (int)(it - outChannelNames.begin());
+		size_t targetChannel = it - outChannelNames.begin();
 		if (it == outChannelNames.end())
+		{
 			outChannelNames.push_back(channelName);
+			matrix.push_back(vector<double>(channelNames.size(), 0.0));
+			constants.push_back(0.0);
+		}
 
-		ia.sourceCount = (unsigned)a.sourceSum.size();
-		ia.sourceSum = (InternalAssignment::InternalSummand*)MemoryHelper::alloc(ia.sourceCount * sizeof(InternalAssignment::InternalSummand));
+		// a later assignment to the same channel replaces the earlier one
+		vector<double>& row = matrix[targetChannel];
+		fill(row.begin(), row.end(), 0.0);
+		constants[targetChannel] = 0.0;
 
-		for (unsigned j = 0; j < ia.sourceCount; j++)
+		if (i > 0)
+			stream << ", ";
+		stream << L"to channel " << channelName.c_str() << " ";
+		for (unsigned j = 0; j < a.sourceSum.size(); j++)
 		{
-			InternalAssignment::InternalSummand& is = ia.sourceSum[j];
 			Assignment::Summand& s = a.sourceSum[j];
 
+			int channel = -1;
 			if (s.channel != L"")
-				is.channel = ChannelHelper::getChannelIndex(s.channel, channelNames);
-			else
-				is.channel = -1;
+				channel = ChannelHelper::getChannelIndex(s.channel, channelNames);
 
+			double factor;
 			if (s.isDecibel)
-				is.factor = (double)pow(10.0, s.factor / 20.0);
+				factor = (double)pow(10.0, s.factor / 20.0);
 			else
-				is.factor = (double)s.factor;
-		}
-	}
+				factor = (double)s.factor;
 
-	wstringstream stream;
-	stream << "Copying ";
-	for (unsigned i = 0; i < assignmentCount; i++)
-	{
-		InternalAssignment& ia = internalAssignments[i];
-		if (i > 0)
-			stream << ", ";
-		stream << L"to channel " << outChannelNames[ia.targetChannel].c_str() << " ";
-		for (unsigned j = 0; j < ia.sourceCount; j++)
-		{
-			InternalAssignment::InternalSummand& is = ia.sourceSum[j];
 			if (j > 0)
 				stream << ", ";
-			if (is.channel != -1)
-				stream << L"from channel " << channelNames[is.channel].c_str() << L" with factor " << is.factor;
+			if (channel != -1)
+			{
+				row[channel] += factor;
+				stream << L"from channel " << channelNames[channel].c_str() << L" with factor " << factor;
+			}
 			else
-				stream << L"value " << is.factor;
+			{
+				constants[targetChannel] += factor;
+				stream << L"value " << factor;
+			}
 		}
 	}
 	TraceF(L"%s", stream.str().c_str());
 
+	// channels are identified by their position in channelNames, new channels by positions after these
+	vector<size_t> inChannels;
+	for (size_t c = 0; c < channelNames.size(); c++)
+		inChannels.push_back(c);
+	vector<size_t> outChannels;
+	for (size_t o = 0; o < outChannelNames.size(); o++)
+	{
+		vector<wstring>::iterator it = find(channelNames.begin(), channelNames.end(), outChannelNames[o]);
+		outChannels.push_back(it != channelNames.end() ? it - channelNames.begin() : channelNames.size() + o);
+	}
+	updateIdentity(inChannels, outChannels);
+
+	compileMatrix();
+
 	return outChannelNames;
 }
 
 #pragma AVRT_CODE_BEGIN
 void CopyFilter::process(double** output, double** input, unsigned frameCount)
 {
-	for (unsigned i = 0; i < assignmentCount; i++)
+	static_assert(MIX_GROUP_SIZE == SimdKernels::MIX_SIZE, "the kernel mixes groups of the same size");
+
+	const SimdKernels& kernels = SimdHelper::getKernels();
+	for (unsigned g = 0; g < mixGroupCount; g++)
 	{
-		InternalAssignment& ia = internalAssignments[i];
+		const MixGroup& group = mixGroups[g];
+		const unsigned inputCount = group.inputCount;
+		const double* factors = group.factors;
 
-		if (ia.targetChannel == -1 || ia.sourceCount == 0)
-			continue;
+		double* out[MIX_GROUP_SIZE];
+		for (unsigned j = 0; j < MIX_GROUP_SIZE; j++)
+			out[j] = group.outputs[j] != NO_OUTPUT ? output[group.outputs[j]] : discardBuffer;
 
-		{
-			InternalAssignment::InternalSummand& is = ia.sourceSum[0];
+		// each input is loaded once per tile and accumulated into all outputs of the group
+		kernels.mix(out, input, group.inputs, inputCount, factors, group.constants, 0, frameCount);
+	}
+}
+#pragma AVRT_CODE_END
+
+void CopyFilter::compileMatrix()
+{
+	cleanup();
+
+	unsigned outputCount = (unsigned)matrix.size();
+	if (outputCount == 0)
+		return;
+
+	mixGroupCount = (outputCount + MIX_GROUP_SIZE - 1) / MIX_GROUP_SIZE;
+	mixGroups = (MixGroup*)MemoryHelper::alloc(mixGroupCount * sizeof(MixGroup));
+	for (unsigned g = 0; g < mixGroupCount; g++)
+	{
+		MixGroup& group = mixGroups[g];
 
-			if (is.channel == -1)
-				for (unsigned f = 0; f < frameCount; f++)
-					output[ia.targetChannel][f] = is.factor;
-			else if (is.factor == 1.0)
-				memcpy(output[ia.targetChannel], input[is.channel], frameCount * sizeof(double));
+		vector<unsigned> inputs;
+		for (unsigned j = 0; j < MIX_GROUP_SIZE; j++)
+		{
+			unsigned o = g * MIX_GROUP_SIZE + j;
+			if (o < outputCount)
+			{
+				group.outputs[j] = o;
+				group.constants[j] = constants[o];
+				for (unsigned k = 0; k < matrix[o].size(); k++)
+				{
+					if (matrix[o][k] != 0.0 && find(inputs.begin(), inputs.end(), k) == inputs.end())
+						inputs.push_back(k);
+				}
+			}
 			else
-				for (unsigned f = 0; f < frameCount; f++)
-					output[ia.targetChannel][f] = is.factor * input[is.channel][f];
+			{
+				group.outputs[j] = NO_OUTPUT;
+				group.constants[j] = 0.0;
+			}
 		}
+		sort(inputs.begin(), inputs.end());
 
-		for (unsigned j = 1; j < ia.sourceCount; j++)
+		group.inputCount = (unsigned)inputs.size();
+		group.inputs = (unsigned*)MemoryHelper::alloc(max(group.inputCount, 1u) * sizeof(unsigned));
+		group.factors = (double*)MemoryHelper::alloc(max(group.inputCount, 1u) * MIX_GROUP_SIZE * sizeof(double));
+		for (unsigned k = 0; k < group.inputCount; k++)
 		{
-			InternalAssignment::InternalSummand& is = ia.sourceSum[j];
-
-			if (is.channel == -1)
-				for (unsigned f = 0; f < frameCount; f++)
-					output[ia.targetChannel][f] += is.factor;
-			else if (is.factor == 1.0)
-				for (unsigned f = 0; f < frameCount; f++)
-					output[ia.targetChannel][f] += input[is.channel][f];
-			else
-				for (unsigned f = 0; f < frameCount; f++)
-					output[ia.targetChannel][f] += is.factor * input[is.channel][f];
+			group.inputs[k] = inputs[k];
+			for (unsigned j = 0; j < MIX_GROUP_SIZE; j++)
+			{
+				unsigned o = g * MIX_GROUP_SIZE + j;
+				group.factors[k * MIX_GROUP_SIZE + j] = o < outputCount ? matrix[o][inputs[k]] : 0.0;
+			}
 		}
 	}
+
+	if (outputCount % MIX_GROUP_SIZE != 0)
+		discardBuffer = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
 }
-#pragma AVRT_CODE_END
 
-void CopyFilter::cleanup()
+bool CopyFilter::mergeNext(IFilter* nextFilter, const vector<size_t>& inChannels, vector<size_t>& outChannels,
+	const vector<size_t>& nextInChannels, const vector<size_t>& nextOutChannels)
 {
-	if (internalAssignments != NULL)
+	CopyFilter* next = dynamic_cast<CopyFilter*>(nextFilter);
+	if (next == NULL)
+		return false;
+
+	if (next->matrix.size() != nextOutChannels.size() || matrix.size() != outChannels.size())
+		return false;
+
+	// the following filter either reads an output of this filter or a channel that this filter passes through
+	vector<int> nextInputRows(nextInChannels.size());
+	vector<int> nextInputColumns(nextInChannels.size());
+	for (size_t k = 0; k < nextInChannels.size(); k++)
+	{
+		vector<size_t>::const_iterator outPos = find(outChannels.begin(), outChannels.end(), nextInChannels[k]);
+		vector<size_t>::const_iterator inPos = find(inChannels.begin(), inChannels.end(), nextInChannels[k]);
+		nextInputRows[k] = outPos != outChannels.end() ? (int)(outPos - outChannels.begin()) : -1;
+		nextInputColumns[k] = inPos != inChannels.end() ? (int)(inPos - inChannels.begin()) : -1;
+		if (nextInputRows[k] == -1 && nextInputColumns[k] == -1)
+			return false;
+	}
+
+	vector<vector<double>> mergedMatrix = matrix;
+	vector<double> mergedConstants = constants;
+	vector<size_t> mergedChannels = outChannels;
+	for (size_t o = 0; o < nextOutChannels.size(); o++)
 	{
-		for (unsigned i = 0; i < assignmentCount; i++)
+		vector<double> row(inChannels.size(), 0.0);
+		double constant = next->constants[o];
+		for (size_t k = 0; k < nextInChannels.size(); k++)
 		{
-			InternalAssignment& ia = internalAssignments[i];
-			if (ia.sourceSum != NULL)
+			double factor = next->matrix[o][k];
+			if (factor == 0.0)
+				continue;
+
+			if (nextInputRows[k] != -1)
 			{
-				MemoryHelper::free(ia.sourceSum);
-				ia.sourceSum = NULL;
+				const vector<double>& sourceRow = matrix[nextInputRows[k]];
+				for (size_t c = 0; c < row.size(); c++)
+					row[c] += factor * sourceRow[c];
+				constant += factor * constants[nextInputRows[k]];
 			}
+			else
+			{
+				row[nextInputColumns[k]] += factor;
+			}
+		}
+
+		vector<size_t>::iterator pos = find(mergedChannels.begin(), mergedChannels.end(), nextOutChannels[o]);
+		if (pos != mergedChannels.end())
+		{
+			mergedMatrix[pos - mergedChannels.begin()] = row;
+			mergedConstants[pos - mergedChannels.begin()] = constant;
+		}
+		else
+		{
+			mergedChannels.push_back(nextOutChannels[o]);
+			mergedMatrix.push_back(row);
+			mergedConstants.push_back(constant);
+		}
+	}
+
+	matrix = mergedMatrix;
+	constants = mergedConstants;
+	outChannels = mergedChannels;
+	updateIdentity(inChannels, outChannels);
+	compileMatrix();
+
+	TraceF(L"Merged following Copy filter, mixing %d input channels to %d output channels", inChannels.size(), outChannels.size());
+
+	return true;
+}
+
+bool CopyFilter::applyGain(const vector<size_t>& channels, double gain)
+{
+	for (size_t o : channels)
+	{
+		for (size_t k = 0; k < matrix[o].size(); k++)
+			matrix[o][k] *= gain;
+		constants[o] *= gain;
+	}
+
+	if (gain != 1.0)
+		identity = false;
+	compileMatrix();
+
+	return true;
+}
+
+void CopyFilter::updateIdentity(const vector<size_t>& inChannels, const vector<size_t>& outChannels)
+{
+	identity = true;
+	for (size_t o = 0; o < outChannels.size(); o++)
+	{
+		if (constants[o] != 0.0 || find(inChannels.begin(), inChannels.end(), outChannels[o]) == inChannels.end())
+			identity = false;
+
+		for (size_t k = 0; k < inChannels.size(); k++)
+		{
+			if (matrix[o][k] != (inChannels[k] == outChannels[o] ? 1.0 : 0.0))
+				identity = false;
 		}
+	}
+}
 
-		MemoryHelper::free(internalAssignments);
-		internalAssignments = NULL;
+void CopyFilter::cleanup()
+{
+	if (mixGroups != NULL)
+	{
+		for (unsigned g = 0; g < mixGroupCount; g++)
+		{
+			MemoryHelper::free(mixGroups[g].inputs);
+			MemoryHelper::free(mixGroups[g].factors);
+		}
+
+		MemoryHelper::free(mixGroups);
+		mixGroups = NULL;
+		mixGroupCount = 0;
+	}
+
+	if (discardBuffer != NULL)
+	{
+		MemoryHelper::free(discardBuffer);
+		discardBuffer = NULL;
 	}
 }
 
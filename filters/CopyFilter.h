@@ -48,29 +48,44 @@ public:
 	bool getInPlace() override {return false;}
 	std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) override;
 	void process(double** output, double** input, unsigned frameCount) override;
+	bool isIdentity() override {return identity;}
+	bool applyGain(const std::vector<size_t>& channels, double gain) override;
+	// combines the mixing matrix of a following Copy filter into this one if the routing allows it
+	bool mergeNext(IFilter* next, const std::vector<size_t>& inChannels, std::vector<size_t>& outChannels,
+		const std::vector<size_t>& nextInChannels, const std::vector<size_t>& nextOutChannels) override;
 
 	std::vector<Assignment> getAssignments() const;
 
 private:
+	static const unsigned MIX_GROUP_SIZE = 4;
+	static const unsigned NO_OUTPUT = (unsigned)-1;
+
+	void compileMatrix();
+	void updateIdentity(const std::vector<size_t>& inChannels, const std::vector<size_t>& outChannels);
 	void cleanup();
 
 	std::vector<Assignment> assignments;
 
-	struct InternalAssignment
-	{
-		int targetChannel;
-
-		struct InternalSummand
-		{
-			double factor;
-			int channel;
-		};
+	// factors for each output channel and input channel, plus a constant value for each output channel
+	std::vector<std::vector<double>> matrix;
+	std::vector<double> constants;
+	// every output channel is a copy of the same input channel
+	bool identity;
 
-		InternalSummand* sourceSum;
-		unsigned sourceCount;
+	// output channels are mixed in groups of MIX_GROUP_SIZE, reading only the inputs used by the group
+	struct MixGroup
+	{
+		unsigned outputs[MIX_GROUP_SIZE];
+		double constants[MIX_GROUP_SIZE];
+		unsigned inputCount;
+		unsigned* inputs;
+		double* factors;
 	};
 
-	InternalAssignment* internalAssignments;
-	unsigned assignmentCount;
+	MixGroup* mixGroups;
+	unsigned mixGroupCount;
+	unsigned maxFrameCount;
+	// target for the unused outputs of the last group
+	double* discardBuffer;
 };
 #pragma AVRT_VTABLES_END
@@ -27,5 +27,6 @@
 class CopyFilterFactory : public IFilterFactory
 {
 public:
+	std::vector<std::wstring> getCommands() override {return {L"Copy"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
 };
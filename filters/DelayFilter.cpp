@@ -21,6 +21,7 @@
 #include <cmath>
 
 #include "helpers/MemoryHelper.h"
+#include "helpers/DelayLineHelper.h"
 #include "DelayFilter.h"
 
 using namespace std;
@@ -64,42 +65,20 @@ vector<wstring> DelayFilter::initialize(float sampleRate, unsigned maxFrameCount
 void DelayFilter::process(double** output, double** input, unsigned frameCount)
 {
 	for (unsigned i = 0; i < channelCount; i++)
-	{
-		double* inputChannel = input[i];
-		double* outputChannel = output[i];
-		double* bufferChannel = buffers[i];
-
-		if (bufferLength <= frameCount)
-		{
-			memcpy(outputChannel, bufferChannel + bufferOffset, (bufferLength - bufferOffset) * sizeof(double));
-			memcpy(outputChannel + bufferLength - bufferOffset, bufferChannel, bufferOffset * sizeof(double));
-			memcpy(outputChannel + bufferLength, inputChannel, (frameCount - bufferLength) * sizeof(double));
-			memcpy(bufferChannel, inputChannel + frameCount - bufferLength, bufferLength * sizeof(double));
-		}
-		else
-		{
-			if (bufferLength < bufferOffset + frameCount)
-			{
-				memcpy(outputChannel, bufferChannel + bufferOffset, (bufferLength - bufferOffset) * sizeof(double));
-				memcpy(outputChannel + bufferLength - bufferOffset, bufferChannel, (frameCount - (bufferLength - bufferOffset)) * sizeof(double));
-				memcpy(bufferChannel + bufferOffset, inputChannel, (bufferLength - bufferOffset) * sizeof(double));
-				memcpy(bufferChannel, inputChannel + bufferLength - bufferOffset, (frameCount - (bufferLength - bufferOffset)) * sizeof(double));
-			}
-			else
-			{
-				memcpy(outputChannel, bufferChannel + bufferOffset, frameCount * sizeof(double));
-				memcpy(bufferChannel + bufferOffset, inputChannel, frameCount * sizeof(double));
-			}
-		}
-	}
+		DelayLineHelper::process(output[i], input[i], buffers[i], bufferLength, bufferOffset, frameCount);
 
-	if (bufferLength <= frameCount)
-		bufferOffset = 0;
-	else
-		bufferOffset = (bufferOffset + frameCount) % bufferLength;
+	bufferOffset = DelayLineHelper::nextOffset(bufferLength, bufferOffset, frameCount);
 }
 #pragma AVRT_CODE_END
 
+void DelayFilter::reset()
+{
+	for (unsigned i = 0; i < channelCount; i++)
+		memset(buffers[i], 0, sizeof(double) * bufferLength);
+
+	bufferOffset = 0;
+}
+
 void DelayFilter::cleanup()
 {
 	if (buffers != NULL)
@@ -30,6 +30,8 @@ public:
 	bool getInPlace() override {return false;}
 	std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) override;
 	void process(double** output, double** input, unsigned frameCount) override;
+	void reset() override;
+	unsigned getBufferDelay() override {return bufferLength;}
 
 	double getDelay() const;
 	bool getIsMs() const;
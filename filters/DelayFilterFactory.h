@@ -27,5 +27,6 @@
 class DelayFilterFactory : public IFilterFactory
 {
 public:
+	std::vector<std::wstring> getCommands() override {return {L"Delay"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
 };
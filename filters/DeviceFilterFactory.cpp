@@ -18,7 +18,6 @@
 */
 
 #include "stdafx.h"
-#include <regex>
 #include <mpParser.h>
 #include "helpers/LogHelper.h"
 #include "helpers/StringHelper.h"
@@ -29,8 +28,6 @@
 
 using namespace std;
 
-static wregex regexGuid(L"\\{[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}\\}");
-
 #ifndef NO_FILTERENGINE
 void DeviceFilterFactory::initialize(FilterEngine* engine)
 {
@@ -105,7 +102,7 @@ bool DeviceFilterFactory::matchDevice(const std::wstring& deviceString, const st
 		}
 	}
 
-	wstring deviceStringNoGuid = regex_replace(deviceString, regexGuid, L"");
+	wstring deviceStringNoGuid = StringHelper::removeGuids(deviceString);
 
 	bool matches = false;
 
@@ -35,6 +35,7 @@ using namespace mup;
 void ExpressionFilterFactory::initialize(FilterEngine* engine)
 {
 	parser = engine->getParser();
+	expressionCache.setParser(parser);
 	parser->DefineConst(L"inputChannelCount", mup::int_type(engine->getInputChannelCount()));
 	parser->DefineConst(L"outputChannelCount", mup::int_type(engine->getOutputChannelCount()));
 	parser->DefineConst(L"sampleRate", mup::float_type(engine->getSampleRate()));
@@ -86,8 +87,7 @@ vector<IFilter*> ExpressionFilterFactory::createFilter(const wstring& configPath
 					inExpression = false;
 					try
 					{
-						parser->SetExpr(expression);
-						Value result = parser->Eval();
+						Value result = expressionCache.evaluate(expression);
 						wstring resultString;
 						if (result.GetType() == L's')
 							resultString = result.GetString();
@@ -133,8 +133,7 @@ vector<IFilter*> ExpressionFilterFactory::createFilter(const wstring& configPath
 		try
 		{
 			expression = StringHelper::trim(parameters);
-			parser->SetExpr(expression);
-			Value result = parser->Eval();
+			Value result = expressionCache.evaluate(expression);
 			wstring resultString;
 			if (result.GetType() == L's')
 				resultString = result.GetString();
@@ -22,6 +22,7 @@
 #include <string>
 #include <mpParser.h>
 
+#include "parser/ExpressionCache.h"
 #include "IFilterFactory.h"
 #include "IFilter.h"
 
@@ -33,4 +34,5 @@ public:
 
 private:
 	mup::ParserX* parser;
+	ExpressionCache expressionCache;
 };
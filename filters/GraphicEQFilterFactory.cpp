@@ -18,7 +18,6 @@
 */
 
 #include "stdafx.h"
-#include <regex>
 
 #include "helpers/MemoryHelper.h"
 #include "helpers/StringHelper.h"
@@ -28,8 +27,6 @@
 
 using namespace std;
 
-static wregex regexNumber(L"[-+0-9.eE]+");
-
 vector<IFilter*> GraphicEQFilterFactory::createFilter(const wstring& configPath, wstring& command, wstring& parameters)
 {
 	GraphicEQFilter* filter = NULL;
@@ -40,21 +37,32 @@ vector<IFilter*> GraphicEQFilterFactory::createFilter(const wstring& configPath,
 		if (value.find(L'.') == wstring::npos)
 			value = StringHelper::replaceCharacters(value, L",", L".");
 
-		wsregex_iterator begin(value.begin(), value.end(), regexNumber);
-		wsregex_iterator end;
-
 		vector<FilterNode> nodes;
-		for (wsregex_iterator it = begin; it != end; it++)
+		// numbers are alternately frequency and gain, everything between them is ignored
+		bool haveFreq = false;
+		double freq = 0;
+		size_t pos = 0;
+		while (pos < value.length())
 		{
-			wsmatch freqMatch = *it++;
-			if (it != end)
+			size_t end = StringHelper::skipNumber(value, pos);
+			if (end == pos)
 			{
-				wsmatch gainMatch = *it;
-				double freq = wcstod(freqMatch.str(0).c_str(), NULL);
-				double gain = wcstod(gainMatch.str(0).c_str(), NULL);
-				FilterNode node(freq, gain);
+				pos++;
+				continue;
+			}
+
+			double number = wcstod(value.substr(pos, end - pos).c_str(), NULL);
+			if (haveFreq)
+			{
+				FilterNode node(freq, number);
 				nodes.push_back(node);
 			}
+			else
+			{
+				freq = number;
+			}
+			haveFreq = !haveFreq;
+			pos = end;
 		}
 		sort(nodes.begin(), nodes.end());
 
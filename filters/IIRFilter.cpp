@@ -117,4 +117,10 @@ void IIRFilter::process(double** output, double** input, unsigned frameCount)
 			y[i] = 0.0;
 	}
 }
-#pragma AVRT_CODE_END
\ No newline at end of file
+#pragma AVRT_CODE_END
+
+void IIRFilter::reset()
+{
+	memset(x, 0, order * channelCount * sizeof(double));
+	memset(y, 0, order * channelCount * sizeof(double));
+}
\ No newline at end of file
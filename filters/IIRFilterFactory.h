@@ -28,5 +28,6 @@ class IIRFilterFactory : public IFilterFactory
 {
 public:
 	IIRFilterFactory();
+	std::vector<std::wstring> getCommands() override {return {L"Filter*"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
 };
@@ -30,7 +30,7 @@ using namespace mup;
 
 void IfFilterFactory::initialize(FilterEngine* engine)
 {
-	parser = engine->getParser();
+	expressionCache.setParser(engine->getParser());
 }
 
 vector<IFilter*> IfFilterFactory::startOfConfiguration()
@@ -67,8 +67,7 @@ vector<IFilter*> IfFilterFactory::createFilter(const wstring& configPath, wstrin
 		{
 			try
 			{
-				parser->SetExpr(expression);
-				Value result = parser->Eval();
+				Value result = expressionCache.evaluate(expression);
 				bool isTrue = toBoolean(result);
 				if (result.GetType() == L'b')
 					TraceF(L"If(%s) evaluated to %s", expression.c_str(), result.ToString().c_str());
@@ -114,8 +113,7 @@ vector<IFilter*> IfFilterFactory::createFilter(const wstring& configPath, wstrin
 		{
 			try
 			{
-				parser->SetExpr(expression);
-				Value result = parser->Eval();
+				Value result = expressionCache.evaluate(expression);
 				bool isTrue = toBoolean(result);
 				if (result.GetType() == L'b')
 					TraceF(L"ElseIf(%s) evaluated to %s", expression.c_str(), result.ToString().c_str());
@@ -22,6 +22,7 @@
 #include <string>
 #include <mpParser.h>
 
+#include "parser/ExpressionCache.h"
 #include "IFilterFactory.h"
 #include "IFilter.h"
 
@@ -35,7 +36,7 @@ public:
 	std::vector<IFilter*> endOfFile(const std::wstring& configPath) override;
 
 private:
-	mup::ParserX* parser;
+	ExpressionCache expressionCache;
 
 	unsigned trueCount;
 	unsigned falseCount;
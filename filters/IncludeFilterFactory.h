@@ -31,6 +31,7 @@ public:
 
 	std::vector<IFilter*> startOfConfiguration() override;
 	std::vector<IFilter*> startOfFile(const std::wstring& configPath) override;
+	std::vector<std::wstring> getCommands() override {return {L"Include"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
 	std::vector<IFilter*> endOfFile(const std::wstring& configPath) override;
 
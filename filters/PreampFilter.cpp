@@ -20,10 +20,8 @@
 #include "stdafx.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
-#ifndef _M_ARM64
-#include <immintrin.h>
-#endif
 
+#include "helpers/SimdHelper.h"
 #include "PreampFilter.h"
 
 using namespace std;
@@ -41,75 +39,27 @@ vector<wstring> PreampFilter::initialize(float sampleRate, unsigned maxFrameCoun
 	return channelNames;
 }
 
-#pragma AVRT_CODE_BEGIN
-void PreampFilter::process(double** output, double** input, unsigned frameCount)
+bool PreampFilter::applyGain(const vector<size_t>& channels, double gain)
 {
-    // The gain factor is constant for all samples, load it once.
-    const double gainFactor = this->gain;
-
-    // Process each channel independently
-    for (size_t c = 0; c < channelCount; ++c)
-    {
-        double* inputChannel = input[c];
-        double* outputChannel = output[c];
-        size_t i = 0; // Tracks the number of processed samples for this channel
+	// the same gain is used for all channels
+	if (channels.size() != channelCount)
+		return false;
 
-        // The logic here is to process samples in chunks using the widest available instructions first,
-        // then step down to smaller vector sizes for the remainder.
-
-#if defined(__AVX512F__) && !defined(_M_ARM64)
-    // AVX-512 Path: Process 8 doubles at a time.
-        {
-            const size_t simd_width = 8;
-            if (frameCount >= simd_width) {
-                const __m512d gain_vec = _mm512_set1_pd(gainFactor);
-                for (; i + simd_width <= frameCount; i += simd_width)
-                {
-                    const __m512d samples = _mm512_loadu_pd(inputChannel + i);
-                    const __m512d result = _mm512_mul_pd(samples, gain_vec);
-                    _mm512_storeu_pd(outputChannel + i, result);
-                }
-            }
-        }
-#endif
-
-#if defined(__AVX2__) && !defined(_M_ARM64)
-        // AVX2 Path: Process the next 4 doubles at a time.
-        {
-            const size_t simd_width = 4;
-            if (frameCount - i >= simd_width) {
-                const __m256d gain_vec = _mm256_set1_pd(gainFactor);
-                for (; i + simd_width <= frameCount; i += simd_width)
-                {
-                    const __m256d samples = _mm256_loadu_pd(inputChannel + i);
-                    const __m256d result = _mm256_mul_pd(samples, gain_vec);
-                    _mm256_storeu_pd(outputChannel + i, result);
-                }
-            }
-        }
-#endif
+	this->gain *= gain;
+	return true;
+}
 
-#if !defined(_M_ARM64)
-        // SSE Path: Process the next 2 doubles at a time. This is valuable for leftovers.
-        {
-            const size_t simd_width = 2;
-            if (frameCount - i >= simd_width) {
-                const __m128d gain_vec = _mm_set1_pd(gainFactor);
-                for (; i + simd_width <= frameCount; i += simd_width)
-                {
-                    const __m128d samples = _mm_loadu_pd(inputChannel + i);
-                    const __m128d result = _mm_mul_pd(samples, gain_vec);
-                    _mm_storeu_pd(outputChannel + i, result);
-                }
-            }
-        }
-#endif
+bool PreampFilter::getConstantGain(double& gain)
+{
+	gain = this->gain;
+	return true;
+}
 
-        // Scalar Fallback: Process any final remaining samples (max 1).
-        for (; i < frameCount; ++i)
-        {
-            outputChannel[i] = inputChannel[i] * gainFactor;
-        }
-    }
+#pragma AVRT_CODE_BEGIN
+void PreampFilter::process(double** output, double** input, unsigned frameCount)
+{
+	const SimdKernels& kernels = SimdHelper::getKernels();
+	for (size_t c = 0; c < channelCount; c++)
+		kernels.scale(output[c], input[c], gain, frameCount);
 }
 #pragma AVRT_CODE_END
\ No newline at end of file
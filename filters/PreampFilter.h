@@ -34,6 +34,10 @@ public:
 
 	std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) override;
 	void process(double** output, double** input, unsigned frameCount) override;
+	bool isIdentity() override { return gain == 1.0; }
+	bool applyGain(const std::vector<size_t>& channels, double gain) override;
+	// linear gain, including gains of other filters folded into this one
+	bool getConstantGain(double& gain) override;
 
 	double getDbGain() const { return dbGain; }
 
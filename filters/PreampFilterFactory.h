@@ -27,5 +27,6 @@
 class PreampFilterFactory : public IFilterFactory
 {
 public:
+	std::vector<std::wstring> getCommands() override {return {L"Preamp"};}
 	std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters) override;
 };
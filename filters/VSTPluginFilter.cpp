@@ -20,12 +20,16 @@
 #include "stdafx.h"
 #include "helpers/StringHelper.h"
 #include "helpers/LogHelper.h"
+#include "helpers/SimdHelper.h"
+#include "helpers/DelayLineHelper.h"
 #include "VSTPluginFilter.h"
 
 using namespace std;
 
-VSTPluginFilter::VSTPluginFilter(std::shared_ptr<VSTPluginLibrary> library, std::wstring chunkData, std::unordered_map<std::wstring, float> paramMap)
-	: library(library), chunkData(chunkData), paramMap(paramMap)
+const double VSTPluginFilter::DEADLINE_FRACTION = 0.5;
+
+VSTPluginFilter::VSTPluginFilter(std::shared_ptr<VSTPluginLibrary> library, std::wstring chunkData, std::unordered_map<std::wstring, float> paramMap, bool parallel)
+	: library(library), chunkData(chunkData), paramMap(paramMap), parallel(parallel), missedBlocks(0), reportedMissedBlocks(0)
 {
 	libPath = library->getLibPath();
 }
@@ -40,6 +44,7 @@ std::vector<std::wstring> VSTPluginFilter::initialize(float sampleRate, unsigned
 	cleanup();
 
 	channelCount = channelNames.size();
+	this->sampleRate = sampleRate;
 	if (channelCount == 0)
 		return channelNames;
 
@@ -111,11 +116,71 @@ std::vector<std::wstring> VSTPluginFilter::initialize(float sampleRate, unsigned
 			memset(delayBuffers[i], 0, delayBufferLength * sizeof(double));
 		}
 		delayBufferOffset = 0;
+		delayInput = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
 	}
 
+	if (parallel && effectCount > 1 && !skipProcessing)
+		initializeParallel(maxFrameCount);
+
 	return channelNames;
 }
 
+void VSTPluginFilter::initializeParallel(unsigned maxFrameCount)
+{
+	int numInputs = effects[0]->numInputs();
+	int numOutputs = effects[0]->numOutputs();
+
+	// the workers must not touch the buffers of the audio engine, as they may still run after the deadline
+	workerTasks = (WorkerTask*)MemoryHelper::alloc((effectCount - 1) * sizeof(WorkerTask));
+	for (unsigned i = 0; i < effectCount - 1; i++)
+	{
+		WorkerTask& task = workerTasks[i];
+		task.frameCount = 0;
+		task.started = false;
+		task.crashed = false;
+		task.onWorker = false;
+		task.running.store(false, memory_order_relaxed);
+		task.inputs = (double**)MemoryHelper::alloc(numInputs * sizeof(double*));
+		for (int j = 0; j < numInputs; j++)
+		{
+			task.inputs[j] = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
+			memset(task.inputs[j], 0, maxFrameCount * sizeof(double));
+		}
+		task.outputs = (double**)MemoryHelper::alloc(numOutputs * sizeof(double*));
+		for (int j = 0; j < numOutputs; j++)
+		{
+			task.outputs[j] = (double*)MemoryHelper::alloc(maxFrameCount * sizeof(double));
+			memset(task.outputs[j], 0, maxFrameCount * sizeof(double));
+		}
+		task.floatInputs = (float**)MemoryHelper::alloc(numInputs * sizeof(float*));
+		for (int j = 0; j < numInputs; j++)
+			task.floatInputs[j] = (float*)MemoryHelper::alloc(maxFrameCount * sizeof(float));
+		task.floatOutputs = (float**)MemoryHelper::alloc(numOutputs * sizeof(float*));
+		for (int j = 0; j < numOutputs; j++)
+			task.floatOutputs[j] = (float*)MemoryHelper::alloc(maxFrameCount * sizeof(float));
+	}
+
+	missedBlocks = 0;
+	reportedMissedBlocks = 0;
+	workerPool = RealtimeWorkerPool::acquireShared();
+
+	TraceF(L"Processing %d instances of VST plugin %s on up to %d shared worker threads", effectCount, libPath.c_str(),
+		min((unsigned)effectCount - 1, workerPool->getWorkerCount()));
+}
+
+void VSTPluginFilter::waitForWorkerTasks()
+{
+	if (workerTasks == NULL)
+		return;
+
+	// tasks that missed their deadline still use their effect and buffers
+	for (unsigned i = 0; i < effectCount - 1; i++)
+	{
+		while (workerTasks[i].running.load(memory_order_acquire))
+			Sleep(1);
+	}
+}
+
 void VSTPluginFilter::prepareForProcessing(float sampleRate, unsigned maxFrameCount)
 {
 	__try
@@ -141,11 +206,6 @@ void VSTPluginFilter::prepareForProcessing(float sampleRate, unsigned maxFrameCo
 }
 
 #pragma AVRT_CODE_BEGIN
-void convertFloatToDouble(double* dest, const float* src, size_t count);
-
-// Converts a block of doubles back to floats.
-void convertDoubleToFloat(float* dest, const double* src, size_t count);
-
 void VSTPluginFilter::process(double** output, double** input, unsigned frameCount)
 {
 	if (skipProcessing)
@@ -157,67 +217,47 @@ void VSTPluginFilter::process(double** output, double** input, unsigned frameCou
 
 	__try
 	{
-		unsigned channelOffset = 0;
-		unsigned emptyChannelIndex = 0;
-		for (unsigned i = 0; i < effectCount; i++)
+		if (workerTasks != NULL)
 		{
-			VSTPluginInstance* effect = effects[i];
-			// Setup double pointer arrays to point to the correct source/destination double buffers
-			for (int j = 0; j < effect->numInputs(); j++)
-			{
-				if (channelOffset + j < channelCount)
-					inputArray[j] = input[channelOffset + j];
-				else
-					inputArray[j] = emptyChannels[emptyChannelIndex++];
-			}
-
-			for (int j = 0; j < effect->numOutputs(); j++)
+			processParallel(output, input, frameCount);
+		}
+		else
+		{
+			unsigned channelOffset = 0;
+			unsigned emptyChannelIndex = 0;
+			for (unsigned i = 0; i < effectCount; i++)
 			{
-				if (channelOffset + j < channelCount)
-					outputArray[j] = output[channelOffset + j];
-				else
-					outputArray[j] = emptyChannels[emptyChannelIndex++];
-			}
-
-			if (effect->canDoubleReplacing()) {
-				effect->processDoubleReplacing(inputArray, outputArray, frameCount);
-			}
-			else {
-				// Convert input from double** to float** using pre-allocated buffers
+				VSTPluginInstance* effect = effects[i];
+				// Setup double pointer arrays to point to the correct source/destination double buffers
 				for (int j = 0; j < effect->numInputs(); j++)
 				{
-					convertDoubleToFloat(floatInputs[j], inputArray[j], frameCount);
-				}
-
-				if (effect->canReplacing())
-				{
-					effect->processReplacing(floatInputs, floatOutputs, frameCount);
-				}
-				else
-				{
-					// For non-replacing, VST expects to add to the output. Clear float buffer first.
-					for (int j = 0; j < effect->numOutputs(); j++)
-						memset(floatOutputs[j], 0, frameCount * sizeof(float));
-					effect->process(floatInputs, floatOutputs, frameCount);
+					if (channelOffset + j < channelCount)
+						inputArray[j] = input[channelOffset + j];
+					else
+						inputArray[j] = emptyChannels[emptyChannelIndex++];
 				}
 
-				// Convert output from float** back to double** into the final destination
 				for (int j = 0; j < effect->numOutputs(); j++)
 				{
-					convertFloatToDouble(outputArray[j], floatOutputs[j], frameCount);
+					if (channelOffset + j < channelCount)
+						outputArray[j] = output[channelOffset + j];
+					else
+						outputArray[j] = emptyChannels[emptyChannelIndex++];
 				}
-			}
 
-			if (effect->numOutputs() < effect->numInputs())
-			{
-				for (int j = effect->numOutputs(); j < effect->numInputs(); j++)
+				processEffect(effect, inputArray, outputArray, floatInputs, floatOutputs, frameCount);
+
+				if (effect->numOutputs() < effect->numInputs())
 				{
-					if (channelOffset + j < channelCount)
-						memset(output[channelOffset + j], 0, frameCount * sizeof(double));
+					for (int j = effect->numOutputs(); j < effect->numInputs(); j++)
+					{
+						if (channelOffset + j < channelCount)
+							memset(output[channelOffset + j], 0, frameCount * sizeof(double));
+					}
 				}
-			}
 
-			channelOffset += effectChannelCount;
+				channelOffset += effectChannelCount;
+			}
 		}
 
 		// Apply delay compensation if needed
@@ -225,63 +265,194 @@ void VSTPluginFilter::process(double** output, double** input, unsigned frameCou
 		{
 			for (unsigned i = 0; i < channelCount; i++)
 			{
-				double* outputChannel = output[i];
-				double* delayBuffer = delayBuffers[i];
-
-				if (delayBufferLength <= frameCount)
-				{
-					// Delay is smaller than frame count - output from buffer then from current processing
-					memcpy(outputChannel, delayBuffer + delayBufferOffset, (delayBufferLength - delayBufferOffset) * sizeof(double));
-					memcpy(outputChannel + delayBufferLength - delayBufferOffset, delayBuffer, delayBufferOffset * sizeof(double));
-					memcpy(outputChannel + delayBufferLength, outputChannel, (frameCount - delayBufferLength) * sizeof(double));
-					memcpy(delayBuffer, outputChannel + frameCount - delayBufferLength, delayBufferLength * sizeof(double));
-				}
-				else
-				{
-					// Create temporary buffer to hold current output
-					double* tempBuffer = (double*)MemoryHelper::alloc(frameCount * sizeof(double));
-					memcpy(tempBuffer, outputChannel, frameCount * sizeof(double));
-
-					if (delayBufferLength < delayBufferOffset + frameCount)
-					{
-						// Wrapping around the delay buffer
-						memcpy(outputChannel, delayBuffer + delayBufferOffset, (delayBufferLength - delayBufferOffset) * sizeof(double));
-						memcpy(outputChannel + delayBufferLength - delayBufferOffset, delayBuffer, (frameCount - (delayBufferLength - delayBufferOffset)) * sizeof(double));
-						memcpy(delayBuffer + delayBufferOffset, tempBuffer, (delayBufferLength - delayBufferOffset) * sizeof(double));
-						memcpy(delayBuffer, tempBuffer + delayBufferLength - delayBufferOffset, (frameCount - (delayBufferLength - delayBufferOffset)) * sizeof(double));
-					}
-					else
-					{
-						// Simple case - no wrapping
-						memcpy(outputChannel, delayBuffer + delayBufferOffset, frameCount * sizeof(double));
-						memcpy(delayBuffer + delayBufferOffset, tempBuffer, frameCount * sizeof(double));
-					}
-
-					MemoryHelper::free(tempBuffer);
-				}
+				memcpy(delayInput, output[i], frameCount * sizeof(double));
+				DelayLineHelper::process(output[i], delayInput, delayBuffers[i], delayBufferLength, delayBufferOffset, frameCount);
 			}
 
-			// Update buffer offset
-			if (delayBufferLength <= frameCount)
-				delayBufferOffset = 0;
-			else
-				delayBufferOffset = (delayBufferOffset + frameCount) % delayBufferLength;
+			delayBufferOffset = DelayLineHelper::nextOffset(delayBufferLength, delayBufferOffset, frameCount);
 		}
 	}
 	__except (EXCEPTION_EXECUTE_HANDLER)
 	{
 		if (reportCrash)
 		{
-			LogF(L"The VST plugin %s crashed during audio processing.", libPath.c_str());
+			LogF(L"The VST plugin %s crashed during audio processing and is bypassed from now on.", libPath.c_str());
 			reportCrash = false;
 		}
 
+		// the plugin may be in an inconsistent state, so it is not called again
+		skipProcessing = true;
+
 		for (unsigned i = 0; i < channelCount; i++)
 			memcpy(output[i], input[i], frameCount * sizeof(double));
 	}
 }
+
+void VSTPluginFilter::processEffect(VSTPluginInstance* effect, double** inputArray, double** outputArray, float** floatInputs, float** floatOutputs, unsigned frameCount)
+{
+	if (effect->canDoubleReplacing()) {
+		effect->processDoubleReplacing(inputArray, outputArray, frameCount);
+	}
+	else {
+		const SimdKernels& kernels = SimdHelper::getKernels();
+
+		// Convert input from double** to float** using pre-allocated buffers
+		for (int j = 0; j < effect->numInputs(); j++)
+		{
+			kernels.convertDoubleToFloat(floatInputs[j], inputArray[j], frameCount);
+		}
+
+		if (effect->canReplacing())
+		{
+			effect->processReplacing(floatInputs, floatOutputs, frameCount);
+		}
+		else
+		{
+			// For non-replacing, VST expects to add to the output. Clear float buffer first.
+			for (int j = 0; j < effect->numOutputs(); j++)
+				memset(floatOutputs[j], 0, frameCount * sizeof(float));
+			effect->process(floatInputs, floatOutputs, frameCount);
+		}
+
+		// Convert output from float** back to double** into the final destination
+		for (int j = 0; j < effect->numOutputs(); j++)
+		{
+			kernels.convertFloatToDouble(outputArray[j], floatOutputs[j], frameCount);
+		}
+	}
+}
+
+void VSTPluginFilter::processParallel(double** output, double** input, unsigned frameCount)
+{
+	long long deadline = workerPool->getDeadline(frameCount / sampleRate * DEADLINE_FRACTION);
+
+	// fork: the workers only see private copies of the input
+	for (unsigned i = 1; i < effectCount; i++)
+	{
+		WorkerTask& task = workerTasks[i - 1];
+		// still busy with a block that missed its deadline, or bypassed for good after crashing
+		task.started = !task.running.load(memory_order_acquire) && !task.crashed;
+		if (!task.started)
+			continue;
+
+		unsigned channelOffset = i * effectChannelCount;
+		for (int j = 0; j < effects[i]->numInputs() && channelOffset + j < channelCount; j++)
+			memcpy(task.inputs[j], input[channelOffset + j], frameCount * sizeof(double));
+		task.frameCount = frameCount;
+		task.onWorker = workerPool->startAny(&runWorkerTask, this, i, task.running);
+	}
+
+	// the first instance runs on the audio thread in the meantime
+	VSTPluginInstance* effect = effects[0];
+	unsigned emptyChannelIndex = 0;
+	for (int j = 0; j < effect->numInputs(); j++)
+		inputArray[j] = j < (int)channelCount ? input[j] : emptyChannels[emptyChannelIndex++];
+	for (int j = 0; j < effect->numOutputs(); j++)
+		outputArray[j] = j < (int)channelCount ? output[j] : emptyChannels[emptyChannelIndex++];
+	processEffect(effect, inputArray, outputArray, floatInputs, floatOutputs, frameCount);
+	for (int j = effect->numOutputs(); j < effect->numInputs() && j < (int)channelCount; j++)
+		memset(output[j], 0, frameCount * sizeof(double));
+
+	// as do the instances for which all shared workers were busy, e.g. with other filters or devices
+	for (unsigned i = 1; i < effectCount; i++)
+	{
+		WorkerTask& task = workerTasks[i - 1];
+		if (task.started && !task.onWorker)
+			processEffect(effects[i], task.inputs, task.outputs, task.floatInputs, task.floatOutputs, frameCount);
+	}
+
+	// join: instances that are not done by the deadline are bypassed for this block
+	for (unsigned i = 1; i < effectCount; i++)
+	{
+		WorkerTask& task = workerTasks[i - 1];
+		unsigned channelOffset = i * effectChannelCount;
+		unsigned usedChannelCount = min(effectChannelCount, (unsigned)channelCount - channelOffset);
+		if (task.started && (!task.onWorker || workerPool->join(task.running, deadline)) && !task.crashed)
+		{
+			for (unsigned j = 0; j < usedChannelCount; j++)
+			{
+				if ((int)j < effects[i]->numOutputs())
+					memcpy(output[channelOffset + j], task.outputs[j], frameCount * sizeof(double));
+				else
+					memset(output[channelOffset + j], 0, frameCount * sizeof(double));
+			}
+		}
+		else
+		{
+			// crashed is written by the worker, so it is only read after the task has returned
+			bool crashed = !task.running.load(memory_order_acquire) && task.crashed;
+			if (crashed && reportCrash)
+			{
+				LogF(L"The VST plugin %s crashed during audio processing and is bypassed on the affected channels from now on.", libPath.c_str());
+				reportCrash = false;
+			}
+			else if (!crashed)
+			{
+				missedBlocks.fetch_add(1, memory_order_relaxed);
+			}
+
+			for (unsigned j = 0; j < usedChannelCount; j++)
+				memcpy(output[channelOffset + j], input[channelOffset + j], frameCount * sizeof(double));
+		}
+	}
+}
+
+void VSTPluginFilter::runWorkerTask(void* context, unsigned task)
+{
+	VSTPluginFilter* filter = (VSTPluginFilter*)context;
+	WorkerTask* workerTask = &filter->workerTasks[task - 1];
+
+	__try
+	{
+		filter->processEffect(filter->effects[task], workerTask->inputs, workerTask->outputs,
+			workerTask->floatInputs, workerTask->floatOutputs, workerTask->frameCount);
+	}
+	__except (EXCEPTION_EXECUTE_HANDLER)
+	{
+		workerTask->crashed = true;
+	}
+
+	// reported here instead of on the audio thread
+	unsigned missed = filter->missedBlocks.load(memory_order_relaxed);
+	unsigned reported = filter->reportedMissedBlocks.load(memory_order_relaxed);
+	if (missed != reported && (missed & (missed - 1)) == 0 && filter->reportedMissedBlocks.compare_exchange_strong(reported, missed))
+		LogFStatic(L"VST plugin %s was bypassed on some channels for %d blocks as it did not finish in time", filter->libPath.c_str(), missed);
+}
 #pragma AVRT_CODE_END
 
+void VSTPluginFilter::reset()
+{
+	waitForWorkerTasks();
+
+	if (!skipProcessing)
+	{
+		__try
+		{
+			// suspending and resuming lets the plugins clear their internal buffers
+			for (unsigned i = 0; i < effectCount; i++)
+			{
+				if (i > 0 && workerTasks != NULL && workerTasks[i - 1].crashed)
+					continue;
+
+				effects[i]->stopProcessing();
+				effects[i]->startProcessing();
+			}
+		}
+		__except (EXCEPTION_EXECUTE_HANDLER)
+		{
+			LogF(L"The VST plugin %s crashed while being reset and is bypassed from now on.", libPath.c_str());
+			skipProcessing = true;
+		}
+	}
+
+	if (delayBuffers != NULL)
+	{
+		for (unsigned i = 0; i < channelCount; i++)
+			memset(delayBuffers[i], 0, delayBufferLength * sizeof(double));
+	}
+	delayBufferOffset = 0;
+}
+
 std::shared_ptr<VSTPluginLibrary> VSTPluginFilter::getLibrary() const
 {
 	return library;
@@ -297,8 +468,47 @@ std::unordered_map<std::wstring, float> VSTPluginFilter::getParamMap() const
 	return paramMap;
 }
 
+bool VSTPluginFilter::getParallel() const
+{
+	return parallel;
+}
+
 void VSTPluginFilter::cleanup()
 {
+	// no task may use the effects and buffers anymore
+	waitForWorkerTasks();
+	if (workerPool != NULL)
+	{
+		RealtimeWorkerPool::releaseShared();
+		workerPool = NULL;
+	}
+
+	if (workerTasks != NULL)
+	{
+		int numInputs = effects[0]->numInputs();
+		int numOutputs = effects[0]->numOutputs();
+		for (unsigned i = 0; i < effectCount - 1; i++)
+		{
+			WorkerTask& task = workerTasks[i];
+			for (int j = 0; j < numInputs; j++)
+			{
+				MemoryHelper::free(task.inputs[j]);
+				MemoryHelper::free(task.floatInputs[j]);
+			}
+			for (int j = 0; j < numOutputs; j++)
+			{
+				MemoryHelper::free(task.outputs[j]);
+				MemoryHelper::free(task.floatOutputs[j]);
+			}
+			MemoryHelper::free(task.inputs);
+			MemoryHelper::free(task.outputs);
+			MemoryHelper::free(task.floatInputs);
+			MemoryHelper::free(task.floatOutputs);
+		}
+		MemoryHelper::free(workerTasks);
+		workerTasks = NULL;
+	}
+
 	if (effects != NULL)
 	{
 		for (unsigned i = 0; i < effectCount; i++)
@@ -358,6 +568,11 @@ void VSTPluginFilter::cleanup()
 		MemoryHelper::free(delayBuffers);
 		delayBuffers = NULL;
 	}
+	if (delayInput != NULL)
+	{
+		MemoryHelper::free(delayInput);
+		delayInput = NULL;
+	}
 	delayBufferLength = 0;
 	delayBufferOffset = 0;
 }
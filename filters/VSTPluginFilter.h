@@ -19,32 +19,63 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "IFilter.h"
 #include "helpers/VSTPluginLibrary.h"
+#include "helpers/RealtimeWorkerPool.h"
 
 #pragma AVRT_VTABLES_BEGIN
 class VSTPluginFilter : public IFilter
 {
 public:
-	VSTPluginFilter(std::shared_ptr<VSTPluginLibrary> library, std::wstring chunkData, std::unordered_map<std::wstring, float> paramMap);
+	VSTPluginFilter(std::shared_ptr<VSTPluginLibrary> library, std::wstring chunkData, std::unordered_map<std::wstring, float> paramMap, bool parallel = false);
 	~VSTPluginFilter();
 
 	bool getInPlace() override {return false;}
 	std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames) override;
 	void prepareForProcessing(float sampleRate, unsigned maxFrameCount);
 	void process(double** output, double** input, unsigned frameCount) override;
+	void reset() override;
 
 	std::shared_ptr<VSTPluginLibrary> getLibrary() const;
 	std::wstring getChunkData() const;
 	std::unordered_map<std::wstring, float> getParamMap() const;
+	bool getParallel() const;
 
 private:
+	// buffers of an effect instance that is processed on a worker thread
+	struct WorkerTask
+	{
+		unsigned frameCount;
+		double** inputs;
+		double** outputs;
+		float** floatInputs;
+		float** floatOutputs;
+		bool started;
+		bool crashed;
+		// false if all shared workers were busy, so the task runs on the audio thread
+		bool onWorker;
+		// set by the pool until the task has returned, which may be after the deadline
+		std::atomic<bool> running;
+	};
+
+	// share of the block duration after which effects still running on workers are bypassed
+	static const double DEADLINE_FRACTION;
+
+	static void runWorkerTask(void* context, unsigned task);
+	void processEffect(VSTPluginInstance* effect, double** inputArray, double** outputArray, float** floatInputs, float** floatOutputs, unsigned frameCount);
+	void processParallel(double** output, double** input, unsigned frameCount);
+	void initializeParallel(unsigned maxFrameCount);
+	void waitForWorkerTasks();
 	void cleanup();
 
 	std::shared_ptr<VSTPluginLibrary> library;
 	std::wstring libPath;
 	std::wstring chunkData;
 	std::unordered_map<std::wstring, float> paramMap;
+	bool parallel;
+	float sampleRate;
 	size_t channelCount;
 	unsigned effectChannelCount;
 	size_t effectCount = 0;
@@ -64,6 +95,14 @@ private:
 	unsigned delayBufferLength = 0;
 	double** delayBuffers = NULL;
 	unsigned delayBufferOffset = 0;
+	// copy of the plugin output of one channel, as the delay line cannot work in place
+	double* delayInput = NULL;
+
+	// the effects after the first one run on the workers of the shared pool when processing in parallel
+	RealtimeWorkerPool* workerPool = NULL;
+	WorkerTask* workerTasks = NULL;
+	std::atomic<unsigned> missedBlocks;
+	std::atomic<unsigned> reportedMissedBlocks;
 
 	bool skipProcessing = false;
 	bool reportCrash = true;
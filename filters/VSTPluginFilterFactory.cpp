@@ -35,6 +35,7 @@ vector<IFilter*> VSTPluginFilterFactory::createFilter(const wstring& configPath,
 		shared_ptr<VSTPluginLibrary> library;
 		wstring chunkData;
 		unordered_map<wstring, float> paramMap;
+		bool parallel = false;
 		vector<wstring> parts = StringHelper::splitQuoted(parameters, ' ');
 		for (unsigned i = 0; i + 1 < parts.size(); i += 2)
 		{
@@ -65,6 +66,10 @@ vector<IFilter*> VSTPluginFilterFactory::createFilter(const wstring& configPath,
 			{
 				chunkData = value;
 			}
+			else if (key == L"Parallel")
+			{
+				parallel = value == L"true";
+			}
 			else
 			{
 				if (!isdigit(value.c_str()[0]))
@@ -117,7 +122,7 @@ vector<IFilter*> VSTPluginFilterFactory::createFilter(const wstring& configPath,
 			if (create)
 			{
 				void* mem = MemoryHelper::alloc(sizeof(VSTPluginFilter));
-				filter = new(mem) VSTPluginFilter(library, chunkData, paramMap);
+				filter = new(mem) VSTPluginFilter(library, chunkData, paramMap, parallel);
 			}
 		}
 	}
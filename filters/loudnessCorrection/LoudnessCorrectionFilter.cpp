@@ -20,8 +20,8 @@
 #include "stdafx.h"
 #include "LoudnessCorrectionFilter.h"
 #include "helpers/MemoryHelper.h"
-
-#include "VolumeController.h"
+#include "helpers/SimdHelper.h"
+#include <algorithm>
 
 #ifndef _USE_MATH_DEFINES
 #define _USE_MATH_DEFINES
@@ -39,221 +39,217 @@ LoudnessCorrectionFilter::LoudnessCorrectionFilter(const FilterParameters& fPara
 	{
 		_parameters.attenuation = 0.0;
 	}
-	InitializeCriticalSection(&_parameterUpdateSection);
+	_curve = NULL;
 }
 
 LoudnessCorrectionFilter::~LoudnessCorrectionFilter()
 {
-	if (_stopParameterUpdateThreadEvent)
+	if (_curve != NULL)
 	{
-		SetEvent(_stopParameterUpdateThreadEvent);
+		LoudnessCurve::release(_curve);
 	}
-	WaitForSingleObject(_parameterUpdateThreadHandle, INFINITE);
-	DeleteCriticalSection(&_parameterUpdateSection);
-	CloseHandle(_stopParameterUpdateThreadEvent);
-	CloseHandle(_parameterUpdateThreadHandle);
-	CloseHandle(_parameterchangedEvent);
 }
 
 std::vector<std::wstring> LoudnessCorrectionFilter::initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames)
 {
 	this->_channelCount = channelNames.size();
-	_lowShelfBiquads.resize(_channelCount);
-	_highShelfBiquads.resize(_channelCount);
 	_sampleRate = sampleRate;
-	_attFactor = 1.0;
-	_neutral = true;
+	// long enough to avoid zipper noise, short enough to follow the volume slider
+	_rampLength = std::max(1u, (unsigned)(sampleRate * 0.02f));
 
-	double freqLS = 75, qLS = 1, gainLS = 0;
-	double freqHS = 10000, qHS = 1, gainHS = 0;
-	VolumeController VolumeController;
-	double vol;
-	HRESULT res = VolumeController.getVolume(vol);
-	if (res == S_OK)
-	{
-		double preAmp;
-		getLShelfParamter(vol, freqLS, qLS, gainLS, preAmp);
-		_attFactor = exp(preAmp / 6 * log(2));
-		getHShelfParamter(vol + (double)preAmp, freqHS, qHS, gainHS);
-		_neutral = std::max<double>(std::abs(gainLS), std::abs(gainHS)) < 0.2 ? true : false;
-	}
+	_x1.assign(_channelCount, 0.0);
+	_x2.assign(_channelCount, 0.0);
+	_m1.assign(_channelCount, 0.0);
+	_m2.assign(_channelCount, 0.0);
+	_hsX1.assign(_channelCount, 0.0);
+	_hsX2.assign(_channelCount, 0.0);
+	_y1.assign(_channelCount, 0.0);
+	_y2.assign(_channelCount, 0.0);
+	_channelCoefficients.assign(COEFFICIENT_COUNT * _channelCount, 0.0);
+	_channelSteps.assign(COEFFICIENT_COUNT * _channelCount, 0.0);
 
-	for (unsigned i = 0; i < _channelCount; i++)
+	if (_curve != NULL)
 	{
-		_lowShelfBiquads[i] = BiQuad(BiQuad::LOW_SHELF, gainLS, freqLS, _sampleRate, qLS, false);
-		_highShelfBiquads[i] = BiQuad(BiQuad::HIGH_SHELF, gainHS, freqHS, _sampleRate, qHS, false);
+		LoudnessCurve::release(_curve);
 	}
-	_stopParameterUpdateThreadEvent = CreateEvent(NULL, true, false, NULL);
-	_parameterchangedEvent = CreateEvent(NULL, true, false, NULL);
-	_parameterUpdateThreadHandle = CreateThread(NULL, 0, &parameterUpdateThread, this, 0, NULL);
+	// receives the coefficients for the current volume right away if it is available
+	_curve = LoudnessCurve::acquire(_parameters.referenceLevel, _parameters.referenceOffset, _parameters.attenuation, _sampleRate);
+	upDateBiquadCoefficients(false);
 
 	return channelNames;
 }
 
-void LoudnessCorrectionFilter::getLShelfParamter(const double& volume, double& frequence, double& q, double& gain, double& preAmp)
-{
-	frequence = 75;
-	q = 0.52;
-	double volDiff = _parameters.referenceLevel - _parameters.referenceOffset - volume;
-	if (volDiff > 0)
-	{
-		// old: gain=volDiff*0.55*_parameters.attenuation;
-		gain = volDiff * 0.55 / (1 - 0.55) * _parameters.attenuation;
-		preAmp = -gain;
-	}
-	else if (volDiff < 0)
-	{
-		preAmp = 0.0;
-		gain = volDiff * 0.55 * exp(volDiff / 90.0) * _parameters.attenuation;
-	}
-	else
-	{
-		gain = 0;
-	}
-}
-void LoudnessCorrectionFilter::getHShelfParamter(const double& volume, double& frequence, double& q, double& gain)
+#pragma AVRT_CODE_BEGIN
+void LoudnessCorrectionFilter::process(double** output, double** input, unsigned frameCount)
 {
-	frequence = 10000;
-	q = 0.9;
-	double volDiff = _parameters.referenceLevel - _parameters.referenceOffset - volume;
-	if (volDiff > 0)
-	{
-		gain = volDiff * 0.225 * exp(-volDiff / 100.0) * _parameters.attenuation;
-	}
-	else if (volDiff < 0)
+	if (_parameters.state == false)
 	{
-		gain = volDiff * 0.175 * exp(volDiff / 80.0) * _parameters.attenuation;
+		for (unsigned int j = 0; j < frameCount; j++)
+		{
+			for (unsigned i = 0; i < _channelCount; i++)
+			{
+				output[i][j] = input[i][j];
+			}
+		}
+		output = input;
+		return;
 	}
-	else
+	if (_curve->getCoefficients().getVersion() != _coefficientVersion)
 	{
-		gain = 0;
+		upDateBiquadCoefficients(true);
 	}
-}
 
-unsigned long __stdcall LoudnessCorrectionFilter::parameterUpdateThread(void* parameter)
-{
-	LoudnessCorrectionFilter* lCorrection = (LoudnessCorrectionFilter*)parameter;
-	VolumeController VolumeController;
-	double volOld(lCorrection->_parameters.referenceLevel);
-	double vol(lCorrection->_parameters.referenceLevel);
-	double freqLS, qLS, gainLS, preAmp;
-	double freqHS, qHS, gainHS;
-	HRESULT res;
-	while (WaitForSingleObject(lCorrection->_stopParameterUpdateThreadEvent, 0) == WAIT_TIMEOUT)
+	// if there is nearly no loudness correction necessary => set output=input to achive best quality
+	if (_neutral && _rampRemaining == 0)
 	{
-		if (WaitForSingleObject(lCorrection->_parameterchangedEvent, 0) == WAIT_TIMEOUT)
-		{
-			res = VolumeController.getVolume(vol);
-			if (res == S_OK)
-			{
-				if (vol != volOld)
-				{
-					lCorrection->getLShelfParamter(vol, freqLS, qLS, gainLS, preAmp);
-					lCorrection->_attFactor = exp(preAmp / 6 * log(2));
-					lCorrection->getHShelfParamter(vol + (double)preAmp, freqHS, qHS, gainHS);
-					lCorrection->upDateBiquadCoefficients(freqHS, qHS, gainHS, true);
-					lCorrection->upDateBiquadCoefficients(freqLS, qLS, gainLS, false);
-					volOld = vol;
+		bypass(output, input, frameCount);
+		return;
+	}
 
-					lCorrection->_neutralUpDate = std::max<double>(std::abs(gainLS), std::abs(gainHS)) < 0.2 ? true : false;
+#if !defined(_M_ARM64)
+	unsigned old_mxcsr = _mm_getcsr();
+	_mm_setcsr(old_mxcsr | 0x8040);
+#endif
 
-					SetEvent(lCorrection->_parameterchangedEvent);
-				}
-			}
+	// the high shelf runs in place on the output of the low shelf
+	unsigned rampFrames = std::min(_rampRemaining, frameCount);
+	const double* c = _channelCoefficients.data();
+	const double* s = _channelSteps.data();
+	size_t n = _channelCount;
+	BiQuadBank lowShelf = {c + LS_B0 * n, c + LS_A1 * n, c + LS_A2 * n, c + LS_B1 * n, c + LS_B2 * n,
+		_x1.data(), _x2.data(), _m1.data(), _m2.data(),
+		rampFrames, s + LS_B0 * n, s + LS_A1 * n, s + LS_A2 * n, s + LS_B1 * n, s + LS_B2 * n};
+	BiQuadBank highShelf = {c + HS_B0 * n, c + HS_A1 * n, c + HS_A2 * n, c + HS_B1 * n, c + HS_B2 * n,
+		_hsX1.data(), _hsX2.data(), _y1.data(), _y2.data(),
+		rampFrames, s + HS_B0 * n, s + HS_A1 * n, s + HS_A2 * n, s + HS_B1 * n, s + HS_B2 * n};
+	const SimdKernels& kernels = SimdHelper::getKernels();
+	kernels.biQuad(lowShelf, output, input, frameCount, 0, (unsigned)n);
+	kernels.biQuad(highShelf, output, output, frameCount, 0, (unsigned)n);
+
+	if (rampFrames > 0)
+	{
+		_rampRemaining -= rampFrames;
+		for (int k = 0; k < COEFFICIENT_COUNT; k++)
+		{
+			if (_rampRemaining == 0)
+				_coefficients[k] = _targetCoefficients[k];
+			else
+				_coefficients[k] += rampFrames * _coefficientSteps[k];
 		}
-		Sleep(10);
-		// ==========================
+		updateChannelCoefficients();
 	}
-	return 0;
+
+#if !defined(_M_ARM64)
+	_mm_setcsr(old_mxcsr);
+#endif
 }
 
-bool LoudnessCorrectionFilter::upDateNeutral()
+void LoudnessCorrectionFilter::reset()
 {
-	return _neutralUpDate;
+	std::fill(_x1.begin(), _x1.end(), 0.0);
+	std::fill(_x2.begin(), _x2.end(), 0.0);
+	std::fill(_m1.begin(), _m1.end(), 0.0);
+	std::fill(_m2.begin(), _m2.end(), 0.0);
+	std::fill(_hsX1.begin(), _hsX1.end(), 0.0);
+	std::fill(_hsX2.begin(), _hsX2.end(), 0.0);
+	std::fill(_y1.begin(), _y1.end(), 0.0);
+	std::fill(_y2.begin(), _y2.end(), 0.0);
+
+	// a ramp in progress has no signal left to smooth
+	if (_rampRemaining > 0)
+	{
+		for (int k = 0; k < COEFFICIENT_COUNT; k++)
+		{
+			_coefficients[k] = _targetCoefficients[k];
+			_coefficientSteps[k] = 0.0;
+		}
+		_rampRemaining = 0;
+		updateChannelCoefficients();
+	}
 }
 
-#pragma AVRT_CODE_BEGIN
-void LoudnessCorrectionFilter::process(double** output, double** input, unsigned frameCount)
+void LoudnessCorrectionFilter::upDateBiquadCoefficients(bool ramp)
 {
-	if (_parameters.state == false)
+	// copies a consistent set of coefficients without blocking the volume monitor
+	LoudnessCoefficients coefficients;
+	_coefficientVersion = _curve->getCoefficients().read(coefficients);
+
+	double* t = _targetCoefficients;
+	t[LS_A1] = coefficients.aLS[2];
+	t[LS_A2] = coefficients.aLS[3];
+	t[HS_A1] = coefficients.aHS[2];
+	t[HS_A2] = coefficients.aHS[3];
+	if (coefficients.neutral)
+	{
+		// numerators equal to the denominators, so the ramp ends in a transparent filter that can be bypassed
+		t[LS_B0] = 1.0;
+		t[LS_B1] = t[LS_A1];
+		t[LS_B2] = t[LS_A2];
+		t[HS_B0] = 1.0;
+		t[HS_B1] = t[HS_A1];
+		t[HS_B2] = t[HS_A2];
+	}
+	else
 	{
-		for (unsigned int j = 0; j < frameCount; j++)
-		{
-			for (unsigned i = 0; i < _channelCount; i++)
-			{
-				output[i][j] = input[i][j];
-			}
-		}
-		output = input;
-		return;
+		// the attenuation only scales the input of the high shelf, so it can be moved into the low shelf numerator
+		t[LS_B0] = coefficients.a0LS * coefficients.attFactor;
+		t[LS_B1] = coefficients.aLS[0] * coefficients.attFactor;
+		t[LS_B2] = coefficients.aLS[1] * coefficients.attFactor;
+		t[HS_B0] = coefficients.a0HS;
+		t[HS_B1] = coefficients.aHS[0];
+		t[HS_B2] = coefficients.aHS[1];
 	}
-	if (WaitForSingleObject(_parameterchangedEvent, 0) == WAIT_OBJECT_0)
+	_neutral = coefficients.neutral;
+
+	// the stable denominators form a convex set, so every intermediate filter of the ramp is stable as well
+	for (int k = 0; k < COEFFICIENT_COUNT; k++)
 	{
-		for (unsigned i = 0; i < _channelCount; i++)
+		if (ramp)
 		{
-			_lowShelfBiquads[i].setCoefficients(_aLS, _a0LS);
-			_highShelfBiquads[i].setCoefficients(_aHS, _a0HS);
+			_coefficientSteps[k] = (t[k] - _coefficients[k]) / _rampLength;
 		}
-		_neutral = upDateNeutral();
-		ResetEvent(_parameterchangedEvent);
-	}
-	for (unsigned i = 0; i < _channelCount; i++)
-	{
-		double* inputChannel = input[i];
-		double* outputChannel = output[i];
-		for (unsigned j = 0; j < frameCount; j++)
+		else
 		{
-			_tempResult = _lowShelfBiquads[i].process(inputChannel[j]);
-			_lowShelfBiquads[i].removeDenormals();
-			_tempResult *= _attFactor;
-			outputChannel[j] = (double)_highShelfBiquads[i].process(_tempResult);
-			_highShelfBiquads[i].removeDenormals();
-
-			// if there is nearly no loudness correction necessary => set output=input to achive best quality
-			if (_neutral)
-			{
-				outputChannel[j] = inputChannel[j];
-			}
+			_coefficients[k] = t[k];
+			_coefficientSteps[k] = 0.0;
 		}
 	}
+	_rampRemaining = ramp ? _rampLength : 0;
+	updateChannelCoefficients();
 }
 
-void LoudnessCorrectionFilter::upDateBiquadCoefficients(const double& freq, const double& bandwidthOrQOrS, const double& dbGain, bool highshelf)
+void LoudnessCorrectionFilter::updateChannelCoefficients()
 {
-	double A;
-	A = pow(10, dbGain / 40);
-
-	double omega = 2 * M_PI * freq / _sampleRate;
-	double sn = sin(omega);
-	double cs = cos(omega);
-	double alpha;
-	double beta = -1;
-
-	alpha = sn / 2 * sqrt((A + 1 / A) * (1 / bandwidthOrQOrS - 1) + 2);
-	beta = 2 * sqrt(A) * alpha;
-
-	double a0;
-	TryEnterCriticalSection(&_parameterUpdateSection);
-	if (highshelf)
+	for (int k = 0; k < COEFFICIENT_COUNT; k++)
 	{
-		a0 = (A + 1) - (A - 1) * cs + beta;
-		_a0HS = (double)((A * ((A + 1) + (A - 1) * cs + beta)) / a0);
-		_aHS[0] = (double)((-2 * A * ((A - 1) + (A + 1) * cs)) / a0);
-		_aHS[1] = (double)((A * ((A + 1) + (A - 1) * cs - beta)) / a0);
-
-		_aHS[2] = (double)((2 * ((A - 1) - (A + 1) * cs)) / a0);
-		_aHS[3] = (double)(((A + 1) - (A - 1) * cs - beta) / a0);
+		std::fill(_channelCoefficients.begin() + k * _channelCount, _channelCoefficients.begin() + (k + 1) * _channelCount, _coefficients[k]);
+		std::fill(_channelSteps.begin() + k * _channelCount, _channelSteps.begin() + (k + 1) * _channelCount, _coefficientSteps[k]);
 	}
-	else
+}
+
+void LoudnessCorrectionFilter::bypass(double** output, double** input, unsigned frameCount)
+{
+	for (unsigned i = 0; i < _channelCount; i++)
 	{
-		a0 = (A + 1) + (A - 1) * cs + beta;
-		_a0LS = (double)((A * ((A + 1) - (A - 1) * cs + beta)) / a0);
-		_aLS[0] = (double)((2 * A * ((A - 1) - (A + 1) * cs)) / a0);
-		_aLS[1] = (double)((A * ((A + 1) - (A - 1) * cs - beta)) / a0);
+		double* inputChannel = input[i];
+		double* outputChannel = output[i];
+		if (outputChannel != inputChannel)
+			memcpy(outputChannel, inputChannel, frameCount * sizeof(double));
 
-		_aLS[2] = (double)((-2 * ((A - 1) + (A + 1) * cs)) / a0);
-		_aLS[3] = (double)(((A + 1) + (A - 1) * cs - beta) / a0);
+		// keep the state of a transparent filter, so processing can resume without a discontinuity
+		if (frameCount >= 2)
+		{
+			_x1[i] = inputChannel[frameCount - 1];
+			_x2[i] = inputChannel[frameCount - 2];
+		}
+		else if (frameCount == 1)
+		{
+			_x2[i] = _x1[i];
+			_x1[i] = inputChannel[0];
+		}
+		_m1[i] = _hsX1[i] = _y1[i] = _x1[i];
+		_m2[i] = _hsX2[i] = _y2[i] = _x2[i];
 	}
-	LeaveCriticalSection(&_parameterUpdateSection);
 }
+
 #pragma AVRT_CODE_END
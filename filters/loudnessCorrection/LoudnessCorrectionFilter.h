@@ -20,8 +20,12 @@
 #pragma once
 
 #include "ParameterArchive.h"
+#include "LoudnessCurve.h"
 #include <IFilter.h>
 #include <filters/BiQuad.h>
+#ifndef _M_ARM64
+#include <immintrin.h>
+#endif
 
 #include <regex>
 #include <sstream>
@@ -79,32 +83,43 @@ private:
 	virtual bool getInPlace() {return true;}
 	virtual std::vector<std::wstring> initialize(float sampleRate, unsigned maxFrameCount, std::vector<std::wstring> channelNames);
 	virtual void process(double** output, double** input, unsigned frameCount);
+	virtual void reset();
 
 private:
-	void getLShelfParamter(const double& volume, double& frequence, double& q, double& gain, double& preAmp);
-	void getHShelfParamter(const double& volume, double& frequence, double& q, double& gain);
-	void upDateBiquadCoefficients(const double& freq, const double& bandwidthOrQOrS, const double& dbGain, bool highshelf);
-	bool upDateNeutral();
+	// coefficients shared by all channels, the low shelf includes the attenuation
+	enum Coefficient
+	{
+		LS_B0, LS_B1, LS_B2, LS_A1, LS_A2,
+		HS_B0, HS_B1, HS_B2, HS_A1, HS_A2,
+		COEFFICIENT_COUNT
+	};
+
+	void upDateBiquadCoefficients(bool ramp);
+	void updateChannelCoefficients();
+	void bypass(double** output, double** input, unsigned frameCount);
 
-	void* _parameterUpdateThreadHandle;
-	static unsigned long __stdcall parameterUpdateThread(void* parameter);
-	void* _stopParameterUpdateThreadEvent;
-	void* _parameterchangedEvent;
-	CRITICAL_SECTION _parameterUpdateSection;
+	// shared with all filters using the same parameters, updated on volume changes
+	LoudnessCurve* _curve;
+	unsigned _coefficientVersion;
 
 	FilterParameters _parameters;
 	size_t _channelCount;
 	float _sampleRate;
-	double _attFactor;
-	std::vector<BiQuad> _lowShelfBiquads;
-	std::vector<BiQuad> _highShelfBiquads;
+
+	// coefficients move linearly towards the target over _rampLength samples after a volume change
+	double _coefficients[COEFFICIENT_COUNT];
+	double _targetCoefficients[COEFFICIENT_COUNT];
+	double _coefficientSteps[COEFFICIENT_COUNT];
+	unsigned _rampLength;
+	unsigned _rampRemaining;
+
+	// _coefficients and _coefficientSteps repeated for each channel as the biquad kernel expects them, at k * _channelCount + i
+	std::vector<double> _channelCoefficients;
+	std::vector<double> _channelSteps;
+
+	// SoA state of all channels, m is the output of the low shelf and hsX its copy as the input of the high shelf
+	std::vector<double> _x1, _x2, _m1, _m2, _hsX1, _hsX2, _y1, _y2;
 
 	bool _neutral;
-	bool _neutralUpDate;
-	double _tempResult;
-	double _aLS[4];
-	double _a0LS;
-	double _aHS[4];
-	double _a0HS;
 };
 #pragma AVRT_VTABLES_END
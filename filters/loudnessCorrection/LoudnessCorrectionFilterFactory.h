@@ -28,5 +28,6 @@ class LoudnessCorrectionFilterFactory : public IFilterFactory
 {
 public:
 	LoudnessCorrectionFilterFactory();
+	virtual std::vector<std::wstring> getCommands() {return {L"LoudnessCorrection"};}
 	virtual std::vector<IFilter*> createFilter(const std::wstring& configPath, std::wstring& command, std::wstring& parameters);
 };
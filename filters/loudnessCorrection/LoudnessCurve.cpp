@@ -0,0 +1,136 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "filters/BiQuad.h"
+#include "LoudnessCurve.h"
+
+using namespace std;
+
+static mutex curvesMutex;
+static vector<LoudnessCurve*> curves;
+
+LoudnessCurve* LoudnessCurve::acquire(float referenceLevel, float referenceOffset, float attenuation, float sampleRate)
+{
+	lock_guard<mutex> lock(curvesMutex);
+
+	for (LoudnessCurve* curve : curves)
+	{
+		if (curve->referenceLevel == referenceLevel && curve->referenceOffset == referenceOffset
+			&& curve->attenuation == attenuation && curve->sampleRate == sampleRate)
+		{
+			curve->useCount++;
+			return curve;
+		}
+	}
+
+	LoudnessCurve* curve = new LoudnessCurve(referenceLevel, referenceOffset, attenuation, sampleRate);
+	curves.push_back(curve);
+	VolumeMonitor::getInstance().addListener(curve);
+
+	return curve;
+}
+
+void LoudnessCurve::release(LoudnessCurve* curve)
+{
+	lock_guard<mutex> lock(curvesMutex);
+
+	if (--curve->useCount == 0)
+	{
+		VolumeMonitor::getInstance().removeListener(curve);
+		curves.erase(remove(curves.begin(), curves.end(), curve), curves.end());
+		delete curve;
+	}
+}
+
+LoudnessCurve::LoudnessCurve(float referenceLevel, float referenceOffset, float attenuation, float sampleRate)
+	: referenceLevel(referenceLevel), referenceOffset(referenceOffset), attenuation(attenuation), sampleRate(sampleRate)
+{
+	useCount = 1;
+
+	// no correction until the volume is known
+	LoudnessCoefficients c;
+	BiQuad(BiQuad::LOW_SHELF, 0, 75, sampleRate, 1, true).getCoefficients(c.aLS, c.a0LS);
+	BiQuad(BiQuad::HIGH_SHELF, 0, 10000, sampleRate, 1, true).getCoefficients(c.aHS, c.a0HS);
+	c.attFactor = 1.0;
+	c.neutral = true;
+	coefficients.write(c);
+}
+
+void LoudnessCurve::volumeChanged(double volume)
+{
+	double freqLS, qLS, gainLS, preAmp;
+	double freqHS, qHS, gainHS;
+	getLShelfParamter(volume, freqLS, qLS, gainLS, preAmp);
+	getHShelfParamter(volume + preAmp, freqHS, qHS, gainHS);
+
+	LoudnessCoefficients c;
+	BiQuad(BiQuad::LOW_SHELF, gainLS, freqLS, sampleRate, qLS, true).getCoefficients(c.aLS, c.a0LS);
+	BiQuad(BiQuad::HIGH_SHELF, gainHS, freqHS, sampleRate, qHS, true).getCoefficients(c.aHS, c.a0HS);
+	c.attFactor = exp(preAmp / 6 * log(2));
+	c.neutral = max(abs(gainLS), abs(gainHS)) < 0.2;
+
+	// called with the lock of the VolumeMonitor held, so there is only one writer at a time
+	coefficients.write(c);
+}
+
+void LoudnessCurve::getLShelfParamter(const double& volume, double& frequence, double& q, double& gain, double& preAmp)
+{
+	frequence = 75;
+	q = 0.52;
+	preAmp = 0.0;
+	double volDiff = referenceLevel - referenceOffset - volume;
+	if (volDiff > 0)
+	{
+		// old: gain=volDiff*0.55*attenuation;
+		gain = volDiff * 0.55 / (1 - 0.55) * attenuation;
+		preAmp = -gain;
+	}
+	else if (volDiff < 0)
+	{
+		gain = volDiff * 0.55 * exp(volDiff / 90.0) * attenuation;
+	}
+	else
+	{
+		gain = 0;
+	}
+}
+
+void LoudnessCurve::getHShelfParamter(const double& volume, double& frequence, double& q, double& gain)
+{
+	frequence = 10000;
+	q = 0.9;
+	double volDiff = referenceLevel - referenceOffset - volume;
+	if (volDiff > 0)
+	{
+		gain = volDiff * 0.225 * exp(-volDiff / 100.0) * attenuation;
+	}
+	else if (volDiff < 0)
+	{
+		gain = volDiff * 0.175 * exp(volDiff / 80.0) * attenuation;
+	}
+	else
+	{
+		gain = 0;
+	}
+}
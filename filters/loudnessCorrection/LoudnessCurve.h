@@ -0,0 +1,60 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include "helpers/SeqLock.h"
+#include "VolumeMonitor.h"
+
+struct LoudnessCoefficients
+{
+	double aLS[4];
+	double a0LS;
+	double aHS[4];
+	double a0HS;
+	double attFactor;
+	// nearly no correction necessary, so the input can be passed through unchanged
+	bool neutral;
+};
+
+// Shelf filter coefficients of the loudness correction for the current master volume. They are computed once
+// per volume change and shared by all filters with the same parameters and sample rate.
+class LoudnessCurve : private IVolumeListener
+{
+public:
+	static LoudnessCurve* acquire(float referenceLevel, float referenceOffset, float attenuation, float sampleRate);
+	static void release(LoudnessCurve* curve);
+
+	const SeqLock<LoudnessCoefficients>& getCoefficients() const {return coefficients;}
+
+private:
+	LoudnessCurve(float referenceLevel, float referenceOffset, float attenuation, float sampleRate);
+
+	void volumeChanged(double volume) override;
+	void getLShelfParamter(const double& volume, double& frequence, double& q, double& gain, double& preAmp);
+	void getHShelfParamter(const double& volume, double& frequence, double& q, double& gain);
+
+	float referenceLevel;
+	float referenceOffset;
+	float attenuation;
+	float sampleRate;
+	unsigned useCount;
+
+	SeqLock<LoudnessCoefficients> coefficients;
+};
@@ -25,24 +25,49 @@ VolumeController::VolumeController()
 {
 	HRESULT hr;
 	CoInitialize(NULL);
+	_endpointVolume = NULL;
+	_listener = NULL;
+	_refCount = 1;
+	_minVol = 0.0f;
+	_maxVol = 0.0f;
+
 	IMMDeviceEnumerator* deviceEnumerator = NULL;
 	hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_INPROC_SERVER, __uuidof(IMMDeviceEnumerator), (LPVOID*)&deviceEnumerator);
-	IMMDevice* defaultDevice = NULL;
+	if (FAILED(hr))
+		return;
 
+	IMMDevice* defaultDevice = NULL;
 	hr = deviceEnumerator->GetDefaultAudioEndpoint(eRender, eMultimedia,  &defaultDevice);
 	deviceEnumerator->Release();
 	deviceEnumerator = NULL;
+	if (FAILED(hr))
+		return;
 
-	_endpointVolume = NULL;
 	hr = defaultDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_INPROC_SERVER, NULL, (LPVOID*)&_endpointVolume);
 	defaultDevice->Release();
 	defaultDevice = NULL;
+	if (FAILED(hr))
+	{
+		_endpointVolume = NULL;
+		return;
+	}
+
 	float inkrement;
 	_endpointVolume->GetVolumeRange(&_minVol, &_maxVol, &inkrement);
 }
 
+VolumeController::~VolumeController()
+{
+	stop();
+	if (_endpointVolume != NULL)
+		_endpointVolume->Release();
+}
+
 HRESULT VolumeController::getVolume(double& currentVolume)
 {
+	if (_endpointVolume == NULL)
+		return E_FAIL;
+
 	float vol;
 	HRESULT res = _endpointVolume->GetMasterVolumeLevel(&vol);
 	currentVolume = vol;
@@ -51,7 +76,65 @@ HRESULT VolumeController::getVolume(double& currentVolume)
 
 HRESULT VolumeController::setVolume(double volume)
 {
+	if (_endpointVolume == NULL)
+		return E_FAIL;
+
 	volume = fmin(volume, _maxVol);
 	volume = fmax(volume, _minVol);
 	return _endpointVolume->SetMasterVolumeLevel(float(volume), NULL);
 }
+
+HRESULT VolumeController::start(IVolumeListener* listener)
+{
+	if (_endpointVolume == NULL)
+		return E_FAIL;
+
+	_listener = listener;
+	HRESULT hr = _endpointVolume->RegisterControlChangeNotify(this);
+	if (FAILED(hr))
+		_listener = NULL;
+	return hr;
+}
+
+void VolumeController::stop()
+{
+	if (_listener != NULL)
+	{
+		_endpointVolume->UnregisterControlChangeNotify(this);
+		_listener = NULL;
+	}
+}
+
+ULONG STDMETHODCALLTYPE VolumeController::AddRef()
+{
+	return InterlockedIncrement(&_refCount);
+}
+
+ULONG STDMETHODCALLTYPE VolumeController::Release()
+{
+	return InterlockedDecrement(&_refCount);
+}
+
+HRESULT STDMETHODCALLTYPE VolumeController::QueryInterface(REFIID riid, void** ppvInterface)
+{
+	if (riid == IID_IUnknown || riid == __uuidof(IAudioEndpointVolumeCallback))
+	{
+		AddRef();
+		*ppvInterface = (IAudioEndpointVolumeCallback*)this;
+		return S_OK;
+	}
+
+	*ppvInterface = NULL;
+	return E_NOINTERFACE;
+}
+
+HRESULT STDMETHODCALLTYPE VolumeController::OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA pNotify)
+{
+	// the notification only contains the scalar volume, but the loudness correction works in dB
+	double volume;
+	IVolumeListener* listener = _listener;
+	if (listener != NULL && getVolume(volume) == S_OK)
+		listener->volumeChanged(volume);
+
+	return S_OK;
+}
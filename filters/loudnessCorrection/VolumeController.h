@@ -23,14 +23,30 @@
 #include <windows.h>
 #include <EndpointVolume.h>
 
-class VolumeController
+#include "VolumeMonitor.h"
+
+// Master volume of the default render endpoint, reporting changes through IAudioEndpointVolumeCallback
+class VolumeController : public IVolumeSource, private IAudioEndpointVolumeCallback
 {
 public:
 	VolumeController();
-	HRESULT getVolume(double& currentVolume);
+	virtual ~VolumeController();
+	HRESULT getVolume(double& currentVolume) override;
 	HRESULT setVolume(double volume);
+
+	HRESULT start(IVolumeListener* listener) override;
+	void stop() override;
+
 private:
+	// IUnknown, the object is owned by the creator, so the reference count does not control its lifetime
+	ULONG STDMETHODCALLTYPE AddRef() override;
+	ULONG STDMETHODCALLTYPE Release() override;
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvInterface) override;
+	HRESULT STDMETHODCALLTYPE OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA pNotify) override;
+
 	IAudioEndpointVolume* _endpointVolume;
+	IVolumeListener* _listener;
+	LONG _refCount;
 	float _minVol;
 	float _maxVol;
 };
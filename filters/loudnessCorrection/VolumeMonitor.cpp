@@ -0,0 +1,186 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+
+#include "helpers/LogHelper.h"
+#include "VolumeController.h"
+#include "VolumeMonitor.h"
+
+using namespace std;
+
+ManualVolumeSource::ManualVolumeSource(double volume)
+	: volume(volume), listener(NULL)
+{
+}
+
+HRESULT ManualVolumeSource::getVolume(double& volume)
+{
+	volume = this->volume.load();
+	return S_OK;
+}
+
+HRESULT ManualVolumeSource::start(IVolumeListener* listener)
+{
+	this->listener.store(listener);
+	return S_OK;
+}
+
+void ManualVolumeSource::stop()
+{
+	listener.store(NULL);
+}
+
+void ManualVolumeSource::setVolume(double volume)
+{
+	this->volume.store(volume);
+	IVolumeListener* l = listener.load();
+	if (l != NULL)
+		l->volumeChanged(volume);
+}
+
+VolumeMonitor& VolumeMonitor::getInstance()
+{
+	// never destroyed, as the endpoint source must not be released while the DLL is unloaded
+	static VolumeMonitor* instance = new VolumeMonitor();
+	return *instance;
+}
+
+VolumeMonitor::VolumeMonitor()
+{
+	InitializeCriticalSection(&sourceSection);
+	InitializeCriticalSection(&section);
+	source = NULL;
+	endpointSource = false;
+	sourceStarted = false;
+	volumeValid = false;
+	lastVolume = 0.0;
+}
+
+void VolumeMonitor::setSource(IVolumeSource* source)
+{
+	EnterCriticalSection(&sourceSection);
+	stopSource();
+	delete this->source;
+	this->source = source;
+	endpointSource = false;
+
+	EnterCriticalSection(&section);
+	bool hasListeners = !listeners.empty();
+	LeaveCriticalSection(&section);
+
+	if (hasListeners)
+		startSource();
+	LeaveCriticalSection(&sourceSection);
+}
+
+void VolumeMonitor::addListener(IVolumeListener* listener)
+{
+	EnterCriticalSection(&sourceSection);
+	if (!sourceStarted)
+		startSource();
+
+	EnterCriticalSection(&section);
+	listeners.push_back(listener);
+	if (volumeValid)
+		listener->volumeChanged(lastVolume);
+	LeaveCriticalSection(&section);
+	LeaveCriticalSection(&sourceSection);
+}
+
+void VolumeMonitor::removeListener(IVolumeListener* listener)
+{
+	EnterCriticalSection(&sourceSection);
+	EnterCriticalSection(&section);
+	listeners.erase(remove(listeners.begin(), listeners.end(), listener), listeners.end());
+	bool hasListeners = !listeners.empty();
+	LeaveCriticalSection(&section);
+
+	if (!hasListeners)
+	{
+		// no notification may call into the DLL anymore once it is unloaded
+		stopSource();
+		if (endpointSource)
+		{
+			delete source;
+			source = NULL;
+			endpointSource = false;
+		}
+	}
+	LeaveCriticalSection(&sourceSection);
+}
+
+void VolumeMonitor::volumeChanged(double volume)
+{
+	EnterCriticalSection(&section);
+	// the endpoint also reports mute and channel volume changes
+	if (!volumeValid || volume != lastVolume)
+	{
+		lastVolume = volume;
+		volumeValid = true;
+		for (IVolumeListener* listener : listeners)
+			listener->volumeChanged(volume);
+	}
+	LeaveCriticalSection(&section);
+}
+
+void VolumeMonitor::startSource()
+{
+	if (source == NULL)
+	{
+		source = new VolumeController();
+		endpointSource = true;
+	}
+
+	double volume;
+	bool valid = source->getVolume(volume) == S_OK;
+	EnterCriticalSection(&section);
+	volumeValid = valid;
+	lastVolume = valid ? volume : 0.0;
+	LeaveCriticalSection(&section);
+
+	HRESULT hr = source->start(this);
+	if (FAILED(hr))
+	{
+		// tried again with the next listener, for the endpoint source also with the then current default endpoint
+		LogF(L"Could not register for volume change notifications (error %08x)", hr);
+		if (endpointSource)
+		{
+			delete source;
+			source = NULL;
+			endpointSource = false;
+		}
+		return;
+	}
+	sourceStarted = true;
+}
+
+void VolumeMonitor::stopSource()
+{
+	if (sourceStarted)
+	{
+		source->stop();
+		sourceStarted = false;
+	}
+
+	EnterCriticalSection(&section);
+	volumeValid = false;
+	LeaveCriticalSection(&section);
+}
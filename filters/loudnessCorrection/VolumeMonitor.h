@@ -0,0 +1,97 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+class IVolumeListener
+{
+public:
+	virtual ~IVolumeListener() {}
+
+	// called whenever the master volume (in dB) changes, on the thread of the volume source
+	virtual void volumeChanged(double volume) = 0;
+};
+
+class IVolumeSource
+{
+public:
+	virtual ~IVolumeSource() {}
+
+	virtual HRESULT getVolume(double& volume) = 0;
+	// reports every volume change to the listener until stop is called
+	virtual HRESULT start(IVolumeListener* listener) = 0;
+	virtual void stop() = 0;
+};
+
+// Volume source that reports the volume passed to setVolume, to drive the loudness correction without an audio device
+class ManualVolumeSource : public IVolumeSource
+{
+public:
+	ManualVolumeSource(double volume = 0.0);
+
+	HRESULT getVolume(double& volume) override;
+	HRESULT start(IVolumeListener* listener) override;
+	void stop() override;
+	void setVolume(double volume);
+
+private:
+	std::atomic<double> volume;
+	std::atomic<IVolumeListener*> listener;
+};
+
+// Watches the master volume of the default render endpoint once for the whole process and
+// forwards changes to all listeners. The volume source is started with the first listener and stopped after the last
+// one, when the endpoint source is also released, so the next listener follows the then current default endpoint.
+class VolumeMonitor : private IVolumeListener
+{
+public:
+	static VolumeMonitor& getInstance();
+
+	// replaces the source of volume changes, taking ownership of it; NULL restores the default endpoint source
+	void setSource(IVolumeSource* source);
+	// the listener is called with the current volume before this returns, if the volume is available
+	void addListener(IVolumeListener* listener);
+	// after this returns, the listener is not called anymore
+	void removeListener(IVolumeListener* listener);
+
+private:
+	VolumeMonitor();
+
+	void volumeChanged(double volume) override;
+	void startSource();
+	void stopSource();
+
+	// sourceSection serializes starting and stopping the source, section protects the listeners and the volume.
+	// The source is only started and stopped without holding section, as stopping may wait for a notification
+	// that is waiting for section.
+	CRITICAL_SECTION sourceSection;
+	CRITICAL_SECTION section;
+	std::vector<IVolumeListener*> listeners;
+	IVolumeSource* source;
+	// whether source is the endpoint source created by startSource instead of one passed to setSource
+	bool endpointSource;
+	bool sourceStarted;
+	bool volumeValid;
+	double lastVolume;
+};
@@ -0,0 +1,238 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "LogHelper.h"
+#include "StringHelper.h"
+#include "ConfigFile.h"
+
+using namespace std;
+
+shared_ptr<const ConfigFile> ConfigFile::load(const wstring& path, const shared_ptr<const ConfigFile>& cached)
+{
+	HANDLE hFile = INVALID_HANDLE_VALUE;
+	HANDLE changeHandle = NULL;
+	while (true)
+	{
+		hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile != INVALID_HANDLE_VALUE)
+			break;
+
+		DWORD error = GetLastError();
+		if (error != ERROR_SHARING_VIOLATION)
+		{
+			LogFStatic(L"Error while reading configuration file %s: %s", path.c_str(), StringHelper::getSystemErrorString(error).c_str());
+			break;
+		}
+
+		// file is being written, so wait until its directory changes. The file is opened once more after registering
+		// for the notification, as the writer might have finished in between.
+		if (changeHandle == NULL)
+		{
+			size_t pos = path.find_last_of(L"\\/");
+			wstring directory = pos == wstring::npos ? L"." : path.substr(0, pos);
+			changeHandle = FindFirstChangeNotificationW(directory.c_str(), FALSE,
+				FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+		}
+		else if (changeHandle == INVALID_HANDLE_VALUE)
+		{
+			Sleep(1);
+		}
+		else
+		{
+			// the writer may keep the file open without changing it, so check again from time to time
+			WaitForSingleObject(changeHandle, 50);
+			FindNextChangeNotification(changeHandle);
+		}
+	}
+
+	if (changeHandle != NULL && changeHandle != INVALID_HANDLE_VALUE)
+		FindCloseChangeNotification(changeHandle);
+
+	if (hFile == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	shared_ptr<ConfigFile> file = make_shared<ConfigFile>();
+	BY_HANDLE_FILE_INFORMATION info;
+	if (GetFileInformationByHandle(hFile, &info))
+	{
+		file->size = (unsigned long long)info.nFileSizeHigh << 32 | info.nFileSizeLow;
+		file->lastWriteTime = (unsigned long long)info.ftLastWriteTime.dwHighDateTime << 32 | info.ftLastWriteTime.dwLowDateTime;
+
+		if (cached != nullptr && cached->size == file->size && cached->lastWriteTime == file->lastWriteTime)
+		{
+			CloseHandle(hFile);
+			TraceFStatic(L"Using cached contents of unchanged configuration file %s", path.c_str());
+			return cached;
+		}
+	}
+	else
+	{
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(hFile, &fileSize))
+			file->size = fileSize.QuadPart;
+	}
+
+	string data;
+	data.resize((size_t)file->size);
+
+	size_t totalRead = 0;
+	while (totalRead < data.size())
+	{
+		DWORD bytesRead = 0;
+		if (!ReadFile(hFile, &data[totalRead], (DWORD)min(data.size() - totalRead, (size_t)MAXDWORD), &bytesRead, NULL) || bytesRead == 0)
+			break;
+		totalRead += bytesRead;
+	}
+	data.resize(totalRead);
+
+	CloseHandle(hFile);
+
+	file->decode(data);
+	file->splitLines();
+
+	return file;
+}
+
+void ConfigFile::decode(const string& data)
+{
+	const char* p = data.c_str();
+	size_t size = data.size();
+	if (size == 0)
+		return;
+
+	if (size >= 2 && (unsigned char)p[0] == 0xFF && (unsigned char)p[1] == 0xFE)
+	{
+		// UTF-16 little endian
+		text.resize((size - 2) / 2);
+		memcpy(&text[0], p + 2, text.size() * sizeof(wchar_t));
+		return;
+	}
+
+	if (size >= 2 && (unsigned char)p[0] == 0xFE && (unsigned char)p[1] == 0xFF)
+	{
+		// UTF-16 big endian
+		text.resize((size - 2) / 2);
+		for (size_t i = 0; i < text.size(); i++)
+			text[i] = (wchar_t)((unsigned char)p[2 + 2 * i] << 8 | (unsigned char)p[3 + 2 * i]);
+		return;
+	}
+
+	if (size >= 3 && (unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB && (unsigned char)p[2] == 0xBF)
+	{
+		appendMultiByte(p + 3, size - 3, CP_UTF8);
+		return;
+	}
+
+	// most files are valid UTF-8, which also covers ASCII
+	int length = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, p, (int)size, NULL, 0);
+	if (length > 0)
+	{
+		text.resize(length);
+		MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, p, (int)size, &text[0], length);
+		return;
+	}
+
+	// Otherwise decode each line on its own as before, as files may contain lines
+	// in the ANSI codepage next to UTF-8 lines after being edited by different programs
+	size_t start = 0;
+	while (start <= size)
+	{
+		const char* end = (const char*)memchr(p + start, '\n', size - start);
+		size_t lineEnd = end != NULL ? end - p : size;
+
+		size_t oldLength = text.length();
+		appendMultiByte(p + start, lineEnd - start, CP_UTF8);
+		if (text.find(L'\uFFFD', oldLength) != wstring::npos)
+		{
+			text.resize(oldLength);
+			appendMultiByte(p + start, lineEnd - start, CP_ACP);
+		}
+
+		if (end == NULL)
+			break;
+		text += L'\n';
+		start = lineEnd + 1;
+	}
+}
+
+void ConfigFile::appendMultiByte(const char* data, size_t size, unsigned codepage)
+{
+	if (size == 0)
+		return;
+
+	int length = MultiByteToWideChar(codepage, 0, data, (int)size, NULL, 0);
+	if (length <= 0)
+		return;
+
+	size_t oldLength = text.length();
+	text.resize(oldLength + length);
+	MultiByteToWideChar(codepage, 0, data, (int)size, &text[oldLength], length);
+}
+
+void ConfigFile::splitLines()
+{
+	size_t start = 0;
+	while (true)
+	{
+		size_t end = text.find(L'\n', start);
+		size_t lineEnd = end != wstring::npos ? end : text.length();
+
+		Line line;
+		line.offset = start;
+		line.length = lineEnd - start;
+		if (line.length > 0 && text[lineEnd - 1] == L'\r')
+			line.length--;
+		splitCommand(line);
+		lines.push_back(line);
+
+		if (end == wstring::npos)
+			break;
+		start = end + 1;
+	}
+}
+
+void ConfigFile::splitCommand(Line& line) const
+{
+	const wchar_t* start = text.c_str() + line.offset;
+	const wchar_t* colon = wmemchr(start, L':', line.length);
+	if (colon == NULL)
+	{
+		line.commandOffset = wstring::npos;
+		line.commandLength = 0;
+		line.parametersOffset = line.offset + line.length;
+		return;
+	}
+
+	// allow to use indentation
+	const wchar_t* commandStart = start;
+	const wchar_t* commandEnd = colon;
+	while (commandStart < commandEnd && iswspace(*commandStart))
+		commandStart++;
+	while (commandEnd > commandStart && iswspace(commandEnd[-1]))
+		commandEnd--;
+
+	line.commandOffset = commandStart - text.c_str();
+	line.commandLength = commandEnd - commandStart;
+	line.parametersOffset = colon + 1 - text.c_str();
+}
@@ -0,0 +1,63 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Contents of a configuration file, read at once and decoded to UTF-16 in one pass. The lines are split into command
+// and parameters here as well, as that does not depend on the device the file is loaded for.
+class ConfigFile
+{
+public:
+	struct Line
+	{
+		// position of the line in the decoded text, excluding the line break
+		size_t offset;
+		size_t length;
+		// position of the command before the first colon without surrounding whitespace, npos if there is no colon
+		size_t commandOffset;
+		size_t commandLength;
+		// position of the parameters after the colon, which extend to the end of the line
+		size_t parametersOffset;
+	};
+
+	// Waits while the file is being written and returns NULL if it can't be read. If the file still has the size
+	// and modification time of cached, cached is returned instead of reading the file again.
+	static std::shared_ptr<const ConfigFile> load(const std::wstring& path, const std::shared_ptr<const ConfigFile>& cached = nullptr);
+
+	const std::wstring& getText() const {return text;}
+	const std::vector<Line>& getLines() const {return lines;}
+	// size and modification time of the file when it was read
+	unsigned long long getSize() const {return size;}
+	unsigned long long getLastWriteTime() const {return lastWriteTime;}
+
+private:
+	void decode(const std::string& data);
+	void appendMultiByte(const char* data, size_t size, unsigned codepage);
+	void splitLines();
+	void splitCommand(Line& line) const;
+
+	std::wstring text;
+	std::vector<Line> lines;
+	unsigned long long size = 0;
+	unsigned long long lastWriteTime = 0;
+};
@@ -0,0 +1,149 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <set>
+
+#include "LogHelper.h"
+#include "ConfigService.h"
+
+using namespace std;
+
+ConfigService& ConfigService::getInstance()
+{
+	static ConfigService instance;
+	return instance;
+}
+
+shared_ptr<const ConfigFile> ConfigService::loadFile(const wstring& path)
+{
+	shared_ptr<FileEntry> entry;
+	{
+		lock_guard<mutex> lock(filesMutex);
+
+		// forget the files that no engine uses anymore, unless they are being loaded
+		for (auto it = files.begin(); it != files.end();)
+		{
+			if (it->second.use_count() == 1 && it->second->file.expired())
+				it = files.erase(it);
+			else
+				it++;
+		}
+
+		shared_ptr<FileEntry>& slot = files[path];
+		if (slot == nullptr)
+			slot = make_shared<FileEntry>();
+		entry = slot;
+	}
+
+	// engines reloading after the same change wait here for the first one to read the file
+	lock_guard<mutex> lock(entry->loadMutex);
+
+	shared_ptr<const ConfigFile> file = ConfigFile::load(path, entry->file.lock());
+	entry->file = file;
+
+	return file;
+}
+
+bool ConfigService::watchFiles(IFileChangeListener* listener, const vector<wstring>& paths)
+{
+	lock_guard<mutex> lock(listenersMutex);
+
+	if (watcher == NULL)
+	{
+		watcher = FileWatcher::create(this);
+		if (watcher == NULL)
+			return false;
+	}
+
+	listeners[listener] = paths;
+	updateWatcher();
+
+	return true;
+}
+
+void ConfigService::unwatchFiles(IFileChangeListener* listener)
+{
+	FileWatcher* unusedWatcher = NULL;
+	{
+		lock_guard<mutex> lock(listenersMutex);
+
+		listeners.erase(listener);
+		if (listeners.empty())
+		{
+			// the thread of the watcher is stopped while engines are still being destroyed, not when the module is unloaded
+			unusedWatcher = watcher;
+			watcher = NULL;
+			watchedPaths.clear();
+		}
+		else
+		{
+			updateWatcher();
+		}
+	}
+
+	// outside of the lock, as the watcher thread might be waiting for it in fileChanged
+	delete unusedWatcher;
+}
+
+void ConfigService::fileChanged(const wstring& path)
+{
+	lock_guard<mutex> lock(listenersMutex);
+
+	for (auto& entry : listeners)
+	{
+		const vector<wstring>& paths = entry.second;
+		if (find(paths.begin(), paths.end(), path) != paths.end())
+			entry.first->fileChanged(path);
+	}
+}
+
+void ConfigService::updateWatcher()
+{
+	set<wstring> paths;
+	for (auto& entry : listeners)
+		paths.insert(entry.second.begin(), entry.second.end());
+
+	// engines usually reload the same files, which does not change what is watched
+	vector<wstring> newPaths(paths.begin(), paths.end());
+	if (newPaths == watchedPaths)
+		return;
+	watchedPaths = newPaths;
+
+	// the watcher compares new files with the state in which they were read, as they might have changed since then
+	unordered_map<wstring, FileState> readStates;
+	{
+		lock_guard<mutex> lock(filesMutex);
+		for (const wstring& path : watchedPaths)
+		{
+			auto it = files.find(path);
+			shared_ptr<const ConfigFile> file = it == files.end() ? nullptr : it->second->file.lock();
+			if (file != nullptr)
+			{
+				FileState& state = readStates[path];
+				state.exists = true;
+				state.size = file->getSize();
+				state.lastWriteTime = file->getLastWriteTime();
+			}
+		}
+	}
+
+	TraceF(L"Watching %d files for %d engines", (int)paths.size(), (int)listeners.size());
+	watcher->setFiles(watchedPaths, readStates);
+}
@@ -0,0 +1,70 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ConfigFile.h"
+#include "FileWatcher.h"
+
+// Configuration files shared by all FilterEngines of the process, like the ones of every stream and endpoint in
+// audiodg. Each file is only read and split into commands again when it has changed, and a single FileWatcher
+// watches the files of all engines and passes each change on to the engines that use the file.
+class ConfigService : private IFileChangeListener
+{
+public:
+	static ConfigService& getInstance();
+
+	// Returns the contents of the file or NULL if it can't be read. The contents are cached as long as any
+	// caller holds them, so engines loading the same configuration only read it once.
+	std::shared_ptr<const ConfigFile> loadFile(const std::wstring& path);
+
+	// replaces the files the listener is notified about, returns false if files can't be watched
+	bool watchFiles(IFileChangeListener* listener, const std::vector<std::wstring>& paths);
+	// the listener is not notified anymore after this returns
+	void unwatchFiles(IFileChangeListener* listener);
+
+private:
+	ConfigService() {}
+
+	// called with listenersMutex locked, so listeners must not call back into the service
+	void fileChanged(const std::wstring& path) override;
+	void updateWatcher();
+
+	// The mutex of an entry is only held while that file is read, so that different files are read in parallel.
+	struct FileEntry
+	{
+		std::mutex loadMutex;
+		std::weak_ptr<const ConfigFile> file;
+	};
+
+	std::mutex filesMutex;
+	std::unordered_map<std::wstring, std::shared_ptr<FileEntry>> files;
+
+	std::mutex listenersMutex;
+	std::unordered_map<IFileChangeListener*, std::vector<std::wstring>> listeners;
+	FileWatcher* watcher = NULL;
+	// union of the files of all listeners that has been passed to the watcher
+	std::vector<std::wstring> watchedPaths;
+};
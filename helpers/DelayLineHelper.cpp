@@ -0,0 +1,57 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <cstring>
+
+#include "DelayLineHelper.h"
+
+#pragma AVRT_CODE_BEGIN
+void DelayLineHelper::process(double* output, const double* input, double* buffer, unsigned bufferLength, unsigned bufferOffset, unsigned frameCount)
+{
+	if (bufferLength <= frameCount)
+	{
+		memcpy(output, buffer + bufferOffset, (bufferLength - bufferOffset) * sizeof(double));
+		memcpy(output + bufferLength - bufferOffset, buffer, bufferOffset * sizeof(double));
+		memcpy(output + bufferLength, input, (frameCount - bufferLength) * sizeof(double));
+		memcpy(buffer, input + frameCount - bufferLength, bufferLength * sizeof(double));
+	}
+	else if (bufferLength < bufferOffset + frameCount)
+	{
+		memcpy(output, buffer + bufferOffset, (bufferLength - bufferOffset) * sizeof(double));
+		memcpy(output + bufferLength - bufferOffset, buffer, (frameCount - (bufferLength - bufferOffset)) * sizeof(double));
+		memcpy(buffer + bufferOffset, input, (bufferLength - bufferOffset) * sizeof(double));
+		memcpy(buffer, input + bufferLength - bufferOffset, (frameCount - (bufferLength - bufferOffset)) * sizeof(double));
+	}
+	else
+	{
+		memcpy(output, buffer + bufferOffset, frameCount * sizeof(double));
+		memcpy(buffer + bufferOffset, input, frameCount * sizeof(double));
+	}
+}
+
+unsigned DelayLineHelper::nextOffset(unsigned bufferLength, unsigned bufferOffset, unsigned frameCount)
+{
+	// a block at least as long as the buffer leaves its newest samples in order from the start
+	if (bufferLength <= frameCount)
+		return 0;
+	else
+		return (bufferOffset + frameCount) % bufferLength;
+}
+#pragma AVRT_CODE_END
@@ -0,0 +1,32 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include "MemoryHelper.h"
+
+// Delay line on a ring buffer of bufferLength samples per channel, as used by the filters that delay their signal.
+// All channels of a filter share one read position, which is moved on by nextOffset after each block.
+class DelayLineHelper
+{
+public:
+	// writes input delayed by bufferLength samples to output, output and input must not overlap
+	static void process(double* output, const double* input, double* buffer, unsigned bufferLength, unsigned bufferOffset, unsigned frameCount);
+	static unsigned nextOffset(unsigned bufferLength, unsigned bufferOffset, unsigned frameCount);
+};
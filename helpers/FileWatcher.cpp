@@ -0,0 +1,539 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// compiled without the precompiled header, which includes windows.h, so that the inotify part builds on Linux
+#include <algorithm>
+#include <map>
+#include <set>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+#include "LogHelper.h"
+#else
+// the log helper only exists on Windows, so messages are written to stderr
+#define TraceF(format, ...) fwprintf(stderr, format L"\n", ##__VA_ARGS__)
+#define LogF(format, ...) fwprintf(stderr, format L"\n", ##__VA_ARGS__)
+#endif
+#include "FileWatcher.h"
+
+using namespace std;
+
+#ifdef _WIN32
+static const wchar_t* SEPARATORS = L"\\/";
+#else
+static const wchar_t* SEPARATORS = L"/";
+#endif
+
+// groups the files by the directory that contains them
+static map<wstring, set<wstring>> getDirectories(const vector<wstring>& paths)
+{
+	map<wstring, set<wstring>> directories;
+	for (const wstring& path : paths)
+	{
+		size_t pos = path.find_last_of(SEPARATORS);
+		wstring directory;
+		if (pos == wstring::npos)
+			directory = L".";
+		else if (pos == 0 || path[pos - 1] == L':')
+			// keep the separator of root directories
+			directory = path.substr(0, pos + 1);
+		else
+			directory = path.substr(0, pos);
+
+		directories[directory].insert(path);
+	}
+
+	return directories;
+}
+
+#ifdef _WIN32
+class WindowsFileWatcher : public FileWatcher
+{
+public:
+	WindowsFileWatcher(IFileChangeListener* listener);
+	~WindowsFileWatcher();
+
+	bool start();
+	void setFiles(const vector<wstring>& paths, const unordered_map<wstring, FileState>& readStates) override;
+
+private:
+	struct WatchedFile
+	{
+		wstring path;
+		FileState state;
+	};
+
+	struct Directory
+	{
+		wstring path;
+		HANDLE handle;
+		vector<WatchedFile> files;
+	};
+
+	static unsigned long __stdcall watchThread(void* parameter);
+	void addFile(Directory& directory, const wstring& path, const unordered_map<wstring, FileState>& readStates);
+	void updateDirectories(vector<Directory>& directories);
+
+	IFileChangeListener* listener;
+	HANDLE threadHandle;
+	HANDLE shutdownEvent;
+	HANDLE updateEvent;
+	CRITICAL_SECTION section;
+	vector<wstring> paths;
+	unordered_map<wstring, FileState> readStates;
+};
+
+WindowsFileWatcher::WindowsFileWatcher(IFileChangeListener* listener)
+	: listener(listener)
+{
+	InitializeCriticalSection(&section);
+	shutdownEvent = CreateEventW(NULL, true, false, NULL);
+	updateEvent = CreateEventW(NULL, false, false, NULL);
+	threadHandle = NULL;
+}
+
+WindowsFileWatcher::~WindowsFileWatcher()
+{
+	if (threadHandle != NULL)
+	{
+		SetEvent(shutdownEvent);
+		WaitForSingleObject(threadHandle, INFINITE);
+		CloseHandle(threadHandle);
+	}
+
+	CloseHandle(updateEvent);
+	CloseHandle(shutdownEvent);
+	DeleteCriticalSection(&section);
+}
+
+bool WindowsFileWatcher::start()
+{
+	threadHandle = CreateThread(NULL, 0, watchThread, this, 0, NULL);
+	if (threadHandle == NULL)
+	{
+		LogF(L"Could not create file watcher thread (error %d)", GetLastError());
+		return false;
+	}
+
+	return true;
+}
+
+void WindowsFileWatcher::setFiles(const vector<wstring>& paths, const unordered_map<wstring, FileState>& readStates)
+{
+	EnterCriticalSection(&section);
+	this->paths = paths;
+	// the states of an earlier call might not have been used yet
+	for (auto& entry : readStates)
+		this->readStates[entry.first] = entry.second;
+	LeaveCriticalSection(&section);
+
+	SetEvent(updateEvent);
+}
+
+void WindowsFileWatcher::addFile(Directory& directory, const wstring& path, const unordered_map<wstring, FileState>& readStates)
+{
+	// called after the directory is watched, so later changes are noticed by comparing with this state
+	WatchedFile file;
+	file.path = path;
+	file.state = FileState::get(path);
+	directory.files.push_back(file);
+
+	auto it = readStates.find(path);
+	if (it != readStates.end() && it->second != file.state)
+		listener->fileChanged(path);
+}
+
+void WindowsFileWatcher::updateDirectories(vector<Directory>& directories)
+{
+	EnterCriticalSection(&section);
+	map<wstring, set<wstring>> pathsByDirectory = getDirectories(paths);
+	unordered_map<wstring, FileState> readStates;
+	readStates.swap(this->readStates);
+	LeaveCriticalSection(&section);
+
+	// Directories and files that are still watched keep their handle and state, so that changes that have not
+	// been handled yet are still noticed after the update. Only the new files get the current state.
+	for (auto it = directories.begin(); it != directories.end();)
+	{
+		auto entry = pathsByDirectory.find(it->path);
+		if (entry == pathsByDirectory.end())
+		{
+			FindCloseChangeNotification(it->handle);
+			it = directories.erase(it);
+			continue;
+		}
+
+		set<wstring>& newPaths = entry->second;
+		vector<WatchedFile>& files = it->files;
+		files.erase(remove_if(files.begin(), files.end(), [&newPaths](const WatchedFile& file) {return newPaths.count(file.path) == 0;}), files.end());
+		for (const WatchedFile& file : files)
+			newPaths.erase(file.path);
+		for (const wstring& path : newPaths)
+			addFile(*it, path, readStates);
+
+		pathsByDirectory.erase(entry);
+		it++;
+	}
+
+	for (auto& entry : pathsByDirectory)
+	{
+		// two handles are needed for the shutdown and update events
+		if (directories.size() + 2 >= MAXIMUM_WAIT_OBJECTS)
+		{
+			LogF(L"Too many directories to watch, ignoring changes in %s", entry.first.c_str());
+			continue;
+		}
+
+		Directory directory;
+		directory.path = entry.first;
+		directory.handle = FindFirstChangeNotificationW(entry.first.c_str(), FALSE,
+			FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+		if (directory.handle == INVALID_HANDLE_VALUE)
+		{
+			TraceF(L"Can't watch directory %s for changes", entry.first.c_str());
+			continue;
+		}
+
+		directories.push_back(directory);
+		for (const wstring& path : entry.second)
+			addFile(directories.back(), path, readStates);
+	}
+}
+
+unsigned long __stdcall WindowsFileWatcher::watchThread(void* parameter)
+{
+	WindowsFileWatcher* watcher = (WindowsFileWatcher*)parameter;
+
+	vector<Directory> directories;
+	vector<HANDLE> handles;
+	while (true)
+	{
+		handles.clear();
+		handles.push_back(watcher->shutdownEvent);
+		handles.push_back(watcher->updateEvent);
+		for (Directory& directory : directories)
+			handles.push_back(directory.handle);
+
+		DWORD which = WaitForMultipleObjects((DWORD)handles.size(), handles.data(), false, INFINITE);
+		if (which == WAIT_OBJECT_0)
+		{
+			break;
+		}
+		else if (which == WAIT_OBJECT_0 + 1)
+		{
+			watcher->updateDirectories(directories);
+		}
+		else if (which >= WAIT_OBJECT_0 + 2 && which < WAIT_OBJECT_0 + handles.size())
+		{
+			// the notification does not tell which file has changed, so compare the states
+			Directory& directory = directories[which - WAIT_OBJECT_0 - 2];
+			FindNextChangeNotification(directory.handle);
+			for (WatchedFile& file : directory.files)
+			{
+				FileState state = FileState::get(file.path);
+				if (state != file.state)
+				{
+					file.state = state;
+					watcher->listener->fileChanged(file.path);
+				}
+			}
+		}
+		else
+		{
+			LogFStatic(L"Waiting for file changes failed (error %d)", GetLastError());
+			break;
+		}
+	}
+
+	for (Directory& directory : directories)
+		FindCloseChangeNotification(directory.handle);
+
+	return 0;
+}
+
+FileState FileState::get(const wstring& path)
+{
+	FileState state;
+
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	state.exists = GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data) != FALSE;
+	if (state.exists)
+	{
+		state.size = (unsigned long long)data.nFileSizeHigh << 32 | data.nFileSizeLow;
+		state.lastWriteTime = (unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32 | data.ftLastWriteTime.dwLowDateTime;
+	}
+
+	return state;
+}
+
+FileWatcher* FileWatcher::create(IFileChangeListener* listener)
+{
+	WindowsFileWatcher* watcher = new WindowsFileWatcher(listener);
+	if (!watcher->start())
+	{
+		delete watcher;
+		return NULL;
+	}
+
+	return watcher;
+}
+#else
+static string toUtf8(const wstring& s)
+{
+	string result;
+	for (wchar_t c : s)
+	{
+		unsigned long u = (unsigned long)c;
+		if (u < 0x80)
+		{
+			result += (char)u;
+		}
+		else if (u < 0x800)
+		{
+			result += (char)(0xC0 | u >> 6);
+			result += (char)(0x80 | (u & 0x3F));
+		}
+		else if (u < 0x10000)
+		{
+			result += (char)(0xE0 | u >> 12);
+			result += (char)(0x80 | (u >> 6 & 0x3F));
+			result += (char)(0x80 | (u & 0x3F));
+		}
+		else
+		{
+			result += (char)(0xF0 | u >> 18);
+			result += (char)(0x80 | (u >> 12 & 0x3F));
+			result += (char)(0x80 | (u >> 6 & 0x3F));
+			result += (char)(0x80 | (u & 0x3F));
+		}
+	}
+
+	return result;
+}
+
+class InotifyFileWatcher : public FileWatcher
+{
+public:
+	InotifyFileWatcher(IFileChangeListener* listener);
+	~InotifyFileWatcher();
+
+	bool start();
+	void setFiles(const vector<wstring>& paths, const unordered_map<wstring, FileState>& readStates) override;
+
+private:
+	void watchThread();
+	void updateWatches();
+
+	IFileChangeListener* listener;
+	int inotifyFd;
+	int wakeFds[2];
+	atomic<bool> shutdown;
+	thread watcherThread;
+	mutex pathsMutex;
+	vector<wstring> paths;
+	unordered_map<wstring, FileState> readStates;
+
+	// only used by the watcher thread
+	map<int, string> watchDirectories;
+	// UTF-8 encoded paths as reported by inotify to the original paths
+	map<string, wstring> watchPaths;
+};
+
+InotifyFileWatcher::InotifyFileWatcher(IFileChangeListener* listener)
+	: listener(listener), shutdown(false)
+{
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	wakeFds[0] = wakeFds[1] = -1;
+}
+
+InotifyFileWatcher::~InotifyFileWatcher()
+{
+	if (watcherThread.joinable())
+	{
+		shutdown = true;
+		char c = 0;
+		if (write(wakeFds[1], &c, 1) < 0)
+			LogF(L"Could not wake file watcher thread");
+		watcherThread.join();
+	}
+
+	if (wakeFds[0] != -1)
+	{
+		close(wakeFds[0]);
+		close(wakeFds[1]);
+	}
+	if (inotifyFd != -1)
+		close(inotifyFd);
+}
+
+bool InotifyFileWatcher::start()
+{
+	if (inotifyFd == -1 || pipe(wakeFds) != 0)
+	{
+		LogF(L"Could not initialize inotify");
+		return false;
+	}
+
+	watcherThread = thread(&InotifyFileWatcher::watchThread, this);
+	return true;
+}
+
+void InotifyFileWatcher::setFiles(const vector<wstring>& paths, const unordered_map<wstring, FileState>& readStates)
+{
+	{
+		lock_guard<mutex> lock(pathsMutex);
+		this->paths = paths;
+		for (auto& entry : readStates)
+			this->readStates[entry.first] = entry.second;
+	}
+
+	char c = 0;
+	if (write(wakeFds[1], &c, 1) < 0)
+		LogF(L"Could not wake file watcher thread");
+}
+
+void InotifyFileWatcher::updateWatches()
+{
+	map<wstring, set<wstring>> pathsByDirectory;
+	map<string, wstring> oldWatchPaths;
+	oldWatchPaths.swap(watchPaths);
+	unordered_map<wstring, FileState> readStates;
+	{
+		lock_guard<mutex> lock(pathsMutex);
+		pathsByDirectory = getDirectories(paths);
+		for (const wstring& path : paths)
+			watchPaths[toUtf8(path)] = path;
+		readStates.swap(this->readStates);
+	}
+
+	// directories that are still watched keep their watch, so that no events are lost during the update
+	map<string, wstring> directories;
+	for (auto& entry : pathsByDirectory)
+		directories[toUtf8(entry.first)] = entry.first;
+
+	for (auto it = watchDirectories.begin(); it != watchDirectories.end();)
+	{
+		if (directories.erase(it->second) == 0)
+		{
+			inotify_rm_watch(inotifyFd, it->first);
+			it = watchDirectories.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+
+	for (auto& entry : directories)
+	{
+		int wd = inotify_add_watch(inotifyFd, entry.first.c_str(), IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+		if (wd == -1)
+			TraceF(L"Can't watch directory %ls for changes", entry.second.c_str());
+		else
+			watchDirectories[wd] = entry.first;
+	}
+
+	// changes of new files between reading and watching them have not caused events
+	for (auto& entry : watchPaths)
+	{
+		auto it = readStates.find(entry.second);
+		if (oldWatchPaths.count(entry.first) == 0 && it != readStates.end() && it->second != FileState::get(entry.second))
+			listener->fileChanged(entry.second);
+	}
+}
+
+void InotifyFileWatcher::watchThread()
+{
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	while (!shutdown)
+	{
+		pollfd fds[2] = {{wakeFds[0], POLLIN, 0}, {inotifyFd, POLLIN, 0}};
+		if (poll(fds, 2, -1) <= 0)
+			continue;
+
+		if (fds[0].revents & POLLIN)
+		{
+			char c[64];
+			if (read(wakeFds[0], c, sizeof(c)) > 0 && !shutdown)
+				updateWatches();
+		}
+
+		if (fds[1].revents & POLLIN)
+		{
+			ssize_t length;
+			while ((length = read(inotifyFd, buf, sizeof(buf))) > 0)
+			{
+				for (char* p = buf; p < buf + length; p += sizeof(inotify_event) + ((inotify_event*)p)->len)
+				{
+					inotify_event* event = (inotify_event*)p;
+					auto it = watchDirectories.find(event->wd);
+					if (it == watchDirectories.end() || event->len == 0)
+						continue;
+
+					const string& directory = it->second;
+					string path = directory + (directory[directory.length() - 1] == '/' ? "" : "/") + event->name;
+					auto pathIt = watchPaths.find(path);
+					if (pathIt != watchPaths.end())
+						listener->fileChanged(pathIt->second);
+				}
+			}
+		}
+	}
+}
+
+FileState FileState::get(const wstring& path)
+{
+	FileState state;
+
+	struct stat data;
+	state.exists = stat(toUtf8(path).c_str(), &data) == 0;
+	if (state.exists)
+	{
+		state.size = (unsigned long long)data.st_size;
+		state.lastWriteTime = (unsigned long long)data.st_mtim.tv_sec * 1000000000 + data.st_mtim.tv_nsec;
+	}
+
+	return state;
+}
+
+FileWatcher* FileWatcher::create(IFileChangeListener* listener)
+{
+	InotifyFileWatcher* watcher = new InotifyFileWatcher(listener);
+	if (!watcher->start())
+	{
+		delete watcher;
+		return NULL;
+	}
+
+	return watcher;
+}
+#endif
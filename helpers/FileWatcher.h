@@ -0,0 +1,66 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Size and modification time of a file, which change whenever it is written
+struct FileState
+{
+	bool exists = false;
+	unsigned long long size = 0;
+	// in the units of the file system, so only comparable with states returned by get
+	unsigned long long lastWriteTime = 0;
+
+	static FileState get(const std::wstring& path);
+
+	bool operator!=(const FileState& other) const
+	{
+		return exists != other.exists || size != other.size || lastWriteTime != other.lastWriteTime;
+	}
+};
+
+class IFileChangeListener
+{
+public:
+	virtual ~IFileChangeListener() {}
+
+	// called on the thread of the watcher when a watched file has been created, written, renamed or deleted
+	virtual void fileChanged(const std::wstring& path) = 0;
+};
+
+// Watches a set of files for changes, by watching the directories that contain them, so that
+// files that are created later are noticed as well. Changes to other files are ignored.
+// Uses directory change notifications on Windows and inotify on Linux.
+class FileWatcher
+{
+public:
+	// returns NULL if watching is not possible
+	static FileWatcher* create(IFileChangeListener* listener);
+
+	virtual ~FileWatcher() {}
+
+	// Replaces the set of watched files, may be called from any thread. Files that are still watched afterwards keep
+	// their state, so changes to them are not lost during the update. readStates may contain the states of new files
+	// when they were read, so that a file that has changed since then is reported as soon as it is watched.
+	virtual void setFiles(const std::vector<std::wstring>& paths, const std::unordered_map<std::wstring, FileState>& readStates) = 0;
+};
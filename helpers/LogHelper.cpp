@@ -19,14 +19,229 @@
 
 #include "stdafx.h"
 #include <cstdarg>
+#include <share.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
 #include "RegistryHelper.h"
+#include "MpscRing.h"
 #include "LogHelper.h"
 
 using namespace std;
 
+// longer messages are truncated when they are written by the log writer
+static const size_t MAX_MESSAGE_LENGTH = 1024;
+static const size_t RING_CAPACITY = 256;
+// trace messages wake the writer once per this many messages, errors at once
+static const size_t WAKE_INTERVAL = RING_CAPACITY / 4;
+static const DWORD FLUSH_INTERVAL_MS = 200;
+// the file is closed after this many flush intervals without messages, so that it can be deleted
+static const unsigned CLOSE_AFTER_IDLE_INTERVALS = 5;
+
+struct LogRecord
+{
+	FILETIME time;
+	DWORD threadId;
+	const void* caller;
+	const char* file;
+	int line;
+	bool trace;
+	wchar_t message[MAX_MESSAGE_LENGTH];
+};
+
+// Writes the messages for the log file on a background thread that keeps the file open. The callers only format
+// their message into a preallocated ring without locking, so that logging is safe on the real-time thread. If the
+// ring is full, the message is dropped and counted instead of waiting for the writer.
+class LogWriter
+{
+public:
+	~LogWriter()
+	{
+		stop();
+	}
+
+	void start(const wstring& path);
+	void stop();
+	// returns false if the writer is not running, so that the caller has to write the message itself
+	bool push(const char* file, int line, const void* caller, bool trace, const wchar_t* format, va_list args);
+
+private:
+	static unsigned long __stdcall writerThread(void* parameter);
+	void writeRecords();
+
+	wstring path;
+	unique_ptr<MpscRing<LogRecord>> ring;
+	atomic<bool> running = false;
+	atomic<unsigned> droppedCount = 0;
+	HMODULE module = NULL;
+	HANDLE threadHandle = NULL;
+	HANDLE wakeEvent = NULL;
+	HANDLE shutdownEvent = NULL;
+	FILE* fp = NULL;
+	unsigned idleIntervals = 0;
+};
+
+static LogWriter writer;
+static mutex writerMutex;
+static unsigned writerUsers = 0;
+
+static void writePrefix(FILE* fp, const SYSTEMTIME& time, DWORD threadId, const void* caller, const char* file, int line, bool trace, bool compact)
+{
+	if (!compact)
+	{
+		fwprintf(fp, L"%04d-%02d-%02d %02d:%02d:%02d.%03d %d %08X (%S:%d): ",
+			time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, time.wMilliseconds, threadId, (DWORD)(unsigned long long)caller, file, line);
+	}
+
+	if (trace)
+		fwprintf(fp, L"(TRACE) ");
+}
+
+void LogWriter::start(const wstring& path)
+{
+	if (threadHandle != NULL)
+		return;
+
+	this->path = path;
+	// the ring and the events are kept after stopping, as a concurrent caller may still be about to use them
+	if (ring == NULL)
+	{
+		ring.reset(new MpscRing<LogRecord>(RING_CAPACITY));
+		wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+		shutdownEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+	}
+	ResetEvent(shutdownEvent);
+
+	// the thread keeps the module loaded until it has finished, so it never runs code of an unloaded module
+	if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (LPCWSTR)&LogWriter::writerThread, &module))
+		return;
+
+	running.store(true, memory_order_release);
+	threadHandle = CreateThread(NULL, 0, &writerThread, this, 0, NULL);
+	if (threadHandle == NULL)
+	{
+		running.store(false, memory_order_release);
+		FreeLibrary(module);
+	}
+}
+
+void LogWriter::stop()
+{
+	if (threadHandle == NULL)
+		return;
+
+	running.store(false, memory_order_release);
+	SetEvent(shutdownEvent);
+	// when the process terminates, the thread has already been terminated
+	WaitForSingleObject(threadHandle, INFINITE);
+
+	// so the remaining messages are written here
+	writeRecords();
+	if (fp != NULL)
+	{
+		fclose(fp);
+		fp = NULL;
+	}
+
+	CloseHandle(threadHandle);
+	threadHandle = NULL;
+}
+
+bool LogWriter::push(const char* file, int line, const void* caller, bool trace, const wchar_t* format, va_list args)
+{
+	if (!running.load(memory_order_acquire))
+		return false;
+
+	size_t position;
+	MpscRing<LogRecord>::Slot* slot = ring->tryAcquire(&position);
+	if (slot == NULL)
+	{
+		droppedCount.fetch_add(1, memory_order_relaxed);
+		return true;
+	}
+
+	LogRecord& record = slot->value;
+	GetSystemTimeAsFileTime(&record.time);
+	record.threadId = GetCurrentThreadId();
+	record.caller = caller;
+	record.file = file;
+	record.line = line;
+	record.trace = trace;
+	if (_vsnwprintf_s(record.message, MAX_MESSAGE_LENGTH, _TRUNCATE, format, args) < 0)
+		wcscpy_s(record.message + MAX_MESSAGE_LENGTH - 4, 4, L"...");
+	ring->publish(slot);
+
+	if (!trace || (position + 1) % WAKE_INTERVAL == 0)
+		SetEvent(wakeEvent);
+
+	return true;
+}
+
+unsigned long __stdcall LogWriter::writerThread(void* parameter)
+{
+	LogWriter* writer = (LogWriter*)parameter;
+
+	HANDLE events[] = {writer->shutdownEvent, writer->wakeEvent};
+	while (true)
+	{
+		DWORD result = WaitForMultipleObjects(2, events, FALSE, FLUSH_INTERVAL_MS);
+		writer->writeRecords();
+		if (result == WAIT_OBJECT_0)
+			break;
+	}
+
+	if (writer->fp != NULL)
+	{
+		fclose(writer->fp);
+		writer->fp = NULL;
+	}
+
+	FreeLibraryAndExitThread(writer->module, 0);
+}
+
+void LogWriter::writeRecords()
+{
+	unsigned dropped = droppedCount.exchange(0, memory_order_relaxed);
+	if (ring->peek() == NULL && dropped == 0)
+	{
+		if (fp != NULL && ++idleIntervals >= CLOSE_AFTER_IDLE_INTERVALS)
+		{
+			fclose(fp);
+			fp = NULL;
+		}
+		return;
+	}
+
+	idleIntervals = 0;
+	if (fp == NULL)
+		// allow other processes to write to the same log file
+		fp = _wfsopen(path.c_str(), L"at", _SH_DENYNO);
+
+	while (LogRecord* record = ring->peek())
+	{
+		if (fp != NULL)
+		{
+			FILETIME localTime;
+			SYSTEMTIME time;
+			FileTimeToLocalFileTime(&record->time, &localTime);
+			FileTimeToSystemTime(&localTime, &time);
+			writePrefix(fp, time, record->threadId, record->caller, record->file, record->line, record->trace, false);
+			fwprintf(fp, L"%s\n", record->message);
+		}
+		ring->pop();
+	}
+
+	if (fp != NULL)
+	{
+		if (dropped > 0)
+			fwprintf(fp, L"%u log messages were dropped because they were logged faster than they could be written\n", dropped);
+		fflush(fp);
+	}
+}
+
 bool LogHelper::initialized = false;
 wstring LogHelper::logPath;
 bool LogHelper::enableTrace = false;
@@ -34,7 +249,7 @@ FILE* LogHelper::presetFP = NULL;
 bool LogHelper::compact = false;
 bool LogHelper::useConsoleColors = false;
 
-void LogHelper::log(const char* file, int line, const void* caller, bool trace, const wchar_t* format, ...)
+void LogHelper::initialize()
 {
 	if (!initialized)
 	{
@@ -57,10 +272,27 @@ void LogHelper::log(const char* file, int line, const void* caller, bool trace,
 			LogFStatic(L"%s", e.getMessage());
 		}
 	}
+}
+
+void LogHelper::log(const char* file, int line, const void* caller, bool trace, const wchar_t* format, ...)
+{
+	initialize();
 
 	if (trace && !enableTrace)
 		return;
 
+	if (presetFP == NULL)
+	{
+		va_list varArgs;
+		va_start(varArgs, format);
+		bool queued = writer.push(file, line, caller, trace, format, varArgs);
+		va_end(varArgs);
+		if (queued)
+			return;
+	}
+
+	// without the writer, the message is written directly
+
 	FILE* fp;
 	if (presetFP == NULL)
 	{
@@ -82,17 +314,9 @@ void LogHelper::log(const char* file, int line, const void* caller, bool trace,
 			SetConsoleTextAttribute(con, 12);// Set console color to red
 	}
 
-	if (!compact)
-	{
-		SYSTEMTIME ___st;
-		GetLocalTime(&___st);
-		DWORD threadId = GetCurrentThreadId();
-		fwprintf(fp, L"%04d-%02d-%02d %02d:%02d:%02d.%03d %d %08X (%S:%d): ",
-			___st.wYear, ___st.wMonth, ___st.wDay, ___st.wHour, ___st.wMinute, ___st.wSecond, ___st.wMilliseconds, threadId, (DWORD)(unsigned long long)caller, file, line);
-	}
-
-	if (trace)
-		fwprintf(fp, L"(TRACE) ");
+	SYSTEMTIME time;
+	GetLocalTime(&time);
+	writePrefix(fp, time, GetCurrentThreadId(), caller, file, line, trace, compact);
 
 	va_list varArgs;
 	va_start(varArgs, format);
@@ -129,3 +353,19 @@ void LogHelper::set(FILE* fp, bool enableTrace, bool compact, bool useConsoleCol
 	LogHelper::compact = compact;
 	LogHelper::useConsoleColors = useConsoleColors;
 }
+
+void LogHelper::startWriter()
+{
+	initialize();
+
+	lock_guard<mutex> lock(writerMutex);
+	if (writerUsers++ == 0 && presetFP == NULL)
+		writer.start(logPath);
+}
+
+void LogHelper::stopWriter()
+{
+	lock_guard<mutex> lock(writerMutex);
+	if (writerUsers > 0 && --writerUsers == 0)
+		writer.stop();
+}
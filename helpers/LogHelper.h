@@ -30,11 +30,21 @@
 class LogHelper
 {
 public:
+	// While the writer is started, messages for the log file are queued in a lock-free ring and written by a
+	// background thread, so this is safe to call from the audio thread. If the ring is full, the message is dropped
+	// and the drop is counted. Without the writer, messages are written directly.
 	static void log(const char* file, int line, const void* caller, bool trace, const wchar_t* format, ...);
 	static void reset();
 	static void set(FILE* fp, bool enableTrace, bool compact, bool useConsoleColors);
 
+	// The writer is reference counted, so every call to startWriter needs a matching call to stopWriter.
+	// It must be started outside of the audio thread and keeps the module loaded until it is stopped.
+	static void startWriter();
+	static void stopWriter();
+
 private:
+	static void initialize();
+
 	static bool initialized;
 	static std::wstring logPath;
 	static bool enableTrace;
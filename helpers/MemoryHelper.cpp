@@ -33,6 +33,8 @@
 #undef AERT_Free
 #endif
 
+#include <atomic>
+
 #include "LogHelper.h"
 #include "MemoryHelper.h"
 
@@ -45,8 +47,16 @@ HRESULT __stdcall AERT_Free(void* pMemory);
 }
 #endif
 
+#ifdef COUNT_ALLOCATIONS
+static std::atomic<unsigned long long> allocationCount(0);
+#endif
+
 void* MemoryHelper::alloc(size_t size)
 {
+#ifdef COUNT_ALLOCATIONS
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+
 	void* memory;
 	bool alternative = false;
 	size += 16;
@@ -110,4 +120,11 @@ void MemoryHelper::free(void* ptr)
 	::free(memory);
 #endif
 #endif
-}
\ No newline at end of file
+}
+
+#ifdef COUNT_ALLOCATIONS
+unsigned long long MemoryHelper::getAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+#endif
\ No newline at end of file
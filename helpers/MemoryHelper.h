@@ -33,4 +33,8 @@ class MemoryHelper
 public:
 	static void* alloc(size_t size);
 	static void free(void* ptr);
+#ifdef COUNT_ALLOCATIONS
+	// number of allocations since the start of the process, only counted in the Benchmark to check that processing does not allocate
+	static unsigned long long getAllocationCount();
+#endif
 };
@@ -0,0 +1,107 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded queue for any number of producer threads and one consumer thread without locking. Producers never wait:
+// if the queue is full, tryAcquire fails and the producer has to drop its element. Elements are written in place
+// between tryAcquire and publish, so that large elements are not copied. capacity has to be a power of two.
+template<typename T> class MpscRing
+{
+public:
+	struct Slot
+	{
+		// equals the position of the slot while it is free, the position + 1 while it is published
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	MpscRing(size_t capacity)
+		: capacity(capacity), slots(new Slot[capacity]), writePosition(0), readPosition(0)
+	{
+		for (size_t i = 0; i < capacity; i++)
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	MpscRing(const MpscRing&) = delete;
+	MpscRing& operator=(const MpscRing&) = delete;
+
+	size_t getCapacity() const {return capacity;}
+
+	// returns NULL if the queue is full, otherwise a slot that has to be passed to publish
+	Slot* tryAcquire(size_t* position = NULL)
+	{
+		size_t pos = writePosition.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Slot& slot = slots[pos & (capacity - 1)];
+			size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			if (sequence == pos)
+			{
+				if (writePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					if (position != NULL)
+						*position = pos;
+					return &slot;
+				}
+			}
+			else if ((ptrdiff_t)(sequence - pos) < 0)
+			{
+				// the consumer has not freed this slot since the last round
+				return NULL;
+			}
+			else
+			{
+				pos = writePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void publish(Slot* slot)
+	{
+		slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// consumer only: returns the oldest element if it has been published, otherwise NULL
+	T* peek()
+	{
+		Slot& slot = slots[readPosition & (capacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != readPosition + 1)
+			return NULL;
+		return &slot.value;
+	}
+
+	// consumer only: frees the element returned by peek
+	void pop()
+	{
+		Slot& slot = slots[readPosition & (capacity - 1)];
+		slot.sequence.store(readPosition + capacity, std::memory_order_release);
+		readPosition++;
+	}
+
+private:
+	const size_t capacity;
+	std::unique_ptr<Slot[]> slots;
+	std::atomic<size_t> writePosition;
+	size_t readPosition;
+};
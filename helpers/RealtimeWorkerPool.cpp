@@ -0,0 +1,243 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <mutex>
+#include <thread>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <avrt.h>
+
+#include "RealtimeWorkerPool.h"
+
+#pragma comment(lib, "avrt.lib")
+
+using namespace std;
+
+static mutex sharedMutex;
+static RealtimeWorkerPool* sharedPool = NULL;
+static unsigned sharedUsers = 0;
+
+RealtimeWorkerPool::RealtimeWorkerPool()
+{
+	function = NULL;
+	context = NULL;
+	workerCount = 0;
+	workers = NULL;
+	shutdownEvent = NULL;
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	frequency = freq.QuadPart;
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+	cleanup();
+}
+
+void RealtimeWorkerPool::initialize(unsigned workerCount, TaskFunction function, void* context)
+{
+	cleanup();
+
+	this->function = function;
+	this->context = context;
+	this->workerCount = workerCount;
+
+	shutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	workers = new Worker[workerCount];
+	for (unsigned i = 0; i < workerCount; i++)
+	{
+		Worker& worker = workers[i];
+		worker.pool = this;
+		worker.function = function;
+		worker.context = context;
+		worker.running = NULL;
+		worker.task = 0;
+		worker.busy = false;
+		worker.workEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		worker.threadHandle = CreateThread(NULL, 0, &workerThread, &worker, 0, NULL);
+	}
+}
+
+void RealtimeWorkerPool::cleanup()
+{
+	if (workers != NULL)
+	{
+		// waits for tasks that missed their deadline as well
+		SetEvent(shutdownEvent);
+		for (unsigned i = 0; i < workerCount; i++)
+		{
+			WaitForSingleObject(workers[i].threadHandle, INFINITE);
+			CloseHandle(workers[i].threadHandle);
+			CloseHandle(workers[i].workEvent);
+		}
+		delete[] workers;
+		workers = NULL;
+	}
+	workerCount = 0;
+
+	if (shutdownEvent != NULL)
+	{
+		CloseHandle(shutdownEvent);
+		shutdownEvent = NULL;
+	}
+}
+
+RealtimeWorkerPool* RealtimeWorkerPool::acquireShared()
+{
+	lock_guard<mutex> lock(sharedMutex);
+	if (sharedPool == NULL)
+	{
+		// the calling audio thread does a share of the work itself
+		unsigned workerCount = max(thread::hardware_concurrency(), 2u) - 1;
+		sharedPool = new RealtimeWorkerPool();
+		sharedPool->initialize(workerCount, NULL, NULL);
+	}
+	sharedUsers++;
+
+	return sharedPool;
+}
+
+void RealtimeWorkerPool::releaseShared()
+{
+	lock_guard<mutex> lock(sharedMutex);
+	if (--sharedUsers == 0)
+	{
+		delete sharedPool;
+		sharedPool = NULL;
+	}
+}
+
+#pragma AVRT_CODE_BEGIN
+long long RealtimeWorkerPool::getDeadline(double seconds) const
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return now.QuadPart + (long long)(seconds * frequency);
+}
+
+bool RealtimeWorkerPool::isIdle(unsigned worker) const
+{
+	return !workers[worker].busy.load(memory_order_acquire);
+}
+
+void RealtimeWorkerPool::start(unsigned worker, unsigned task)
+{
+	workers[worker].function = function;
+	workers[worker].context = context;
+	workers[worker].running = NULL;
+	workers[worker].task.store(task, memory_order_relaxed);
+	workers[worker].busy.store(true, memory_order_release);
+	SetEvent(workers[worker].workEvent);
+}
+
+bool RealtimeWorkerPool::startAny(TaskFunction function, void* context, unsigned task, atomic<bool>& running)
+{
+	for (unsigned i = 0; i < workerCount; i++)
+	{
+		Worker& worker = workers[i];
+		bool idle = false;
+		if (worker.busy.load(memory_order_relaxed) || !worker.busy.compare_exchange_strong(idle, true, memory_order_acquire))
+			continue;
+
+		// the event orders these writes before the worker reads them
+		running.store(true, memory_order_relaxed);
+		worker.function = function;
+		worker.context = context;
+		worker.running = &running;
+		worker.task.store(task, memory_order_relaxed);
+		SetEvent(worker.workEvent);
+		return true;
+	}
+
+	return false;
+}
+
+bool RealtimeWorkerPool::join(unsigned worker, long long deadline) const
+{
+	// the remaining time is usually much shorter than the scheduler granularity, so spin instead of waiting for an event
+	while (workers[worker].busy.load(memory_order_acquire))
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		if (now.QuadPart >= deadline)
+			return false;
+		YieldProcessor();
+	}
+
+	return true;
+}
+
+bool RealtimeWorkerPool::join(const atomic<bool>& running, long long deadline) const
+{
+	// the worker may already run a task of another thread, so the task itself is waited for
+	while (running.load(memory_order_acquire))
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		if (now.QuadPart >= deadline)
+			return false;
+		YieldProcessor();
+	}
+
+	return true;
+}
+#pragma AVRT_CODE_END
+
+unsigned long __stdcall RealtimeWorkerPool::workerThread(void* parameter)
+{
+	Worker* worker = (Worker*)parameter;
+	RealtimeWorkerPool* pool = worker->pool;
+
+	void* avrtHandle = enterRealtimeScheduling();
+
+	HANDLE handles[] = {pool->shutdownEvent, worker->workEvent};
+	while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+	{
+		worker->function(worker->context, worker->task.load(memory_order_relaxed));
+		// read before the worker can be claimed again
+		atomic<bool>* running = worker->running;
+		worker->busy.store(false, memory_order_release);
+		if (running != NULL)
+			running->store(false, memory_order_release);
+	}
+
+	leaveRealtimeScheduling(avrtHandle);
+
+	return 0;
+}
+
+void* RealtimeWorkerPool::enterRealtimeScheduling()
+{
+	DWORD taskIndex = 0;
+	HANDLE avrtHandle = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
+	if (avrtHandle != NULL)
+		AvSetMmThreadPriority(avrtHandle, AVRT_PRIORITY_CRITICAL);
+	else
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+	return avrtHandle;
+}
+
+void RealtimeWorkerPool::leaveRealtimeScheduling(void* avrtHandle)
+{
+	if (avrtHandle != NULL)
+		AvRevertMmThreadCharacteristics(avrtHandle);
+}
@@ -0,0 +1,84 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <atomic>
+
+// Worker threads running at real-time priority for fork/join parallelism within one audio block.
+// Each worker runs one task at a time. A task that misses its deadline keeps its worker busy
+// until it returns, so the caller has to skip that worker instead of waiting for it.
+class RealtimeWorkerPool
+{
+public:
+	typedef void (*TaskFunction)(void* context, unsigned task);
+
+	RealtimeWorkerPool();
+	~RealtimeWorkerPool();
+
+	void initialize(unsigned workerCount, TaskFunction function, void* context);
+	void cleanup();
+	unsigned getWorkerCount() const {return workerCount;}
+
+	// Pool with one worker per additional processor that is shared by all filters of the process, so that their
+	// threads do not add up. It is created by the first call and destroyed after the last user has released it.
+	static RealtimeWorkerPool* acquireShared();
+	static void releaseShared();
+
+	// puts the calling thread into the same scheduling class as the audio thread, so its work is not preempted by
+	// normal threads, returns the handle to pass to leaveRealtimeScheduling
+	static void* enterRealtimeScheduling();
+	static void leaveRealtimeScheduling(void* avrtHandle);
+
+	// called on the audio thread
+	long long getDeadline(double seconds) const;
+	bool isIdle(unsigned worker) const;
+	// runs function(context, task) on the worker, which has to be idle
+	void start(unsigned worker, unsigned task);
+	// Claims any idle worker, also when other threads use the pool at the same time, and runs function(context, task)
+	// on it. running is set until the function has returned and cleared as the last access to the task.
+	// Returns false if all workers are busy.
+	bool startAny(TaskFunction function, void* context, unsigned task, std::atomic<bool>& running);
+	// waits until running is cleared or the deadline has passed, returns whether the task was finished
+	bool join(const std::atomic<bool>& running, long long deadline) const;
+	// waits until the worker is idle again or the deadline has passed, returns whether the task was finished
+	bool join(unsigned worker, long long deadline) const;
+
+private:
+	struct Worker
+	{
+		RealtimeWorkerPool* pool;
+		void* threadHandle;
+		void* workEvent;
+		TaskFunction function;
+		void* context;
+		std::atomic<bool>* running;
+		std::atomic<unsigned> task;
+		std::atomic<bool> busy;
+	};
+
+	static unsigned long __stdcall workerThread(void* parameter);
+
+	TaskFunction function;
+	void* context;
+	unsigned workerCount;
+	Worker* workers;
+	void* shutdownEvent;
+	long long frequency;
+};
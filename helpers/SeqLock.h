@@ -0,0 +1,70 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <atomic>
+
+// Publishes a trivially copyable value from one writer thread to any number of readers without locking.
+// Readers never block the writer, they retry if the value was changed while copying it.
+// Writes have to be serialized by the caller.
+template<typename T> class SeqLock
+{
+public:
+	SeqLock()
+		: sequence(0), value()
+	{
+	}
+
+	void write(const T& newValue)
+	{
+		unsigned s = sequence.load(std::memory_order_relaxed);
+		// an odd sequence number marks a write in progress
+		sequence.store(s + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		value = newValue;
+		sequence.store(s + 2, std::memory_order_release);
+	}
+
+	// changes with every write, so readers can cheaply check whether they need to read the value
+	unsigned getVersion() const
+	{
+		return sequence.load(std::memory_order_acquire) & ~1u;
+	}
+
+	// returns the version of the value that was copied
+	unsigned read(T& result) const
+	{
+		while (true)
+		{
+			unsigned before = sequence.load(std::memory_order_acquire);
+			if ((before & 1) == 0)
+			{
+				result = value;
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) == before)
+					return before;
+			}
+		}
+	}
+
+private:
+	std::atomic<unsigned> sequence;
+	T value;
+};
@@ -0,0 +1,167 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#include <intrin.h>
+
+#include "LogHelper.h"
+#include "StringHelper.h"
+#include "SimdHelper.h"
+
+using namespace std;
+
+atomic<const SimdKernels*> SimdHelper::kernels(NULL);
+
+SimdLevel SimdHelper::getSupportedLevel()
+{
+#ifdef _M_ARM64
+	return SimdLevel::NEON;
+#else
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool sse2 = (info[3] & (1 << 26)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!sse2)
+		return SimdLevel::SCALAR;
+
+	// the operating system has to save the vector registers on context switches
+	unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool ymmState = (xcr0 & 0x06) == 0x06;
+	bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+	bool avx2 = false;
+	bool avx512 = false;
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+		// F, DQ, BW and VL, as the compiler may use all of them for the AVX-512 kernels
+		const unsigned avx512Bits = (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31);
+		avx512 = ((unsigned)info[1] & avx512Bits) == avx512Bits;
+	}
+
+	if (avx && avx2 && fma && ymmState)
+	{
+		if (avx512 && zmmState)
+			return SimdLevel::AVX512;
+		return SimdLevel::AVX2;
+	}
+
+	return SimdLevel::SSE2;
+#endif
+}
+
+bool SimdHelper::isSupported(SimdLevel level)
+{
+	// the levels of the other architecture are not compiled in
+	return level <= getSupportedLevel() && getKernels(level).level == level;
+}
+
+SimdLevel SimdHelper::setLevel(SimdLevel level)
+{
+	SimdLevel supported = getSupportedLevel();
+	if (!isSupported(level))
+	{
+		LogFStatic(L"%s is not supported by this processor, using %s instead", getLevelName(level).c_str(), getLevelName(supported).c_str());
+		level = supported;
+	}
+
+	kernels.store(&getKernels(level), memory_order_release);
+	TraceFStatic(L"Using %s kernels", getLevelName(level).c_str());
+
+	return level;
+}
+
+wstring SimdHelper::getLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SCALAR:
+		return L"scalar";
+	case SimdLevel::SSE2:
+		return L"sse2";
+	case SimdLevel::AVX2:
+		return L"avx2";
+	case SimdLevel::AVX512:
+		return L"avx512";
+	case SimdLevel::NEON:
+		return L"neon";
+	}
+
+	return L"";
+}
+
+bool SimdHelper::parseLevel(const wstring& name, SimdLevel& level)
+{
+	wstring lowerName = StringHelper::toLowerCase(name);
+	for (SimdLevel l : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON})
+	{
+		if (lowerName == getLevelName(l))
+		{
+			level = l;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const SimdKernels* SimdHelper::selectKernels()
+{
+	SimdLevel level = getSupportedLevel();
+
+	wchar_t value[32];
+	DWORD length = GetEnvironmentVariableW(L"EQUALIZERAPO_SIMD", value, sizeof(value) / sizeof(wchar_t));
+	if (length > 0 && length < sizeof(value) / sizeof(wchar_t))
+	{
+		SimdLevel forcedLevel;
+		if (parseLevel(value, forcedLevel))
+			level = forcedLevel;
+		else
+			LogFStatic(L"Ignoring unknown value %s of EQUALIZERAPO_SIMD", value);
+	}
+
+	setLevel(level);
+	return kernels.load(memory_order_acquire);
+}
+
+const SimdKernels& SimdHelper::getKernels(SimdLevel level)
+{
+	switch (level)
+	{
+#ifdef _M_ARM64
+	case SimdLevel::NEON:
+		return simdKernelsNEON;
+#else
+	case SimdLevel::AVX512:
+		return simdKernelsAVX512;
+	case SimdLevel::AVX2:
+		return simdKernelsAVX2;
+	case SimdLevel::SSE2:
+		return simdKernelsSSE2;
+#endif
+	default:
+		return simdKernelsScalar;
+	}
+}
@@ -0,0 +1,58 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "SimdKernels.h"
+
+class SimdHelper
+{
+public:
+	// Kernels of the level selected on first use: the highest one supported by the processor and the operating system,
+	// or a lower one given by the environment variable EQUALIZERAPO_SIMD (scalar, sse2, avx2, avx512 or neon)
+	static const SimdKernels& getKernels()
+	{
+		const SimdKernels* result = kernels.load(std::memory_order_acquire);
+		if (result == NULL)
+			result = selectKernels();
+		return *result;
+	}
+
+	static SimdLevel getSupportedLevel();
+	// whether the level is compiled in and supported by the processor
+	static bool isSupported(SimdLevel level);
+	// Selects a level to compare the kernels, limited to the supported level. Must not be called while processing.
+	static SimdLevel setLevel(SimdLevel level);
+	static SimdLevel getLevel() {return getKernels().level;}
+	// Kernels of a level without checking whether it is supported, to compare them. Levels that are not compiled in
+	// return the scalar kernels.
+	static const SimdKernels& getKernels(SimdLevel level);
+
+	static std::wstring getLevelName(SimdLevel level);
+	// returns false if the name is not one of the names returned by getLevelName
+	static bool parseLevel(const std::wstring& name, SimdLevel& level);
+
+private:
+	static const SimdKernels* selectKernels();
+
+	static std::atomic<const SimdKernels*> kernels;
+};
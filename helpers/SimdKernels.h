@@ -0,0 +1,91 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+enum class SimdLevel
+{
+	SCALAR, SSE2, AVX2, AVX512, NEON
+};
+
+// SoA coefficients and states of one biquad per channel. During the first rampFrames frames, the coefficients
+// are incremented by the steps after each frame, which are only read if rampFrames is not 0.
+struct BiQuadBank
+{
+	const double* a0;
+	const double* a1;
+	const double* a2;
+	const double* b1;
+	const double* b2;
+	double* x1;
+	double* x2;
+	double* y1;
+	double* y2;
+	unsigned rampFrames;
+	const double* a0Step;
+	const double* a1Step;
+	const double* a2Step;
+	const double* b1Step;
+	const double* b2Step;
+};
+
+// Kernels of one instruction set level. Each kernel processes what its vector width allows and passes the rest on to
+// the kernel of the next lower level, so the results only depend on the selected level.
+struct SimdKernels
+{
+	// number of output channels computed together by mix
+	static const unsigned MIX_SIZE = 4;
+
+	SimdLevel level;
+
+	void (*convertFloatToDouble)(double* dest, const float* src, size_t count);
+	void (*convertDoubleToFloat)(float* dest, const double* src, size_t count);
+	void (*scale)(double* dest, const double* src, double gain, size_t count);
+
+	// processes the channels from startChannel up to endChannel
+	void (*biQuad)(const BiQuadBank& bank, double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned endChannel);
+
+	// outputs[j][f] = constants[j] + sum of factors[k * MIX_SIZE + j] * input[inputs[k]][f] for frames from startFrame up to endFrame
+	void (*mix)(double* const* outputs, double** input, const unsigned* inputs, unsigned inputCount,
+		const double* factors, const double* constants, unsigned startFrame, unsigned endFrame);
+
+	// splits count interleaved complex numbers into real and imaginary parts
+	void (*deinterleave)(double* real, double* imag, const double* complex, size_t count);
+	void (*deinterleaveFloat)(float* real, float* imag, const float* complex, size_t count);
+
+	// y += x * h for count complex numbers in split form
+	void (*complexMultiplyAdd)(double* yReal, double* yImag, const double* xReal, const double* xImag,
+		const double* hReal, const double* hImag, size_t count);
+	// same for float, y and h must be aligned to 64 bytes
+	void (*complexMultiplyAddFloat)(float* yReal, float* yImag, const float* xReal, const float* xImag,
+		const float* hReal, const float* hImag, size_t count);
+
+	double (*dotProduct)(const double* a, const double* b, size_t count);
+};
+
+extern const SimdKernels simdKernelsScalar;
+#ifdef _M_ARM64
+extern const SimdKernels simdKernelsNEON;
+#else
+extern const SimdKernels simdKernelsSSE2;
+extern const SimdKernels simdKernelsAVX2;
+extern const SimdKernels simdKernelsAVX512;
+#endif
@@ -0,0 +1,34 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#ifndef _M_ARM64
+
+#include "MemoryHelper.h"
+#include "SimdKernelsImpl.h"
+
+// Compiled with /arch:AVX2, only called if the processor supports AVX2 and FMA
+
+#pragma AVRT_CODE_BEGIN
+// what does not fill 256 bit still gets 128 bit FMA, which is what stereo biquads use
+static const SimdKernels simdKernelsFMA128 = SimdKernelsImpl<SimdFMA128, simdKernelsScalar>::create(SimdLevel::AVX2);
+
+extern const SimdKernels simdKernelsAVX2 = SimdKernelsImpl<SimdAVX2, simdKernelsFMA128>::create(SimdLevel::AVX2);
+#pragma AVRT_CODE_END
+#endif
@@ -0,0 +1,253 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include "SimdKernels.h"
+#include "SimdVector.h"
+
+// The kernels written once on top of SimdVector. Each instruction set level instantiates them with its tag Isa and
+// the kernels of the next lower level, which get what does not fill a whole vector, so that only the scalar kernels
+// with a width of 1 never pass anything on.
+template<class Isa, const SimdKernels& next>
+class SimdKernelsImpl
+{
+public:
+	static constexpr SimdKernels create(SimdLevel level)
+	{
+		return {
+			level,
+			convertFloatToDouble,
+			convertDoubleToFloat,
+			scale,
+			biQuad,
+			mix,
+			deinterleave,
+			deinterleaveFloat,
+			complexMultiplyAdd,
+			complexMultiplyAddFloat,
+			dotProduct
+		};
+	}
+
+private:
+	typedef SimdVector<Isa, double> D;
+	typedef SimdVector<Isa, float> F;
+	typedef typename D::Type DV;
+	typedef typename F::Type FV;
+
+	static void convertFloatToDouble(double* dest, const float* src, size_t count)
+	{
+		size_t i = 0;
+		for (; i + D::WIDTH <= count; i += D::WIDTH)
+			D::store(dest + i, D::loadFloat(src + i));
+		if (i < count)
+			next.convertFloatToDouble(dest + i, src + i, count - i);
+	}
+
+	static void convertDoubleToFloat(float* dest, const double* src, size_t count)
+	{
+		size_t i = 0;
+		for (; i + D::WIDTH <= count; i += D::WIDTH)
+			D::storeFloat(dest + i, D::load(src + i));
+		if (i < count)
+			next.convertDoubleToFloat(dest + i, src + i, count - i);
+	}
+
+	static void scale(double* dest, const double* src, double gain, size_t count)
+	{
+		const DV gainVec = D::set1(gain);
+		size_t i = 0;
+		for (; i + D::WIDTH <= count; i += D::WIDTH)
+			D::store(dest + i, D::mul(D::load(src + i), gainVec));
+		if (i < count)
+			next.scale(dest + i, src + i, gain, count - i);
+	}
+
+	// c holds a0, a1, a2, b1, b2 and s holds x1, x2, y1, y2
+	static __forceinline DV biQuadSample(DV x, const DV (&c)[5], DV (&s)[4])
+	{
+		DV y = D::mul(c[0], x);
+		y = D::mulAdd(c[3], s[0], y);
+		y = D::mulAdd(c[4], s[1], y);
+		y = D::negMulAdd(c[1], s[2], y);
+		y = D::negMulAdd(c[2], s[3], y);
+
+		s[1] = s[0]; s[0] = x;
+		s[3] = s[2]; s[2] = y;
+		return y;
+	}
+
+	// one channel per vector element, with separate loops for the frames with and without coefficient ramp
+	static void biQuad(const BiQuadBank& bank, double** output, double** input, unsigned frameCount, unsigned startChannel, unsigned endChannel)
+	{
+		const unsigned rampFrames = bank.rampFrames < frameCount ? bank.rampFrames : frameCount;
+		unsigned i = startChannel;
+		for (; i + D::WIDTH <= endChannel; i += D::WIDTH)
+		{
+			DV c[5] = {D::load(&bank.a0[i]), D::load(&bank.a1[i]), D::load(&bank.a2[i]),
+				D::load(&bank.b1[i]), D::load(&bank.b2[i])};
+			DV s[4] = {D::load(&bank.x1[i]), D::load(&bank.x2[i]), D::load(&bank.y1[i]), D::load(&bank.y2[i])};
+
+			if (rampFrames > 0)
+			{
+				const DV step[5] = {D::load(&bank.a0Step[i]), D::load(&bank.a1Step[i]), D::load(&bank.a2Step[i]),
+					D::load(&bank.b1Step[i]), D::load(&bank.b2Step[i])};
+				for (unsigned j = 0; j < rampFrames; j++)
+				{
+					D::scatter(output + i, j, biQuadSample(D::gather(input + i, j), c, s));
+
+					for (unsigned k = 0; k < 5; k++)
+						c[k] = D::add(c[k], step[k]);
+				}
+			}
+			for (unsigned j = rampFrames; j < frameCount; j++)
+				D::scatter(output + i, j, biQuadSample(D::gather(input + i, j), c, s));
+
+			D::store(&bank.x1[i], s[0]);
+			D::store(&bank.x2[i], s[1]);
+			D::store(&bank.y1[i], s[2]);
+			D::store(&bank.y2[i], s[3]);
+		}
+		if (i < endChannel)
+			next.biQuad(bank, output, input, frameCount, i, endChannel);
+	}
+
+	// one frame per vector element
+	static void mix(double* const* outputs, double** input, const unsigned* inputs, unsigned inputCount,
+		const double* factors, const double* constants, unsigned startFrame, unsigned endFrame)
+	{
+		static_assert(SimdKernels::MIX_SIZE == 4, "the accumulators are unrolled");
+
+		unsigned f = startFrame;
+		for (; f + D::WIDTH <= endFrame; f += D::WIDTH)
+		{
+			DV acc0 = D::set1(constants[0]);
+			DV acc1 = D::set1(constants[1]);
+			DV acc2 = D::set1(constants[2]);
+			DV acc3 = D::set1(constants[3]);
+			for (unsigned k = 0; k < inputCount; k++)
+			{
+				DV x = D::load(input[inputs[k]] + f);
+				const double* factor = factors + k * SimdKernels::MIX_SIZE;
+				acc0 = D::mulAdd(D::set1(factor[0]), x, acc0);
+				acc1 = D::mulAdd(D::set1(factor[1]), x, acc1);
+				acc2 = D::mulAdd(D::set1(factor[2]), x, acc2);
+				acc3 = D::mulAdd(D::set1(factor[3]), x, acc3);
+			}
+			D::store(outputs[0] + f, acc0);
+			D::store(outputs[1] + f, acc1);
+			D::store(outputs[2] + f, acc2);
+			D::store(outputs[3] + f, acc3);
+		}
+		if (f < endFrame)
+			next.mix(outputs, input, inputs, inputCount, factors, constants, f, endFrame);
+	}
+
+	static void deinterleave(double* real, double* imag, const double* complex, size_t count)
+	{
+		size_t j = 0;
+		for (; j + D::WIDTH <= count; j += D::WIDTH)
+		{
+			DV realVec, imagVec;
+			D::deinterleave(D::load(complex + 2 * j), D::load(complex + 2 * j + D::WIDTH), realVec, imagVec);
+			D::store(real + j, realVec);
+			D::store(imag + j, imagVec);
+		}
+		if (j < count)
+			next.deinterleave(real + j, imag + j, complex + 2 * j, count - j);
+	}
+
+	static void deinterleaveFloat(float* real, float* imag, const float* complex, size_t count)
+	{
+		size_t j = 0;
+		for (; j + F::WIDTH <= count; j += F::WIDTH)
+		{
+			FV realVec, imagVec;
+			F::deinterleave(F::load(complex + 2 * j), F::load(complex + 2 * j + F::WIDTH), realVec, imagVec);
+			F::store(real + j, realVec);
+			F::store(imag + j, imagVec);
+		}
+		if (j < count)
+			next.deinterleaveFloat(real + j, imag + j, complex + 2 * j, count - j);
+	}
+
+	static void complexMultiplyAdd(double* yReal, double* yImag, const double* xReal, const double* xImag,
+		const double* hReal, const double* hImag, size_t count)
+	{
+		size_t n = 0;
+		for (; n + D::WIDTH <= count; n += D::WIDTH)
+		{
+			const DV xr = D::load(xReal + n);
+			const DV xi = D::load(xImag + n);
+			const DV hr = D::load(hReal + n);
+			const DV hi = D::load(hImag + n);
+
+			// yr += xr*hr - xi*hi, yi += xr*hi + xi*hr
+			DV yr = D::negMulAdd(xi, hi, D::mulAdd(xr, hr, D::load(yReal + n)));
+			DV yi = D::mulAdd(xi, hr, D::mulAdd(xr, hi, D::load(yImag + n)));
+
+			D::store(yReal + n, yr);
+			D::store(yImag + n, yi);
+		}
+		if (n < count)
+			next.complexMultiplyAdd(yReal + n, yImag + n, xReal + n, xImag + n, hReal + n, hImag + n, count - n);
+	}
+
+	static void complexMultiplyAddFloat(float* yReal, float* yImag, const float* xReal, const float* xImag,
+		const float* hReal, const float* hImag, size_t count)
+	{
+		size_t n = 0;
+		for (; n + F::WIDTH <= count; n += F::WIDTH)
+		{
+			const FV xr = F::load(xReal + n);
+			const FV xi = F::load(xImag + n);
+			const FV hr = F::loadAligned(hReal + n);
+			const FV hi = F::loadAligned(hImag + n);
+
+			FV yr = F::negMulAdd(xi, hi, F::mulAdd(xr, hr, F::loadAligned(yReal + n)));
+			FV yi = F::mulAdd(xi, hr, F::mulAdd(xr, hi, F::loadAligned(yImag + n)));
+
+			F::storeAligned(yReal + n, yr);
+			F::storeAligned(yImag + n, yi);
+		}
+		if (n < count)
+			next.complexMultiplyAddFloat(yReal + n, yImag + n, xReal + n, xImag + n, hReal + n, hImag + n, count - n);
+	}
+
+	// two accumulators to hide the latency of the additions
+	static double dotProduct(const double* a, const double* b, size_t count)
+	{
+		DV acc0 = D::zero();
+		DV acc1 = D::zero();
+		size_t i = 0;
+		for (; i + 2 * D::WIDTH <= count; i += 2 * D::WIDTH)
+		{
+			acc0 = D::mulAdd(D::load(a + i), D::load(b + i), acc0);
+			acc1 = D::mulAdd(D::load(a + i + D::WIDTH), D::load(b + i + D::WIDTH), acc1);
+		}
+		for (; i + D::WIDTH <= count; i += D::WIDTH)
+			acc0 = D::mulAdd(D::load(a + i), D::load(b + i), acc0);
+
+		double sum = D::reduceAdd(D::add(acc0, acc1));
+		if (i < count)
+			sum += next.dotProduct(a + i, b + i, count - i);
+		return sum;
+	}
+};
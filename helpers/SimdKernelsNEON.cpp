@@ -0,0 +1,31 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#ifdef _M_ARM64
+
+#include "MemoryHelper.h"
+#include "SimdKernelsImpl.h"
+
+// NEON with FMA is part of every ARM64 processor
+
+#pragma AVRT_CODE_BEGIN
+extern const SimdKernels simdKernelsNEON = SimdKernelsImpl<SimdNEON, simdKernelsScalar>::create(SimdLevel::NEON);
+#pragma AVRT_CODE_END
+#endif
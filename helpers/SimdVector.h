@@ -0,0 +1,397 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <cstddef>
+#ifdef _M_ARM64
+#include <arm_neon.h>
+#else
+#include <immintrin.h>
+#endif
+
+// Every translation unit gets its own copy, so that the linker never uses the functions of a unit compiled with
+// a higher /arch in a unit for a lower one when they are not inlined, as in debug builds
+namespace {
+
+// Instruction sets that SimdVector is specialized for
+struct SimdScalar {};
+#ifdef _M_ARM64
+struct SimdNEON {};
+#else
+struct SimdSSE2 {};
+// SSE2 registers with the fused multiply-add of AVX2 processors
+struct SimdFMA128 {};
+struct SimdAVX2 {};
+struct SimdAVX512 {};
+#endif
+
+// Vector of WIDTH elements of type T (double or float) in the registers of the instruction set Isa. All operations
+// are static functions on the register type Type, so that kernels can be written once as templates and instantiated
+// for every instruction set. mulAdd(a, b, c) computes a * b + c, negMulAdd(a, b, c) computes c - a * b, both fused
+// if the instruction set has fused multiply-add. load and store are unaligned, loadAligned and storeAligned need
+// an alignment of WIDTH elements. For double, gather and scatter access element index of WIDTH consecutive rows,
+// loadFloat and storeFloat convert from and to WIDTH floats. deinterleave splits the elements of two vectors into
+// those with even and odd index.
+template<class Isa, class T>
+struct SimdVector;
+
+template<class T>
+struct SimdVector<SimdScalar, T>
+{
+	typedef T Type;
+	static const unsigned WIDTH = 1;
+
+	static __forceinline Type load(const T* p) {return *p;}
+	static __forceinline Type loadAligned(const T* p) {return *p;}
+	static __forceinline void store(T* p, Type v) {*p = v;}
+	static __forceinline void storeAligned(T* p, Type v) {*p = v;}
+	static __forceinline Type set1(T value) {return value;}
+	static __forceinline Type zero() {return 0;}
+
+	static __forceinline Type add(Type a, Type b) {return a + b;}
+	static __forceinline Type sub(Type a, Type b) {return a - b;}
+	static __forceinline Type mul(Type a, Type b) {return a * b;}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return a * b + c;}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return c - a * b;}
+	static __forceinline T reduceAdd(Type v) {return v;}
+
+	static __forceinline Type gather(T* const* rows, size_t index) {return rows[0][index];}
+	static __forceinline void scatter(T* const* rows, size_t index, Type v) {rows[0][index] = v;}
+	static __forceinline Type loadFloat(const float* p) {return (T)*p;}
+	static __forceinline void storeFloat(float* p, Type v) {*p = (float)v;}
+
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		even = a;
+		odd = b;
+	}
+};
+
+#ifndef _M_ARM64
+template<>
+struct SimdVector<SimdSSE2, double>
+{
+	typedef __m128d Type;
+	static const unsigned WIDTH = 2;
+
+	static __forceinline Type load(const double* p) {return _mm_loadu_pd(p);}
+	static __forceinline Type loadAligned(const double* p) {return _mm_load_pd(p);}
+	static __forceinline void store(double* p, Type v) {_mm_storeu_pd(p, v);}
+	static __forceinline void storeAligned(double* p, Type v) {_mm_store_pd(p, v);}
+	static __forceinline Type set1(double value) {return _mm_set1_pd(value);}
+	static __forceinline Type zero() {return _mm_setzero_pd();}
+
+	static __forceinline Type add(Type a, Type b) {return _mm_add_pd(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return _mm_sub_pd(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return _mm_mul_pd(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm_add_pd(_mm_mul_pd(a, b), c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm_sub_pd(c, _mm_mul_pd(a, b));}
+	static __forceinline double reduceAdd(Type v) {return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));}
+
+	static __forceinline Type gather(double* const* rows, size_t index)
+	{
+		return _mm_set_pd(rows[1][index], rows[0][index]);
+	}
+
+	static __forceinline void scatter(double* const* rows, size_t index, Type v)
+	{
+		_mm_storel_pd(&rows[0][index], v);
+		_mm_storeh_pd(&rows[1][index], v);
+	}
+
+	static __forceinline Type loadFloat(const float* p)
+	{
+		return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)p)));
+	}
+
+	static __forceinline void storeFloat(float* p, Type v)
+	{
+		_mm_storel_epi64((__m128i*)p, _mm_castps_si128(_mm_cvtpd_ps(v)));
+	}
+
+	// a = [r0 i0], b = [r1 i1]
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		even = _mm_shuffle_pd(a, b, 0x0);
+		odd = _mm_shuffle_pd(a, b, 0x3);
+	}
+};
+
+template<>
+struct SimdVector<SimdSSE2, float>
+{
+	typedef __m128 Type;
+	static const unsigned WIDTH = 4;
+
+	static __forceinline Type load(const float* p) {return _mm_loadu_ps(p);}
+	static __forceinline Type loadAligned(const float* p) {return _mm_load_ps(p);}
+	static __forceinline void store(float* p, Type v) {_mm_storeu_ps(p, v);}
+	static __forceinline void storeAligned(float* p, Type v) {_mm_store_ps(p, v);}
+	static __forceinline Type set1(float value) {return _mm_set1_ps(value);}
+	static __forceinline Type zero() {return _mm_setzero_ps();}
+
+	static __forceinline Type add(Type a, Type b) {return _mm_add_ps(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return _mm_sub_ps(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return _mm_mul_ps(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm_add_ps(_mm_mul_ps(a, b), c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm_sub_ps(c, _mm_mul_ps(a, b));}
+
+	// a = [r0 i0 r1 i1], b = [r2 i2 r3 i3]
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+		odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+};
+
+template<>
+struct SimdVector<SimdFMA128, double> : SimdVector<SimdSSE2, double>
+{
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm_fmadd_pd(a, b, c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm_fnmadd_pd(a, b, c);}
+};
+
+template<>
+struct SimdVector<SimdFMA128, float> : SimdVector<SimdSSE2, float>
+{
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm_fmadd_ps(a, b, c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm_fnmadd_ps(a, b, c);}
+};
+
+template<>
+struct SimdVector<SimdAVX2, double>
+{
+	typedef __m256d Type;
+	static const unsigned WIDTH = 4;
+
+	static __forceinline Type load(const double* p) {return _mm256_loadu_pd(p);}
+	static __forceinline Type loadAligned(const double* p) {return _mm256_load_pd(p);}
+	static __forceinline void store(double* p, Type v) {_mm256_storeu_pd(p, v);}
+	static __forceinline void storeAligned(double* p, Type v) {_mm256_store_pd(p, v);}
+	static __forceinline Type set1(double value) {return _mm256_set1_pd(value);}
+	static __forceinline Type zero() {return _mm256_setzero_pd();}
+
+	static __forceinline Type add(Type a, Type b) {return _mm256_add_pd(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return _mm256_sub_pd(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return _mm256_mul_pd(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm256_fmadd_pd(a, b, c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm256_fnmadd_pd(a, b, c);}
+
+	static __forceinline double reduceAdd(Type v)
+	{
+		__m128d half = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+		return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+	}
+
+	static __forceinline Type gather(double* const* rows, size_t index)
+	{
+		return _mm256_set_pd(rows[3][index], rows[2][index], rows[1][index], rows[0][index]);
+	}
+
+	static __forceinline void scatter(double* const* rows, size_t index, Type v)
+	{
+		double values[WIDTH];
+		_mm256_storeu_pd(values, v);
+		for (unsigned k = 0; k < WIDTH; k++)
+			rows[k][index] = values[k];
+	}
+
+	static __forceinline Type loadFloat(const float* p) {return _mm256_cvtps_pd(_mm_loadu_ps(p));}
+	static __forceinline void storeFloat(float* p, Type v) {_mm_storeu_ps(p, _mm256_cvtpd_ps(v));}
+
+	// a = [r0 i0 r1 i1], b = [r2 i2 r3 i3]
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		// [r0 r2 r1 r3] and [i0 i2 i1 i3], then 0xD8 selects the lanes [0,2,1,3]
+		even = _mm256_permute4x64_pd(_mm256_shuffle_pd(a, b, 0x0), 0xD8);
+		odd = _mm256_permute4x64_pd(_mm256_shuffle_pd(a, b, 0xF), 0xD8);
+	}
+};
+
+template<>
+struct SimdVector<SimdAVX2, float>
+{
+	typedef __m256 Type;
+	static const unsigned WIDTH = 8;
+
+	static __forceinline Type load(const float* p) {return _mm256_loadu_ps(p);}
+	static __forceinline Type loadAligned(const float* p) {return _mm256_load_ps(p);}
+	static __forceinline void store(float* p, Type v) {_mm256_storeu_ps(p, v);}
+	static __forceinline void storeAligned(float* p, Type v) {_mm256_store_ps(p, v);}
+	static __forceinline Type set1(float value) {return _mm256_set1_ps(value);}
+	static __forceinline Type zero() {return _mm256_setzero_ps();}
+
+	static __forceinline Type add(Type a, Type b) {return _mm256_add_ps(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return _mm256_sub_ps(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return _mm256_mul_ps(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm256_fmadd_ps(a, b, c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm256_fnmadd_ps(a, b, c);}
+
+	// a = [r0 i0 r1 i1 | r2 i2 r3 i3], b = [r4 i4 r5 i5 | r6 i6 r7 i7]
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		// per 128-bit lane: [r0 r1 r4 r5 | r2 r3 r6 r7], then swap the middle pairs
+		__m256d evenTmp = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m256d oddTmp = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		even = _mm256_castpd_ps(_mm256_permute4x64_pd(evenTmp, 0xD8));
+		odd = _mm256_castpd_ps(_mm256_permute4x64_pd(oddTmp, 0xD8));
+	}
+};
+
+template<>
+struct SimdVector<SimdAVX512, double>
+{
+	typedef __m512d Type;
+	static const unsigned WIDTH = 8;
+
+	static __forceinline Type load(const double* p) {return _mm512_loadu_pd(p);}
+	static __forceinline Type loadAligned(const double* p) {return _mm512_load_pd(p);}
+	static __forceinline void store(double* p, Type v) {_mm512_storeu_pd(p, v);}
+	static __forceinline void storeAligned(double* p, Type v) {_mm512_store_pd(p, v);}
+	static __forceinline Type set1(double value) {return _mm512_set1_pd(value);}
+	static __forceinline Type zero() {return _mm512_setzero_pd();}
+
+	static __forceinline Type add(Type a, Type b) {return _mm512_add_pd(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return _mm512_sub_pd(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return _mm512_mul_pd(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm512_fmadd_pd(a, b, c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm512_fnmadd_pd(a, b, c);}
+	static __forceinline double reduceAdd(Type v) {return _mm512_reduce_add_pd(v);}
+
+	static __forceinline Type gather(double* const* rows, size_t index)
+	{
+		return _mm512_set_pd(rows[7][index], rows[6][index], rows[5][index], rows[4][index],
+			rows[3][index], rows[2][index], rows[1][index], rows[0][index]);
+	}
+
+	static __forceinline void scatter(double* const* rows, size_t index, Type v)
+	{
+		double values[WIDTH];
+		_mm512_storeu_pd(values, v);
+		for (unsigned k = 0; k < WIDTH; k++)
+			rows[k][index] = values[k];
+	}
+
+	static __forceinline Type loadFloat(const float* p) {return _mm512_cvtps_pd(_mm256_loadu_ps(p));}
+	static __forceinline void storeFloat(float* p, Type v) {_mm256_storeu_ps(p, _mm512_cvtpd_ps(v));}
+
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		// 0..7 select from a, 8..15 from b
+		even = _mm512_permutex2var_pd(a, _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14), b);
+		odd = _mm512_permutex2var_pd(a, _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15), b);
+	}
+};
+
+template<>
+struct SimdVector<SimdAVX512, float>
+{
+	typedef __m512 Type;
+	static const unsigned WIDTH = 16;
+
+	static __forceinline Type load(const float* p) {return _mm512_loadu_ps(p);}
+	static __forceinline Type loadAligned(const float* p) {return _mm512_load_ps(p);}
+	static __forceinline void store(float* p, Type v) {_mm512_storeu_ps(p, v);}
+	static __forceinline void storeAligned(float* p, Type v) {_mm512_store_ps(p, v);}
+	static __forceinline Type set1(float value) {return _mm512_set1_ps(value);}
+	static __forceinline Type zero() {return _mm512_setzero_ps();}
+
+	static __forceinline Type add(Type a, Type b) {return _mm512_add_ps(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return _mm512_sub_ps(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return _mm512_mul_ps(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return _mm512_fmadd_ps(a, b, c);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return _mm512_fnmadd_ps(a, b, c);}
+
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		even = _mm512_permutex2var_ps(a, _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30), b);
+		odd = _mm512_permutex2var_ps(a, _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31), b);
+	}
+};
+#else
+template<>
+struct SimdVector<SimdNEON, double>
+{
+	typedef float64x2_t Type;
+	static const unsigned WIDTH = 2;
+
+	static __forceinline Type load(const double* p) {return vld1q_f64(p);}
+	static __forceinline Type loadAligned(const double* p) {return vld1q_f64(p);}
+	static __forceinline void store(double* p, Type v) {vst1q_f64(p, v);}
+	static __forceinline void storeAligned(double* p, Type v) {vst1q_f64(p, v);}
+	static __forceinline Type set1(double value) {return vdupq_n_f64(value);}
+	static __forceinline Type zero() {return vdupq_n_f64(0.0);}
+
+	static __forceinline Type add(Type a, Type b) {return vaddq_f64(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return vsubq_f64(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return vmulq_f64(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return vfmaq_f64(c, a, b);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return vfmsq_f64(c, a, b);}
+	static __forceinline double reduceAdd(Type v) {return vaddvq_f64(v);}
+
+	static __forceinline Type gather(double* const* rows, size_t index)
+	{
+		return vcombine_f64(vld1_f64(&rows[0][index]), vld1_f64(&rows[1][index]));
+	}
+
+	static __forceinline void scatter(double* const* rows, size_t index, Type v)
+	{
+		vst1q_lane_f64(&rows[0][index], v, 0);
+		vst1q_lane_f64(&rows[1][index], v, 1);
+	}
+
+	static __forceinline Type loadFloat(const float* p) {return vcvt_f64_f32(vld1_f32(p));}
+	static __forceinline void storeFloat(float* p, Type v) {vst1_f32(p, vcvt_f32_f64(v));}
+
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		even = vuzp1q_f64(a, b);
+		odd = vuzp2q_f64(a, b);
+	}
+};
+
+template<>
+struct SimdVector<SimdNEON, float>
+{
+	typedef float32x4_t Type;
+	static const unsigned WIDTH = 4;
+
+	static __forceinline Type load(const float* p) {return vld1q_f32(p);}
+	static __forceinline Type loadAligned(const float* p) {return vld1q_f32(p);}
+	static __forceinline void store(float* p, Type v) {vst1q_f32(p, v);}
+	static __forceinline void storeAligned(float* p, Type v) {vst1q_f32(p, v);}
+	static __forceinline Type set1(float value) {return vdupq_n_f32(value);}
+	static __forceinline Type zero() {return vdupq_n_f32(0.0f);}
+
+	static __forceinline Type add(Type a, Type b) {return vaddq_f32(a, b);}
+	static __forceinline Type sub(Type a, Type b) {return vsubq_f32(a, b);}
+	static __forceinline Type mul(Type a, Type b) {return vmulq_f32(a, b);}
+	static __forceinline Type mulAdd(Type a, Type b, Type c) {return vfmaq_f32(c, a, b);}
+	static __forceinline Type negMulAdd(Type a, Type b, Type c) {return vfmsq_f32(c, a, b);}
+
+	static __forceinline void deinterleave(Type a, Type b, Type& even, Type& odd)
+	{
+		even = vuzp1q_f32(a, b);
+		odd = vuzp2q_f32(a, b);
+	}
+};
+#endif
+
+}
@@ -213,3 +213,65 @@ vector<wstring> StringHelper::splitQuoted(const wstring& s, wchar_t splitChar, w
 
 	return result;
 }
+
+size_t StringHelper::skipWhitespace(const wstring& s, size_t pos)
+{
+	while (pos < s.length() && iswspace(s[pos]))
+		pos++;
+
+	return pos;
+}
+
+size_t StringHelper::skipNumber(const wstring& s, size_t pos, bool allowNbsp)
+{
+	while (pos < s.length())
+	{
+		wchar_t c = s[pos];
+		if (!(c >= L'0' && c <= L'9' || c == L'.' || c == L'-' || c == L'+' || c == L'e' || c == L'E' || allowNbsp && c == L'\u00A0'))
+			break;
+		pos++;
+	}
+
+	return pos;
+}
+
+static const wchar_t guidPattern[] = L"{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}";
+static const size_t guidLength = sizeof(guidPattern) / sizeof(guidPattern[0]) - 1;
+
+bool StringHelper::isGuidAt(const wstring& s, size_t pos)
+{
+	if (pos + guidLength > s.length())
+		return false;
+
+	for (size_t i = 0; i < guidLength; i++)
+	{
+		wchar_t c = s[pos + i];
+		if (guidPattern[i] == L'x')
+		{
+			if (!(c >= L'0' && c <= L'9' || c >= L'a' && c <= L'f' || c >= L'A' && c <= L'F'))
+				return false;
+		}
+		else if (c != guidPattern[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+wstring StringHelper::removeGuids(const wstring& s)
+{
+	wstring result;
+	result.reserve(s.length());
+
+	for (size_t i = 0; i < s.length(); i++)
+	{
+		if (s[i] == L'{' && isGuidAt(s, i))
+			i += guidLength - 1;
+		else
+			result += s[i];
+	}
+
+	return result;
+}
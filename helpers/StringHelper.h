@@ -37,4 +37,13 @@ public:
 	static std::wstring join(const std::vector<std::wstring>& strings, const std::wstring& separator);
 	static std::wstring getSystemErrorString(long status);
 	static std::vector<std::wstring> splitQuoted(const std::wstring& s, wchar_t splitChar, wchar_t quoteChar = '"');
+
+	// helpers for scanning configuration lines without regular expressions
+	// returns the position of the first non-whitespace character at or after pos
+	static size_t skipWhitespace(const std::wstring& s, size_t pos);
+	// returns the end of the run of characters from [-+0-9.eE] starting at pos, also accepting non-breaking spaces if requested
+	static size_t skipNumber(const std::wstring& s, size_t pos, bool allowNbsp = false);
+	// returns true if s contains a GUID in the form {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx} at pos
+	static bool isGuidAt(const std::wstring& s, size_t pos);
+	static std::wstring removeGuids(const std::wstring& s);
 };
@@ -0,0 +1,258 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "LogHelper.h"
+#include "MemoryHelper.h"
+#include "RealtimeWorkerPool.h"
+#include "ThreadedConvolver.h"
+
+using namespace std;
+
+ThreadedConvolver::ThreadedConvolver()
+{
+	channelCount = 0;
+	frameCount = 0;
+	headFilters = NULL;
+	tailFilters = NULL;
+	inputSlots = NULL;
+	outputSlots = NULL;
+	workerHandle = NULL;
+	workEvent = NULL;
+	shutdownEvent = NULL;
+}
+
+ThreadedConvolver::~ThreadedConvolver()
+{
+	cleanup();
+}
+
+void ThreadedConvolver::initialize(double** impulseResponses, const unsigned* lengths, unsigned channelCount, unsigned frameCount)
+{
+	cleanup();
+
+	this->channelCount = channelCount;
+	this->frameCount = frameCount;
+	unsigned headLength = HEAD_PARTITIONS * frameCount;
+	double zero = 0.0;
+
+	headFilters = (HConvSingle*)MemoryHelper::alloc(sizeof(HConvSingle) * channelCount);
+	tailFilters = (HConvSingle*)MemoryHelper::alloc(sizeof(HConvSingle) * channelCount);
+	for (unsigned i = 0; i < channelCount; i++)
+	{
+		hcInitSingle(&headFilters[i], impulseResponses[i], min(lengths[i], headLength), frameCount, 1);
+		if (lengths[i] > headLength)
+			hcInitSingle(&tailFilters[i], impulseResponses[i] + headLength, lengths[i] - headLength, frameCount, 1);
+		else
+			hcInitSingle(&tailFilters[i], &zero, 1, frameCount, 1);
+	}
+
+	size_t slotSize = sizeof(double) * SLOT_COUNT * channelCount * frameCount;
+	inputSlots = (double*)MemoryHelper::alloc(slotSize);
+	memset(inputSlots, 0, slotSize);
+	outputSlots = (double*)MemoryHelper::alloc(slotSize);
+	memset(outputSlots, 0, slotSize);
+	for (unsigned i = 0; i < SLOT_COUNT; i++)
+	{
+		inputTags[i] = -1;
+		outputTags[i] = -1;
+	}
+
+	blockIndex = 0;
+	tailReady = false;
+	workerBlockIndex = 0;
+	reportedMissedBlocks = 0;
+	missedBlocks = 0;
+
+	workEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	shutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	workerHandle = CreateThread(NULL, 0, &workerThread, this, 0, NULL);
+
+	TraceF(L"Computing convolution tail after %d samples on worker thread", headLength);
+}
+
+#pragma AVRT_CODE_BEGIN
+void ThreadedConvolver::beginBlock()
+{
+	// the tail belonging to this block was computed from the input of HEAD_PARTITIONS blocks before
+	long long neededBlock = blockIndex - HEAD_PARTITIONS;
+	tailReady = false;
+	if (neededBlock >= 0)
+	{
+		if (outputTags[neededBlock % SLOT_COUNT].load(memory_order_acquire) == neededBlock)
+			tailReady = true;
+		else
+			missedBlocks.fetch_add(1, memory_order_relaxed);
+	}
+
+	// like SeqLock::write, the fence keeps the writes to the slot from becoming visible before the invalid tag
+	inputTags[blockIndex % SLOT_COUNT].store(-1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+void ThreadedConvolver::process(unsigned channel, double* output, double* input)
+{
+	// copy first so that input and output may point to the same buffer
+	memcpy(inputSlot(blockIndex % SLOT_COUNT, channel), input, frameCount * sizeof(double));
+
+	HConvSingle* filter = &headFilters[channel];
+	hcPutSingle(filter, input);
+	hcProcessSingle(filter);
+	hcGetSingle(filter, output);
+
+	if (tailReady)
+	{
+		double* tail = outputSlot((blockIndex - HEAD_PARTITIONS) % SLOT_COUNT, channel);
+		for (unsigned i = 0; i < frameCount; i++)
+			output[i] += tail[i];
+	}
+}
+
+void ThreadedConvolver::endBlock()
+{
+	inputTags[blockIndex % SLOT_COUNT].store(blockIndex, memory_order_release);
+	SetEvent(workEvent);
+	blockIndex++;
+}
+#pragma AVRT_CODE_END
+
+void ThreadedConvolver::scale(unsigned channel, double gain)
+{
+	// the worker only touches the tail filters after the first block has been submitted
+	hcScaleSingle(&headFilters[channel], gain);
+	hcScaleSingle(&tailFilters[channel], gain);
+}
+
+unsigned long __stdcall ThreadedConvolver::workerThread(void* parameter)
+{
+	ThreadedConvolver* convolver = (ThreadedConvolver*)parameter;
+
+	// registered like the workers of RealtimeWorkerPool, as the tail has to be ready a few blocks later
+	void* avrtHandle = RealtimeWorkerPool::enterRealtimeScheduling();
+
+	HANDLE handles[] = {convolver->shutdownEvent, convolver->workEvent};
+	while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+		convolver->processTail();
+
+	RealtimeWorkerPool::leaveRealtimeScheduling(avrtHandle);
+
+	return 0;
+}
+
+void ThreadedConvolver::processTail()
+{
+	while (true)
+	{
+		unsigned slot = workerBlockIndex % SLOT_COUNT;
+		long long tag = inputTags[slot].load(memory_order_acquire);
+		if (tag < workerBlockIndex)
+			break;
+
+		if (tag > workerBlockIndex)
+		{
+			// the audio thread has overwritten blocks that were not processed yet
+			LogF(L"Convolution worker skipped %lld blocks", tag - workerBlockIndex);
+			resetTail();
+		}
+
+		for (unsigned i = 0; i < channelCount; i++)
+			hcPutSingle(&tailFilters[i], inputSlot(slot, i));
+
+		// like SeqLock::read, the fence keeps the reads of the slot from moving past the second tag load
+		atomic_thread_fence(memory_order_acquire);
+		if (inputTags[slot].load(memory_order_relaxed) != tag)
+		{
+			// input was overwritten while reading it
+			resetTail();
+			workerBlockIndex = tag + 1;
+			continue;
+		}
+
+		outputTags[slot].store(-1, memory_order_release);
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			hcProcessSingle(&tailFilters[i]);
+			hcGetSingle(&tailFilters[i], outputSlot(slot, i));
+		}
+		outputTags[slot].store(tag, memory_order_release);
+
+		workerBlockIndex = tag + 1;
+	}
+
+	unsigned missed = missedBlocks.load(memory_order_relaxed);
+	if (missed != reportedMissedBlocks && (missed & (missed - 1)) == 0)
+	{
+		LogF(L"Convolution tail was not ready in time for %d blocks", missed);
+		reportedMissedBlocks = missed;
+	}
+}
+
+void ThreadedConvolver::resetTail()
+{
+	for (unsigned i = 0; i < channelCount; i++)
+		hcResetSingle(&tailFilters[i]);
+}
+
+void ThreadedConvolver::cleanup()
+{
+	if (workerHandle != NULL)
+	{
+		SetEvent(shutdownEvent);
+		WaitForSingleObject(workerHandle, INFINITE);
+		CloseHandle(workerHandle);
+		workerHandle = NULL;
+	}
+
+	if (workEvent != NULL)
+	{
+		CloseHandle(workEvent);
+		workEvent = NULL;
+	}
+
+	if (shutdownEvent != NULL)
+	{
+		CloseHandle(shutdownEvent);
+		shutdownEvent = NULL;
+	}
+
+	if (headFilters != NULL)
+	{
+		for (unsigned i = 0; i < channelCount; i++)
+		{
+			hcCloseSingle(&headFilters[i]);
+			hcCloseSingle(&tailFilters[i]);
+		}
+
+		MemoryHelper::free(headFilters);
+		MemoryHelper::free(tailFilters);
+		headFilters = NULL;
+		tailFilters = NULL;
+	}
+
+	if (inputSlots != NULL)
+	{
+		MemoryHelper::free(inputSlots);
+		MemoryHelper::free(outputSlots);
+		inputSlots = NULL;
+		outputSlots = NULL;
+	}
+}
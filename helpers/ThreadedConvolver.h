@@ -0,0 +1,82 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include "libHybridConv-0.1.1/libHybridConv_eapo.h"
+
+// Partitioned convolver that processes the first partitions of the impulse responses
+// on the audio thread and the remaining partitions on a background worker thread.
+// The worker has HEAD_PARTITIONS - 1 blocks of time to deliver the tail of a block,
+// so the work on the audio thread does not depend on the impulse response length.
+class ThreadedConvolver
+{
+public:
+	static const unsigned HEAD_PARTITIONS = 3;
+
+	ThreadedConvolver();
+	~ThreadedConvolver();
+
+	void initialize(double** impulseResponses, const unsigned* lengths, unsigned channelCount, unsigned frameCount);
+
+	// called once per block on the audio thread, with process called for every channel in between
+	void beginBlock();
+	void process(unsigned channel, double* output, double* input);
+	void endBlock();
+
+	// scales the output of a channel, only allowed before the first block
+	void scale(unsigned channel, double gain);
+
+private:
+	static const unsigned SLOT_COUNT = HEAD_PARTITIONS + 2;
+
+	static unsigned long __stdcall workerThread(void* parameter);
+	void processTail();
+	void resetTail();
+	void cleanup();
+
+	double* inputSlot(unsigned slot, unsigned channel) {return inputSlots + ((size_t)slot * channelCount + channel) * frameCount;}
+	double* outputSlot(unsigned slot, unsigned channel) {return outputSlots + ((size_t)slot * channelCount + channel) * frameCount;}
+
+	unsigned channelCount;
+	unsigned frameCount;
+	HConvSingle* headFilters;
+	HConvSingle* tailFilters;
+
+	// block data exchanged with the worker, each slot tagged with its block index (-1 while being written)
+	double* inputSlots;
+	double* outputSlots;
+	std::atomic<long long> inputTags[SLOT_COUNT];
+	std::atomic<long long> outputTags[SLOT_COUNT];
+
+	// only accessed by the audio thread
+	long long blockIndex;
+	bool tailReady;
+
+	// only accessed by the worker thread
+	long long workerBlockIndex;
+	unsigned reportedMissedBlocks;
+
+	std::atomic<unsigned> missedBlocks;
+	void* workerHandle;
+	void* workEvent;
+	void* shutdownEvent;
+};
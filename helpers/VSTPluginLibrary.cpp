@@ -47,6 +47,15 @@ std::shared_ptr<VSTPluginLibrary> VSTPluginLibrary::getInstance(const wstring& l
 	return ptr;
 }
 
+shared_ptr<VSTPluginLibrary> VSTPluginLibrary::createBuiltIn(const wstring& name, vstPluginMain pluginMain)
+{
+	// not registered in the instance map, as there is no module to share
+	shared_ptr<VSTPluginLibrary> ptr(new VSTPluginLibrary(name));
+	ptr->VSTPluginMain = pluginMain;
+
+	return ptr;
+}
+
 wstring VSTPluginLibrary::getDefaultPluginPath()
 {
 	if (defaultPluginPath == L"")
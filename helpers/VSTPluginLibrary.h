@@ -32,10 +32,12 @@ class VSTPluginLibrary : public AbstractLibrary
 public:
 	static std::shared_ptr<VSTPluginLibrary> getInstance(const std::wstring& libPath);
 	static std::wstring getDefaultPluginPath();
+	typedef vst_effect_t* (* vstPluginMain)(vst_host_callback_t audioMaster);
+	// library whose plugins are implemented by the host itself, e.g. to test the processing without a plugin DLL
+	static std::shared_ptr<VSTPluginLibrary> createBuiltIn(const std::wstring& name, vstPluginMain pluginMain);
 
 	std::wstring getLibPath() override;
 
-	typedef vst_effect_t* (* vstPluginMain)(vst_host_callback_t audioMaster);
 	vstPluginMain VSTPluginMain;
 
 protected:
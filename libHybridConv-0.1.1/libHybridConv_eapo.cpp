@@ -20,11 +20,11 @@
  // Adapted version for Equalizer APO. For original version see libHybridConv.c
 
 #include "stdafx.h"
-#ifndef _M_ARM64
-#include <immintrin.h>
-#endif
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 #include <string.h>
 #ifdef WIN32
 #include <Windows.h>
@@ -34,7 +34,31 @@
 #include <math.h>
 #include <fftw3.h>
 #include "libHybridConv_eapo.h"
+#include "helpers/SimdHelper.h"
+
+
+static void* hcAlignedAlloc(size_t size)
+{
+#ifdef _WIN32
+	return _aligned_malloc(size, 64);
+#else
+	void* p = NULL;
+	if (posix_memalign(&p, 64, size) != 0)
+		return NULL;
+	return p;
+#endif
+}
+
+static void hcAlignedFree(void* p)
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
 
+////////////////////////////////////////////////////////////////
 
 double hcTime(void)
 {
@@ -116,162 +140,17 @@ double getProcTime(int flen, int num, double dur)
 void hcPutSingle(HConvSingle* filter, double* x)
 {
 	const size_t flen = (size_t)filter->framelength;
-	const size_t dft_len = 2 * flen;
 	const size_t freq_len = flen + 1;
 
 	// --- Phase 1: Input Preparation (copy x[0..flen-1], zero-pad [flen..2*flen-1]) ---
-	size_t n = 0;
-
-#if defined(__AVX512F__) && !defined(_M_ARM64)
-	{
-		const size_t simd_width = 8; // doubles
-		const __m512d zero_vec = _mm512_setzero_pd();
-
-		for (; n + simd_width <= flen; n += simd_width) {
-			__m512d v = _mm512_loadu_pd(x + n);
-			_mm512_storeu_pd(filter->dft_time + n, v);
-		}
-		// Only zero-pad if we've finished copying input
-		if (n >= flen) {
-			for (; n + simd_width <= dft_len; n += simd_width) {
-				_mm512_storeu_pd(filter->dft_time + n, zero_vec);
-			}
-		}
-	}
-#endif
-
-#if defined(__AVX2__) && !defined(_M_ARM64)
-	{
-		const size_t simd_width = 4;
-		const __m256d zero_vec = _mm256_setzero_pd();
-
-		for (; n + simd_width <= flen; n += simd_width) {
-			__m256d v = _mm256_loadu_pd(x + n);
-			_mm256_storeu_pd(filter->dft_time + n, v);
-		}
-		// Only zero-pad if we've finished copying input
-		if (n >= flen) {
-			for (; n + simd_width <= dft_len; n += simd_width) {
-				_mm256_storeu_pd(filter->dft_time + n, zero_vec);
-			}
-		}
-	}
-#endif
-
-#if !defined(_M_ARM64)
-	{
-		const size_t simd_width = 2;
-		const __m128d zero_vec = _mm_setzero_pd();
-
-		for (; n + simd_width <= flen; n += simd_width) {
-			__m128d v = _mm_loadu_pd(x + n);
-			_mm_storeu_pd(filter->dft_time + n, v);
-		}
-		// Only zero-pad if we've finished copying input
-		if (n >= flen) {
-			for (; n + simd_width <= dft_len; n += simd_width) {
-				_mm_storeu_pd(filter->dft_time + n, zero_vec);
-			}
-		}
-	}
-#endif
-
-	if (n < flen) {
-		memcpy(filter->dft_time + n, x + n, (flen - n) * sizeof(double));
-		n = flen;
-	}
-	if (n < dft_len) {
-		memset(filter->dft_time + n, 0, (dft_len - n) * sizeof(double));
-	}
+	memcpy(filter->dft_time, x, flen * sizeof(double));
+	memset(filter->dft_time + flen, 0, flen * sizeof(double));
 
 	// --- Phase 2: FFT ---
 	fftw_execute(filter->fft);
 
 	// --- Phase 3: De-interleave FFTW complex output into planar real/imag ---
-	size_t j = 0;
-	fftw_complex* dft_freq = filter->dft_freq;
-	
-#if defined(__AVX512F__) && !defined(_M_ARM64)
-    {
-        // Process 8 complex numbers per loop (r0 i0 ... r7 i7)
-        const size_t CW = 8;
-
-        // Indices for _mm512_permutex2var_pd:
-        //   0..7  select from 'a' (first source)
-        //   8..15 select from 'b' (second source)
-        const __m512i idx_real = _mm512_setr_epi64(
-            0, 2, 4, 6,   // r0 r1 r2 r3 from 'a'
-            8 + 0, 8 + 2, 8 + 4, 8 + 6  // r4 r5 r6 r7 from 'b'
-        );
-        const __m512i idx_imag = _mm512_setr_epi64(
-            1, 3, 5, 7,   // i0 i1 i2 i3 from 'a'
-            8 + 1, 8 + 3, 8 + 5, 8 + 7  // i4 i5 i6 i7 from 'b'
-        );
-
-        for (; j + CW <= freq_len; j += CW) {
-            // a = [r0 i0 r1 i1 r2 i2 r3 i3]
-            // b = [r4 i4 r5 i5 r6 i6 r7 i7]
-            __m512d a = _mm512_loadu_pd((const double*)(dft_freq + j));
-            __m512d b = _mm512_loadu_pd((const double*)(dft_freq + j + 4));
-
-            // Directly select real and imag lanes from a|b
-            __m512d r = _mm512_permutex2var_pd(a, idx_real, b); // [r0..r7]
-            __m512d i = _mm512_permutex2var_pd(a, idx_imag, b); // [i0..i7]
-
-            _mm512_storeu_pd(filter->in_freq_real + j, r);
-            _mm512_storeu_pd(filter->in_freq_imag + j, i);
-        }
-    }
-#endif
-
-#if defined(__AVX2__) && !defined(_M_ARM64)
-	{
-		// Process 4 complex numbers (8 doubles) per loop.
-		const size_t complex_width = 4;
-		for (; j + complex_width <= freq_len; j += complex_width) {
-			// c0 = [r0 i0 r1 i1], c1 = [r2 i2 r3 i3]
-			__m256d c0 = _mm256_loadu_pd((const double*)(dft_freq + j));
-			__m256d c1 = _mm256_loadu_pd((const double*)(dft_freq + j + 2));
-
-			// Interleave within pairs across c0/c1.
-			// rtmp = [r0 r2 r1 r3], itmp = [i0 i2 i1 i3]
-			__m256d rtmp = _mm256_shuffle_pd(c0, c1, 0x0);
-			__m256d itmp = _mm256_shuffle_pd(c0, c1, 0xF);
-
-			// Fix the middle-lane order: [r0 r2 r1 r3] -> [r0 r1 r2 r3]
-			// 0xD8 = 11 01 10 00b selects [0,2,1,3].
-			__m256d real_vec = _mm256_permute4x64_pd(rtmp, 0xD8);
-			__m256d imag_vec = _mm256_permute4x64_pd(itmp, 0xD8);
-
-			_mm256_storeu_pd(filter->in_freq_real + j, real_vec);
-			_mm256_storeu_pd(filter->in_freq_imag + j, imag_vec);
-		}
-	}
-#endif
-
-#if !defined(_M_ARM64)
-	{
-		// Process 2 complex numbers per loop (SSE2).
-		const size_t complex_width = 2;
-		for (; j + complex_width <= freq_len; j += complex_width) {
-			// c0 = [r0 i0], c1 = [r1 i1]
-			__m128d c0 = _mm_loadu_pd((const double*)(dft_freq + j));
-			__m128d c1 = _mm_loadu_pd((const double*)(dft_freq + j + 1));
-
-			__m128d real_vec = _mm_shuffle_pd(c0, c1, 0x00); // [r0 r1]
-			__m128d imag_vec = _mm_shuffle_pd(c0, c1, 0x03); // [i0 i1]
-
-			_mm_storeu_pd(filter->in_freq_real + j, real_vec);
-			_mm_storeu_pd(filter->in_freq_imag + j, imag_vec);
-		}
-	}
-#endif
-
-	// Scalar tail (<1 complex for r2c)
-	for (; j < freq_len; ++j) {
-		filter->in_freq_real[j] = dft_freq[j][0];
-		filter->in_freq_imag[j] = dft_freq[j][1];
-	}
+	SimdHelper::getKernels().deinterleave(filter->in_freq_real, filter->in_freq_imag, (const double*)filter->dft_freq, freq_len);
 }
 
 
@@ -286,104 +165,29 @@ void hcProcessSingle(HConvSingle* filter)
 
 	const int start = filter->steptask[filter->step];
 	const int stop = filter->steptask[filter->step + 1];
+	const size_t segment_size = (size_t)filter->segment_size;
 
-	for (int s = start; s < stop; ++s) {
-		const int mix_idx = (s + filter->mixpos) % filter->num_mixbuf;
-
-		double* const       y_real = filter->mixbuf_freq_real[mix_idx];
-		double* const       y_imag = filter->mixbuf_freq_imag[mix_idx];
-		const double* const h_real = filter->filterbuf_freq_real[s];
-		const double* const h_imag = filter->filterbuf_freq_imag[s];
-
-#if !defined(_M_ARM64)
-		// Prefetch next filter segment to help hide memory latency.
-		// For large filter banks, prefetch 2 segments ahead for better performance.
-		const int prefetch_distance = (stop - start > 4) ? 2 : 1;
-		if (s + prefetch_distance < stop) {
-			_mm_prefetch((char const*)(filter->filterbuf_freq_real[s + prefetch_distance]), _MM_HINT_T0);
-			_mm_prefetch((char const*)(filter->filterbuf_freq_imag[s + prefetch_distance]), _MM_HINT_T0);
-		}
-#endif
-
-		size_t n = 0;
-
-#if defined(__AVX512F__) && !defined(_M_ARM64)
-		// AVX-512: 8 doubles at a time.
-		for (; n + 8 <= num_elements; n += 8) {
-			const __m512d xr = _mm512_loadu_pd(x_real + n);
-			const __m512d xi = _mm512_loadu_pd(x_imag + n);
-			const __m512d hr = _mm512_loadu_pd(h_real + n);
-			const __m512d hi = _mm512_loadu_pd(h_imag + n);
-
-			__m512d yr = _mm512_loadu_pd(y_real + n);
-			__m512d yi = _mm512_loadu_pd(y_imag + n);
-
-			// Real: yr += xr*hr - xi*hi
-			yr = _mm512_fmadd_pd(xr, hr, yr);    // yr = xr*hr + yr
-			yr = _mm512_fnmadd_pd(xi, hi, yr);   // yr = -(xi*hi) + yr = yr - xi*hi
-
-			// Imag: yi += xr*hi + xi*hr
-			yi = _mm512_fmadd_pd(xr, hi, yi);    // yi = xr*hi + yi
-			yi = _mm512_fmadd_pd(xi, hr, yi);    // yi = xi*hr + yi
-
-			_mm512_storeu_pd(y_real + n, yr);
-			_mm512_storeu_pd(y_imag + n, yi);
-		}
-#endif
-
-#if defined(__AVX2__) && !defined(_M_ARM64)
-		// AVX2: 4 doubles at a time.
-		for (; n + 4 <= num_elements; n += 4) {
-			const __m256d xr = _mm256_loadu_pd(x_real + n);
-			const __m256d xi = _mm256_loadu_pd(x_imag + n);
-			const __m256d hr = _mm256_loadu_pd(h_real + n);
-			const __m256d hi = _mm256_loadu_pd(h_imag + n);
-
-			__m256d yr = _mm256_loadu_pd(y_real + n);
-			__m256d yi = _mm256_loadu_pd(y_imag + n);
-
-			// Real: yr += xr*hr - xi*hi
-			yr = _mm256_fmadd_pd(xr, hr, yr);    // yr = xr*hr + yr
-			yr = _mm256_fnmadd_pd(xi, hi, yr);   // yr = -(xi*hi) + yr = yr - xi*hi
-
-			// Imag: yi += xr*hi + xi*hr
-			yi = _mm256_fmadd_pd(xr, hi, yi);    // yi = xr*hi + yi
-			yi = _mm256_fmadd_pd(xi, hr, yi);    // yi = xi*hr + yi
-
-			_mm256_storeu_pd(y_real + n, yr);
-			_mm256_storeu_pd(y_imag + n, yi);
-		}
-#endif
-
-#if !defined(_M_ARM64)
-		// SSE2: 2 doubles at a time.
-		for (; n + 2 <= num_elements; n += 2) {
-			const __m128d xr = _mm_loadu_pd(x_real + n);
-			const __m128d xi = _mm_loadu_pd(x_imag + n);
-			const __m128d hr = _mm_loadu_pd(h_real + n);
-			const __m128d hi = _mm_loadu_pd(h_imag + n);
-
-			__m128d yr = _mm_loadu_pd(y_real + n);
-			__m128d yi = _mm_loadu_pd(y_imag + n);
+	// Both slabs are walked linearly; the mixing segments wrap around once at most.
+	int mix_idx = start + filter->mixpos;
+	if (mix_idx >= filter->num_mixbuf)
+		mix_idx -= filter->num_mixbuf;
+	double* y_segment = filter->mixbuf_freq + mix_idx * segment_size;
+	double* const y_end = filter->mixbuf_freq + filter->num_mixbuf * segment_size;
+	const double* h_segment = filter->filterbuf_freq + start * segment_size;
 
-			// Real: yr += xr*hr - xi*hi
-			yr = _mm_fmadd_pd(xr, hr, yr);       // yr = xr*hr + yr
-			yr = _mm_fnmadd_pd(xi, hi, yr);      // yr = -(xi*hi) + yr = yr - xi*hi
+	const SimdKernels& kernels = SimdHelper::getKernels();
+	for (int s = start; s < stop; ++s) {
+		double* const       y_real = y_segment;
+		double* const       y_imag = y_segment + segment_size / 2;
+		const double* const h_real = h_segment;
+		const double* const h_imag = h_segment + segment_size / 2;
 
-			// Imag: yi += xr*hi + xi*hr
-			yi = _mm_fmadd_pd(xr, hi, yi);       // yi = xr*hi + yi
-			yi = _mm_fmadd_pd(xi, hr, yi);       // yi = xi*hr + yi
+		h_segment += segment_size;
+		y_segment += segment_size;
+		if (y_segment == y_end)
+			y_segment = filter->mixbuf_freq;
 
-			_mm_storeu_pd(y_real + n, yr);
-			_mm_storeu_pd(y_imag + n, yi);
-		}
-#endif
-
-		// Scalar tail (and works for ARM64 too).
-		for (; n < num_elements; ++n) {
-			y_real[n] += x_real[n] * h_real[n] - x_imag[n] * h_imag[n];
-			y_imag[n] += x_real[n] * h_imag[n] + x_imag[n] * h_real[n];
-		}
+		kernels.complexMultiplyAdd(y_real, y_imag, x_real, x_imag, h_real, h_imag, num_elements);
 	}
 
 	filter->step = (filter->step + 1) % filter->maxstep;
@@ -391,35 +195,7 @@ void hcProcessSingle(HConvSingle* filter)
 
 static inline void zero_doubles_simd(double* __restrict p, int len)
 {
-#if defined(__AVX512F__)
-	const int VW = 8; // doubles per 512-bit reg
-	__m512d z = _mm512_setzero_pd();
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		_mm512_storeu_pd(p + i, z);
-	}
-	for (; i < len; ++i) p[i] = 0.0;
-#elif defined(__AVX2__)
-	const int VW = 4; // doubles per 256-bit reg
-	__m256d z = _mm256_setzero_pd();
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		_mm256_storeu_pd(p + i, z);
-	}
-	for (; i < len; ++i) p[i] = 0.0;
-#elif defined(__AVX__)
-	const int VW = 4; // AVX1 still has 256-bit double ops
-	__m256d z = _mm256_setzero_pd();
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		_mm256_storeu_pd(p + i, z);
-	}
-	for (; i < len; ++i) p[i] = 0.0;
-#else
-	for (int i = 0; i < len; ++i) {
-		p[i] = 0.0;
-	}
-#endif
+	memset(p, 0, sizeof(double) * len);
 }
 
 static inline void add_out_hist_to_y_simd(const double* __restrict out,
@@ -428,97 +204,22 @@ static inline void add_out_hist_to_y_simd(const double* __restrict out,
 	int len,
 	int add_to_existing_y /*0: assign; 1: += */)
 {
-#if defined(__AVX512F__)
-	const int VW = 8;
-	const __mmask8 mask = add_to_existing_y ? 0xFF : 0x00;
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		__m512d vout = _mm512_loadu_pd(out + i);
-		__m512d vhist = _mm512_loadu_pd(hist + i);
-		__m512d vsum = _mm512_add_pd(vout, vhist);
-		// If add_to_existing_y=0, mask is 0 and vy is not added
-		__m512d vy = _mm512_maskz_loadu_pd(mask, y + i);
-		vsum = _mm512_mask_add_pd(vsum, mask, vsum, vy);
-		_mm512_storeu_pd(y + i, vsum);
-	}
-	for (; i < len; ++i) {
-		double s = out[i] + hist[i];
-		y[i] = add_to_existing_y ? (y[i] + s) : s;
-	}
-#elif defined(__AVX2__)
-	const int VW = 4;
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		__m256d vout = _mm256_loadu_pd(out + i);
-		__m256d vhist = _mm256_loadu_pd(hist + i);
-		__m256d vsum = _mm256_add_pd(vout, vhist);
-		if (add_to_existing_y) {
-			__m256d vy = _mm256_loadu_pd(y + i);
-			vsum = _mm256_add_pd(vsum, vy);
-		}
-		_mm256_storeu_pd(y + i, vsum);
-	}
-	for (; i < len; ++i) {
-		double s = out[i] + hist[i];
-		y[i] = add_to_existing_y ? (y[i] + s) : s;
-	}
-#elif defined(__AVX__)
-	const int VW = 4;
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		__m256d vout = _mm256_loadu_pd(out + i);
-		__m256d vhist = _mm256_loadu_pd(hist + i);
-		__m256d vsum = _mm256_add_pd(vout, vhist);
-		if (add_to_existing_y) {
-			__m256d vy = _mm256_loadu_pd(y + i);
-			vsum = _mm256_add_pd(vsum, vy);
-		}
-		_mm256_storeu_pd(y + i, vsum);
-	}
-	for (; i < len; ++i) {
-		double s = out[i] + hist[i];
-		y[i] = add_to_existing_y ? (y[i] + s) : s;
+	// simple enough for the compiler to vectorize for the baseline instruction set
+	if (add_to_existing_y) {
+		for (int i = 0; i < len; ++i)
+			y[i] += out[i] + hist[i];
 	}
-#else
-	for (int i = 0; i < len; ++i) {
-		double s = out[i] + hist[i];
-		y[i] = add_to_existing_y ? (y[i] + s) : s;
+	else {
+		for (int i = 0; i < len; ++i)
+			y[i] = out[i] + hist[i];
 	}
-#endif
 }
 
 static inline void copy_hist_from_out_tail_simd(double* __restrict hist,
 	const double* __restrict out_tail,
 	int len)
 {
-#if defined(__AVX512F__)
-	const int VW = 8;
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		__m512d v = _mm512_loadu_pd(out_tail + i);
-		_mm512_storeu_pd(hist + i, v);
-	}
-	for (; i < len; ++i) hist[i] = out_tail[i];
-#elif defined(__AVX2__)
-	const int VW = 4;
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		__m256d v = _mm256_loadu_pd(out_tail + i);
-		_mm256_storeu_pd(hist + i, v);
-	}
-	for (; i < len; ++i) hist[i] = out_tail[i];
-#elif defined(__AVX__)
-	const int VW = 4;
-	int i = 0;
-	for (; i + VW <= len; i += VW) {
-		__m256d v = _mm256_loadu_pd(out_tail + i);
-		_mm256_storeu_pd(hist + i, v);
-	}
-	for (; i < len; ++i) hist[i] = out_tail[i];
-#else
-	for (int i = 0; i < len; ++i)
-		hist[i] = out_tail[i];
-#endif
+	memcpy(hist, out_tail, sizeof(double) * len);
 }
 
 void hcGetSingle(HConvSingle* filter, double* y)
@@ -529,17 +230,19 @@ void hcGetSingle(HConvSingle* filter, double* y)
 	double* out = filter->dft_time;        // length = 2*flen
 	double* hist = filter->history_time;    // length = flen
 
+	double* mix_real = filter->mixbuf_freq + (size_t)mpos * filter->segment_size;
+	double* mix_imag = mix_real + filter->segment_size / 2;
+
 	// Move one frequency frame from mixbuf -> dft_freq and zero the source.
 	// Keep scalar here to preserve exact per-bin assignment order into AoS fftw_complex.
 	for (int j = 0; j < flen + 1; ++j)
 	{
-		filter->dft_freq[j][0] = filter->mixbuf_freq_real[mpos][j];
-		filter->dft_freq[j][1] = filter->mixbuf_freq_imag[mpos][j];
+		filter->dft_freq[j][0] = mix_real[j];
+		filter->dft_freq[j][1] = mix_imag[j];
 	}
 
-	// Zero the mix buffers for this slot (vectorized).
-	zero_doubles_simd(filter->mixbuf_freq_real[mpos], flen + 1);
-	zero_doubles_simd(filter->mixbuf_freq_imag[mpos], flen + 1);
+	// Zero the mix buffers for this slot (vectorized), including padding.
+	zero_doubles_simd(mix_real, filter->segment_size);
 
 	// IFFT (unchanged).
 	fftw_execute(filter->ifft);
@@ -555,7 +258,7 @@ void hcGetSingle(HConvSingle* filter, double* y)
 	copy_hist_from_out_tail_simd(hist, out + flen, flen);
 
 	// Advance circular position.
-	filter->mixpos = (mpos + 1) % filter->num_mixbuf;
+	filter->mixpos = (mpos + 1 == filter->num_mixbuf) ? 0 : mpos + 1;
 }
 
 void hcGetAddSingle(HConvSingle* filter, double* y)
@@ -566,15 +269,17 @@ void hcGetAddSingle(HConvSingle* filter, double* y)
 	double* out = filter->dft_time;        // length = 2*flen
 	double* hist = filter->history_time;    // length = flen
 
+	double* mix_real = filter->mixbuf_freq + (size_t)mpos * filter->segment_size;
+	double* mix_imag = mix_real + filter->segment_size / 2;
+
 	// Move one frequency frame from mixbuf -> dft_freq and zero the source.
 	for (int j = 0; j < flen + 1; ++j)
 	{
-		filter->dft_freq[j][0] = filter->mixbuf_freq_real[mpos][j];
-		filter->dft_freq[j][1] = filter->mixbuf_freq_imag[mpos][j];
+		filter->dft_freq[j][0] = mix_real[j];
+		filter->dft_freq[j][1] = mix_imag[j];
 	}
 
-	zero_doubles_simd(filter->mixbuf_freq_real[mpos], flen + 1);
-	zero_doubles_simd(filter->mixbuf_freq_imag[mpos], flen + 1);
+	zero_doubles_simd(mix_real, filter->segment_size);
 
 	fftw_execute(filter->ifft);
 
@@ -588,37 +293,14 @@ void hcGetAddSingle(HConvSingle* filter, double* y)
 	// Update history with tail.
 	copy_hist_from_out_tail_simd(hist, out + flen, flen);
 
-	filter->mixpos = (mpos + 1) % filter->num_mixbuf;
+	filter->mixpos = (mpos + 1 == filter->num_mixbuf) ? 0 : mpos + 1;
 }
 
 static inline void mul_store_gain_double(double* __restrict dst,
 	const double* __restrict src,
 	int n, double gain)
 {
-#if defined(__AVX512F__)
-	const int V = 8;
-	__m512d g = _mm512_set1_pd(gain);
-	int i = 0;
-	for (; i + V <= n; i += V) {
-		__m512d x = _mm512_loadu_pd(src + i);
-		x = _mm512_mul_pd(x, g);
-		_mm512_storeu_pd(dst + i, x);
-	}
-	for (; i < n; ++i) dst[i] = src[i] * gain;
-#elif defined(__AVX2__) || defined(__AVX__)
-	// For doubles, AVX intrinsics (_mm256_*) are the FP workhorses; AVX2 adds ints.
-	const int V = 4;
-	__m256d g = _mm256_set1_pd(gain);
-	int i = 0;
-	for (; i + V <= n; i += V) {
-		__m256d x = _mm256_loadu_pd(src + i);
-		x = _mm256_mul_pd(x, g);
-		_mm256_storeu_pd(dst + i, x);
-	}
-	for (; i < n; ++i) dst[i] = src[i] * gain;
-#else
-	for (int i = 0; i < n; ++i) dst[i] = src[i] * gain;
-#endif
+	SimdHelper::getKernels().scale(dst, src, gain, n);
 }
 
 static inline void copy_split_complex_scalar(const fftw_complex * __restrict src,
@@ -639,68 +321,7 @@ static inline void copy_split_complex_vec(const fftw_complex* __restrict src,
 	double* __restrict im,
 	int n_complex)
 {
-	const double* s = (const double*)src;
-	int j = 0;
-
-#if defined(__AVX512F__)
-	// 4 complex per iter: load 8 doubles: [r0,i0,r1,i1,r2,i2,r3,i3]
-	for (; j + 4 <= n_complex; j += 4) {
-		__m512d v = _mm512_loadu_pd(s + (size_t)j * 2);
-
-		// Build index vectors to select even (re) and odd (im) lanes.
-		// We’ll take the lower 256 bits (first 4 lanes) after permute.
-		const __m512i idx_even = _mm512_set_epi64(6, 4, 2, 0, 6, 4, 2, 0);
-		const __m512i idx_odd = _mm512_set_epi64(7, 5, 3, 1, 7, 5, 3, 1);
-
-		__m512d v_re = _mm512_permutexvar_pd(idx_even, v); // [r0,r2,r4?,r6? | dup]
-		__m512d v_im = _mm512_permutexvar_pd(idx_odd, v); // [i0,i2,i4?,i6? | dup]
-
-		// Store lower 256 containing [r0, r1, r2, r3]? Wait—our even/odd
-		// indices were 0,2,4,6 and 1,3,5,7. For 4 complexes:
-		// even -> [r0,r1,r2,r3] map is [0,2,4,6] over [r0,i0,r1,i1,r2,i2,r3,i3] = [0,2,4,6].
-		// odd  -> [i0,i1,i2,i3] map is [1,3,5,7].
-		__m256d re256 = _mm512_castpd512_pd256(v_re);
-		__m256d im256 = _mm512_castpd512_pd256(v_im);
-
-		_mm256_storeu_pd(re + j, re256);
-		_mm256_storeu_pd(im + j, im256);
-	}
-#elif defined(__AVX2__)
-	// 4 complex per iter using 256-bit path:
-	// a = [r0,i0,r1,i1], b = [r2,i2,r3,i3]
-	// re_temp = shuffle_pd(a,b,0x0) -> [r0,r2, r1,r3]
-	// im_temp = shuffle_pd(a,b,0xF) -> [i0,i2, i1,i3]
-	// Then swap lanes 1<->2 with permute4x64 imm=0xD8 to get [r0,r1,r2,r3] and [i0,i1,i2,i3]
-	for (; j + 4 <= n_complex; j += 4) {
-		__m256d a = _mm256_loadu_pd(s + (size_t)j * 2);
-		__m256d b = _mm256_loadu_pd(s + (size_t)j * 2 + 4);
-		__m256d re_tmp = _mm256_shuffle_pd(a, b, 0x0);
-		__m256d im_tmp = _mm256_shuffle_pd(a, b, 0xF);
-		__m256d re_vec = _mm256_permute4x64_pd(re_tmp, 0xD8); // [0,2,1,3] -> [0,1,2,3]
-		__m256d im_vec = _mm256_permute4x64_pd(im_tmp, 0xD8);
-		_mm256_storeu_pd(re + j, re_vec);
-		_mm256_storeu_pd(im + j, im_vec);
-	}
-#elif defined(__AVX__)
-	// 2 complex per iter using 128-bit SSE ops (valid in AVX TU):
-	// a = [r0,i0,r1,i1]
-	// re = shuffle(a, a, 0b1000) -> [r0,r1]
-	// im = shuffle(a, a, 0b1111) with mask picking odds -> [i0,i1]
-	for (; j + 2 <= n_complex; j += 2) {
-		__m128d lo = _mm_loadu_pd(s + (size_t)j * 2);         // [r0,i0]
-		__m128d hi = _mm_loadu_pd(s + (size_t)j * 2 + 2);     // [r1,i1]
-		__m128d a = _mm_shuffle_pd(lo, hi, 0b00);            // [r0,r1]
-		__m128d b = _mm_shuffle_pd(lo, hi, 0b11);            // [i0,i1]
-		_mm_storeu_pd(re + j, a);
-		_mm_storeu_pd(im + j, b);
-	}
-#endif
-
-	// Tail
-	for (; j < n_complex; ++j) {
-		re[j] = s[2 * (size_t)j + 0];
-		im[j] = s[2 * (size_t)j + 1];
-	}
+	SimdHelper::getKernels().deinterleave(re, im, (const double*)src, n_complex);
 }
 void hcInitSingle(HConvSingle * filter, double* h, int hlen, int flen, int steps)
 {
@@ -736,27 +357,18 @@ void hcInitSingle(HConvSingle * filter, double* h, int hlen, int flen, int steps
 			filter->steptask[i]++;
 	}
 
-	size = sizeof(double*) * filter->num_filterbuf;
-	filter->filterbuf_freq_real = (double**)fftw_malloc(size);
-	filter->filterbuf_freq_imag = (double**)fftw_malloc(size);
-	for (i = 0; i < filter->num_filterbuf; i++) {
-		size = sizeof(double) * (flen + 1);
-		filter->filterbuf_freq_real[i] = (double*)fftw_malloc(size);
-		filter->filterbuf_freq_imag[i] = (double*)fftw_malloc(size);
-	}
+	// real and imaginary part of each segment are padded to a multiple of 8 doubles (64 bytes)
+	filter->segment_size = 2 * ((flen + 1 + 7) & ~7);
+
+	size = sizeof(double) * filter->segment_size * filter->num_filterbuf;
+	filter->filterbuf_freq = (double*)hcAlignedAlloc(size);
+	memset(filter->filterbuf_freq, 0, size);
 
 	filter->num_mixbuf = filter->num_filterbuf + 1;
 
-	size = sizeof(double*) * filter->num_mixbuf;
-	filter->mixbuf_freq_real = (double**)fftw_malloc(size);
-	filter->mixbuf_freq_imag = (double**)fftw_malloc(size);
-	for (i = 0; i < filter->num_mixbuf; i++) {
-		size = sizeof(double) * (flen + 1);
-		filter->mixbuf_freq_real[i] = (double*)fftw_malloc(size);
-		filter->mixbuf_freq_imag[i] = (double*)fftw_malloc(size);
-		memset(filter->mixbuf_freq_real[i], 0, size);
-		memset(filter->mixbuf_freq_imag[i], 0, size);
-	}
+	size = sizeof(double) * filter->segment_size * filter->num_mixbuf;
+	filter->mixbuf_freq = (double*)hcAlignedAlloc(size);
+	memset(filter->mixbuf_freq, 0, size);
 
 	size = sizeof(double) * flen;
 	filter->history_time = (double*)fftw_malloc(size);
@@ -781,8 +393,8 @@ void hcInitSingle(HConvSingle * filter, double* h, int hlen, int flen, int steps
 
 		// Split complex to separate real/imag buffers
 		copy_split_complex_vec((const fftw_complex*)filter->dft_freq,
-			filter->filterbuf_freq_real[i],
-			filter->filterbuf_freq_imag[i],
+			filter->filterbuf_freq + (size_t)i * filter->segment_size,
+			filter->filterbuf_freq + (size_t)i * filter->segment_size + filter->segment_size / 2,
 			flen + 1);
 	}
 
@@ -801,28 +413,35 @@ void hcInitSingle(HConvSingle * filter, double* h, int hlen, int flen, int steps
 
 	fftw_execute(filter->fft);
 	copy_split_complex_vec((const fftw_complex*)filter->dft_freq,
-		filter->filterbuf_freq_real[i],
-		filter->filterbuf_freq_imag[i],
+		filter->filterbuf_freq + (size_t)i * filter->segment_size,
+		filter->filterbuf_freq + (size_t)i * filter->segment_size + filter->segment_size / 2,
 		flen + 1);
 }
 
+void hcResetSingle(HConvSingle* filter)
+{
+	memset(filter->mixbuf_freq, 0, sizeof(double) * filter->segment_size * filter->num_mixbuf);
+	memset(filter->history_time, 0, sizeof(double) * filter->framelength);
+	filter->step = 0;
+	filter->mixpos = 0;
+}
+
+
+void hcScaleSingle(HConvSingle* filter, double gain)
+{
+	// the transform is linear, so scaling the filter spectra scales the output
+	size_t len = (size_t)filter->segment_size * filter->num_filterbuf;
+	for (size_t n = 0; n < len; n++)
+		filter->filterbuf_freq[n] *= gain;
+}
+
 void hcCloseSingle(HConvSingle* filter)
 {
 	fftw_destroy_plan(filter->ifft);
 	fftw_destroy_plan(filter->fft);
 	fftw_free(filter->history_time);
-	for (int i = 0; i < filter->num_mixbuf; i++) {
-		fftw_free(filter->mixbuf_freq_real[i]);
-		fftw_free(filter->mixbuf_freq_imag[i]);
-	}
-	fftw_free(filter->mixbuf_freq_real);
-	fftw_free(filter->mixbuf_freq_imag);
-	for (int i = 0; i < filter->num_filterbuf; i++) {
-		fftw_free(filter->filterbuf_freq_real[i]);
-		fftw_free(filter->filterbuf_freq_imag[i]);
-	}
-	fftw_free(filter->filterbuf_freq_real);
-	fftw_free(filter->filterbuf_freq_imag);
+	hcAlignedFree(filter->mixbuf_freq);
+	hcAlignedFree(filter->filterbuf_freq);
 	fftw_free(filter->in_freq_real);
 	fftw_free(filter->in_freq_imag);
 	fftw_free(filter->dft_freq);
@@ -832,6 +451,234 @@ void hcCloseSingle(HConvSingle* filter)
 }
 
 
+////////////////////////////////////////////////////////////////
+// Single precision variant of the uniformly partitioned filter. Input and output
+// stay in double precision, only the DFT buffers and the spectra of the filter and
+// mixing segments are stored as float. This halves the memory that has to be streamed
+// per block for long impulse responses and doubles the number of SIMD lanes per MAC.
+
+void hcPutSingleF(HConvSingleF* filter, double* x)
+{
+	const int flen = filter->framelength;
+	const int freq_len = flen + 1;
+	float* dft_time = filter->dft_time;
+
+	// --- Phase 1: Input conversion (x[0..flen-1] to float, zero-pad [flen..2*flen-1]) ---
+	const SimdKernels& kernels = SimdHelper::getKernels();
+	kernels.convertDoubleToFloat(dft_time, x, flen);
+	memset(dft_time + flen, 0, sizeof(float) * flen);
+
+	// --- Phase 2: FFT ---
+	fftwf_execute(filter->fft);
+
+	// --- Phase 3: De-interleave FFTW complex output into planar real/imag ---
+	kernels.deinterleaveFloat(filter->in_freq_real, filter->in_freq_imag, (const float*)filter->dft_freq, freq_len);
+}
+
+
+void hcProcessSingleF(HConvSingleF* filter)
+{
+	const size_t num_elements = (size_t)filter->framelength + 1;
+
+	const float* const x_real = filter->in_freq_real;
+	const float* const x_imag = filter->in_freq_imag;
+
+	const int start = filter->steptask[filter->step];
+	const int stop = filter->steptask[filter->step + 1];
+	const size_t segment_size = (size_t)filter->segment_size;
+
+	int mix_idx = start + filter->mixpos;
+	if (mix_idx >= filter->num_mixbuf)
+		mix_idx -= filter->num_mixbuf;
+	float* y_segment = filter->mixbuf_freq + mix_idx * segment_size;
+	float* const y_end = filter->mixbuf_freq + filter->num_mixbuf * segment_size;
+	const float* h_segment = filter->filterbuf_freq + start * segment_size;
+
+	const SimdKernels& kernels = SimdHelper::getKernels();
+	for (int s = start; s < stop; ++s) {
+		float* const       y_real = y_segment;
+		float* const       y_imag = y_segment + segment_size / 2;
+		const float* const h_real = h_segment;
+		const float* const h_imag = h_segment + segment_size / 2;
+
+		h_segment += segment_size;
+		y_segment += segment_size;
+		if (y_segment == y_end)
+			y_segment = filter->mixbuf_freq;
+
+		kernels.complexMultiplyAddFloat(y_real, y_imag, x_real, x_imag, h_real, h_imag, num_elements);
+	}
+
+	filter->step = (filter->step + 1) % filter->maxstep;
+}
+
+
+static void hcInverseSingleF(HConvSingleF* filter)
+{
+	const int flen = filter->framelength;
+	float* mix_real = filter->mixbuf_freq + (size_t)filter->mixpos * filter->segment_size;
+	float* mix_imag = mix_real + filter->segment_size / 2;
+
+	for (int j = 0; j < flen + 1; ++j)
+	{
+		filter->dft_freq[j][0] = mix_real[j];
+		filter->dft_freq[j][1] = mix_imag[j];
+	}
+	memset(mix_real, 0, sizeof(float) * filter->segment_size);
+
+	fftwf_execute(filter->ifft);
+
+	filter->mixpos = (filter->mixpos + 1 == filter->num_mixbuf) ? 0 : filter->mixpos + 1;
+}
+
+
+void hcGetSingleF(HConvSingleF* filter, double* y)
+{
+	const int flen = filter->framelength;
+	const float* out = filter->dft_time;
+	float* hist = filter->history_time;
+
+	hcInverseSingleF(filter);
+
+	for (int n = 0; n < flen; n++)
+		y[n] = (double)out[n] + (double)hist[n];
+	memcpy(hist, out + flen, sizeof(float) * flen);
+}
+
+
+void hcGetAddSingleF(HConvSingleF* filter, double* y)
+{
+	const int flen = filter->framelength;
+	const float* out = filter->dft_time;
+	float* hist = filter->history_time;
+
+	hcInverseSingleF(filter);
+
+	for (int n = 0; n < flen; n++)
+		y[n] += (double)out[n] + (double)hist[n];
+	memcpy(hist, out + flen, sizeof(float) * flen);
+}
+
+
+void hcInitSingleF(HConvSingleF* filter, double* h, int hlen, int flen, int steps)
+{
+	int i, j, size, num, pos;
+	double gain;
+
+	filter->step = 0;
+	filter->maxstep = steps;
+	filter->mixpos = 0;
+	filter->framelength = flen;
+
+	size = sizeof(float) * 2 * flen;
+	filter->dft_time = (float*)fftwf_malloc(size);
+
+	size = sizeof(fftwf_complex) * (flen + 1);
+	filter->dft_freq = (fftwf_complex*)fftwf_malloc(size);
+
+	size = sizeof(float) * (flen + 1);
+	filter->in_freq_real = (float*)fftwf_malloc(size);
+	filter->in_freq_imag = (float*)fftwf_malloc(size);
+
+	filter->num_filterbuf = (hlen + flen - 1) / flen;
+
+	size = sizeof(int) * (steps + 1);
+	filter->steptask = (int*)malloc(size);
+	num = filter->num_filterbuf / steps;
+	for (i = 0; i <= steps; i++)
+		filter->steptask[i] = i * num;
+	pos = (filter->steptask[1] == 0) ? 1 : 2;
+	num = filter->num_filterbuf % steps;
+	for (j = pos; j < pos + num; j++) {
+		for (i = j; i <= steps; i++)
+			filter->steptask[i]++;
+	}
+
+	// real and imaginary part of each segment are padded to a multiple of 16 floats (64 bytes)
+	filter->segment_size = 2 * ((flen + 1 + 15) & ~15);
+
+	size = sizeof(float) * filter->segment_size * filter->num_filterbuf;
+	filter->filterbuf_freq = (float*)hcAlignedAlloc(size);
+	memset(filter->filterbuf_freq, 0, size);
+
+	filter->num_mixbuf = filter->num_filterbuf + 1;
+
+	size = sizeof(float) * filter->segment_size * filter->num_mixbuf;
+	filter->mixbuf_freq = (float*)hcAlignedAlloc(size);
+	memset(filter->mixbuf_freq, 0, size);
+
+	size = sizeof(float) * flen;
+	filter->history_time = (float*)fftwf_malloc(size);
+	memset(filter->history_time, 0, size);
+
+	unsigned fftw_flags = FFTW_ESTIMATE | FFTW_PRESERVE_INPUT;
+	filter->fft = fftwf_plan_dft_r2c_1d(2 * flen, filter->dft_time, filter->dft_freq, fftw_flags);
+	filter->ifft = fftwf_plan_dft_c2r_1d(2 * flen, filter->dft_freq, filter->dft_time, fftw_flags);
+
+	gain = 0.5 / flen;
+
+	// The filter spectra are computed in double precision and rounded afterwards,
+	// so that the only error compared to hcInitSingle is the float representation.
+	double* seg_time = (double*)fftw_malloc(sizeof(double) * 2 * flen);
+	fftw_complex* seg_freq = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (flen + 1));
+	fftw_plan seg_fft = fftw_plan_dft_r2c_1d(2 * flen, seg_time, seg_freq, FFTW_ESTIMATE);
+
+	for (i = 0; i < filter->num_filterbuf; i++) {
+		int seg_len = hlen - i * flen;
+		if (seg_len > flen)
+			seg_len = flen;
+
+		memset(seg_time, 0, sizeof(double) * 2 * flen);
+		mul_store_gain_double(seg_time, h + (size_t)i * flen, seg_len, gain);
+
+		fftw_execute(seg_fft);
+
+		float* seg_real = filter->filterbuf_freq + (size_t)i * filter->segment_size;
+		float* seg_imag = seg_real + filter->segment_size / 2;
+		for (j = 0; j < flen + 1; j++) {
+			seg_real[j] = (float)seg_freq[j][0];
+			seg_imag[j] = (float)seg_freq[j][1];
+		}
+	}
+
+	fftw_destroy_plan(seg_fft);
+	fftw_free(seg_freq);
+	fftw_free(seg_time);
+}
+
+
+void hcResetSingleF(HConvSingleF* filter)
+{
+	memset(filter->mixbuf_freq, 0, sizeof(float) * filter->segment_size * filter->num_mixbuf);
+	memset(filter->history_time, 0, sizeof(float) * filter->framelength);
+	filter->step = 0;
+	filter->mixpos = 0;
+}
+
+
+void hcScaleSingleF(HConvSingleF* filter, double gain)
+{
+	size_t len = (size_t)filter->segment_size * filter->num_filterbuf;
+	for (size_t n = 0; n < len; n++)
+		filter->filterbuf_freq[n] = (float)(filter->filterbuf_freq[n] * gain);
+}
+
+void hcCloseSingleF(HConvSingleF* filter)
+{
+	fftwf_destroy_plan(filter->ifft);
+	fftwf_destroy_plan(filter->fft);
+	fftwf_free(filter->history_time);
+	hcAlignedFree(filter->mixbuf_freq);
+	hcAlignedFree(filter->filterbuf_freq);
+	fftwf_free(filter->in_freq_real);
+	fftwf_free(filter->in_freq_imag);
+	fftwf_free(filter->dft_freq);
+	fftwf_free(filter->dft_time);
+	free(filter->steptask);
+	memset(filter, 0, sizeof(HConvSingleF));
+}
+
+
 void hcBenchmarkDual(int sflen, int lflen)
 {
 	HConvDual filter;
@@ -965,6 +812,16 @@ void hcInitDual(HConvDual* filter, double* h, int hlen, int sflen, int lflen)
 }
 
 
+void hcResetDual(HConvDual* filter)
+{
+	memset(filter->in_long, 0, sizeof(double) * filter->flen_long);
+	memset(filter->out_long, 0, sizeof(double) * filter->flen_long);
+	hcResetSingle(filter->f_short);
+	hcResetSingle(filter->f_long);
+	filter->step = 0;
+}
+
+
 void hcCloseDual(HConvDual* filter)
 {
 	hcCloseSingle(filter->f_short);
@@ -1121,3 +978,134 @@ void hcCloseTripple(HConvTripple* filter)
 	fftw_free(filter->in_medium);
 	memset(filter, 0, sizeof(HConvTripple));
 }
+
+
+////////////////////////////////////////////////////////////////
+
+int hcZeroLatencyHeadLength(void)
+{
+	// Smallest power of two where a direct-form head of flen taps costs at least
+	// as much per sample as one frequency domain segment of the same length
+	// (forward and inverse real DFT of 2*flen points, complex MAC, overlap-add).
+	int flen = 16;
+	while (flen < 4096 && flen < 5.0 * log2(2.0 * flen) + 6.0)
+		flen *= 2;
+	return flen;
+}
+
+
+void hcProcessZeroLatency(HConvZeroLatency* filter, double* in, double* out, int len)
+{
+	const int flen = filter->flen;
+	const SimdKernels& kernels = SimdHelper::getKernels();
+	int done = 0;
+
+	while (done < len) {
+		int count = flen - filter->pos;
+		if (count > len - done)
+			count = len - done;
+
+		// copy first so that in and out may point to the same buffer
+		double* cur = filter->in_buf + flen + filter->pos;
+		memcpy(cur, in + done, sizeof(double) * count);
+
+		const double* tail = filter->out_tail + filter->pos;
+		for (int i = 0; i < count; i++)
+			out[done + i] = kernels.dotProduct(filter->head, cur + i - flen + 1, flen) + tail[i];
+
+		filter->pos += count;
+		done += count;
+
+		if (filter->pos == flen) {
+			// The tail starts flen samples into the impulse response, so the
+			// result for the completed segment is exactly what the next segment needs.
+			if (filter->f_tail != NULL) {
+				hcPutSingle(filter->f_tail, filter->in_buf + flen);
+				hcProcessSingle(filter->f_tail);
+				hcGetSingle(filter->f_tail, filter->out_tail);
+			}
+			else if (filter->f_tail_dual != NULL) {
+				hcProcessDual(filter->f_tail_dual, filter->in_buf + flen, filter->out_tail);
+			}
+			memcpy(filter->in_buf, filter->in_buf + flen, sizeof(double) * flen);
+			filter->pos = 0;
+		}
+	}
+}
+
+
+void hcInitZeroLatency(HConvZeroLatency* filter, double* h, int hlen, int flen, int lflen)
+{
+	int size;
+	int n;
+
+	filter->flen = flen;
+	filter->pos = 0;
+
+	size = sizeof(double) * flen;
+	filter->head = (double*)fftw_malloc(size);
+	memset(filter->head, 0, size);
+	for (n = 0; n < flen && n < hlen; n++)
+		filter->head[flen - 1 - n] = h[n];
+
+	filter->out_tail = (double*)fftw_malloc(size);
+	memset(filter->out_tail, 0, size);
+
+	size = sizeof(double) * 2 * flen;
+	filter->in_buf = (double*)fftw_malloc(size);
+	memset(filter->in_buf, 0, size);
+
+	filter->f_tail = NULL;
+	filter->f_tail_dual = NULL;
+	if (lflen > flen && hlen - flen > 2 * lflen) {
+		// Segments of flen samples would need many times the CPU of the default mode for a long
+		// tail, so beyond the first 2*lflen samples the tail uses segments of lflen samples
+		// like HConvDual, spreading their processing over the short segments.
+		filter->f_tail_dual = (HConvDual*)malloc(sizeof(HConvDual));
+		hcInitDual(filter->f_tail_dual, &(h[flen]), hlen - flen, flen, lflen);
+	}
+	else if (hlen > flen) {
+		filter->f_tail = (HConvSingle*)malloc(sizeof(HConvSingle));
+		hcInitSingle(filter->f_tail, &(h[flen]), hlen - flen, flen, 1);
+	}
+}
+
+
+void hcScaleZeroLatency(HConvZeroLatency* filter, double gain)
+{
+	for (int n = 0; n < filter->flen; n++)
+		filter->head[n] *= gain;
+	if (filter->f_tail != NULL)
+		hcScaleSingle(filter->f_tail, gain);
+	if (filter->f_tail_dual != NULL) {
+		hcScaleSingle(filter->f_tail_dual->f_short, gain);
+		hcScaleSingle(filter->f_tail_dual->f_long, gain);
+	}
+}
+
+void hcResetZeroLatency(HConvZeroLatency* filter)
+{
+	memset(filter->in_buf, 0, sizeof(double) * 2 * filter->flen);
+	memset(filter->out_tail, 0, sizeof(double) * filter->flen);
+	if (filter->f_tail != NULL)
+		hcResetSingle(filter->f_tail);
+	if (filter->f_tail_dual != NULL)
+		hcResetDual(filter->f_tail_dual);
+	filter->pos = 0;
+}
+
+void hcCloseZeroLatency(HConvZeroLatency* filter)
+{
+	if (filter->f_tail != NULL) {
+		hcCloseSingle(filter->f_tail);
+		free(filter->f_tail);
+	}
+	if (filter->f_tail_dual != NULL) {
+		hcCloseDual(filter->f_tail_dual);
+		free(filter->f_tail_dual);
+	}
+	fftw_free(filter->in_buf);
+	fftw_free(filter->out_tail);
+	fftw_free(filter->head);
+	memset(filter, 0, sizeof(HConvZeroLatency));
+}
@@ -37,18 +37,39 @@ typedef struct str_HConvSingle
 	fftw_complex *dft_freq;	// DFT buffer (frequency domain)
 	double *in_freq_real;		// input buffer (frequency domain)
 	double *in_freq_imag;		// input buffer (frequency domain)
+	int segment_size;		// doubles per segment (real part, then imaginary part, each padded to 64 bytes)
 	int num_filterbuf;		// number of filter segments
-	double **filterbuf_freq_real;	// filter segments (frequency domain)
-	double **filterbuf_freq_imag;	// filter segments (frequency domain)
-	int num_mixbuf;			// number of mixing segments		
-	double **mixbuf_freq_real;	// mixing segments (frequency domain)
-	double **mixbuf_freq_imag;	// mixing segments (frequency domain)
+	double *filterbuf_freq;		// filter segments (frequency domain), contiguous and 64-byte aligned
+	int num_mixbuf;			// number of mixing segments
+	double *mixbuf_freq;		// mixing segments (frequency domain), contiguous and 64-byte aligned
 	double *history_time;		// history buffer (time domain)
 	fftw_plan fft;			// FFT transformation plan
 	fftw_plan ifft;		// IFFT transformation plan
 } HConvSingle;
 
 
+typedef struct str_HConvSingleF
+{
+	int step;			// processing step counter
+	int maxstep;			// number of processing steps per audio frame
+	int mixpos;			// current frame index
+	int framelength;		// number of samples per audio frame
+	int *steptask;			// processing tasks per step
+	float *dft_time;		// DFT buffer (time domain)
+	fftwf_complex *dft_freq;	// DFT buffer (frequency domain)
+	float *in_freq_real;		// input buffer (frequency domain)
+	float *in_freq_imag;		// input buffer (frequency domain)
+	int segment_size;		// floats per segment (real part, then imaginary part, each padded to 64 bytes)
+	int num_filterbuf;		// number of filter segments
+	float *filterbuf_freq;		// filter segments (frequency domain), contiguous and 64-byte aligned
+	int num_mixbuf;			// number of mixing segments
+	float *mixbuf_freq;		// mixing segments (frequency domain), contiguous and 64-byte aligned
+	float *history_time;		// history buffer (time domain)
+	fftwf_plan fft;			// FFT transformation plan
+	fftwf_plan ifft;		// IFFT transformation plan
+} HConvSingleF;
+
+
 typedef struct str_HConvDual
 {
 	int step;		// processing step counter
@@ -75,6 +96,18 @@ typedef struct str_HConvTripple
 } HConvTripple;
 
 
+typedef struct str_HConvZeroLatency
+{
+	int flen;		// number of samples per tail segment (also length of the head filter)
+	int pos;		// current position within the tail segment
+	double *head;		// head filter coefficients (time-reversed, time domain)
+	double *in_buf;		// input buffer (previous and current tail segment)
+	double *out_tail;	// output buffer of the tail filter for the current segment
+	HConvSingle *f_tail;	// convolution filter (tail segments of flen samples), NULL if not used
+	HConvDual *f_tail_dual;	// convolution filter (tail segments of flen samples, then of lflen samples), NULL if not used
+} HConvZeroLatency;
+
+
 /* single filter functions */
 double hcTime(void);
 double getProcTime(int flen, int num, double dur);
@@ -83,13 +116,26 @@ void hcProcessSingle(HConvSingle *filter);
 void hcGetSingle(HConvSingle *filter, double*y);
 void hcGetAddSingle(HConvSingle *filter, double*y);
 void hcInitSingle(HConvSingle *filter, double*h, int hlen, int flen, int steps);
+void hcResetSingle(HConvSingle *filter);
+void hcScaleSingle(HConvSingle *filter, double gain);
 void hcCloseSingle(HConvSingle *filter);
 
+/* single precision filter functions (double input and output, float spectra) */
+void hcPutSingleF(HConvSingleF *filter, double*x);
+void hcProcessSingleF(HConvSingleF *filter);
+void hcGetSingleF(HConvSingleF *filter, double*y);
+void hcGetAddSingleF(HConvSingleF *filter, double*y);
+void hcInitSingleF(HConvSingleF *filter, double*h, int hlen, int flen, int steps);
+void hcResetSingleF(HConvSingleF *filter);
+void hcScaleSingleF(HConvSingleF *filter, double gain);
+void hcCloseSingleF(HConvSingleF *filter);
+
 /* dual filter functions */
 void hcBenchmarkDual(int sflen, int lflen);
 void hcProcessDual(HConvDual *filter, double*in, double*out);
 void hcProcessAddDual(HConvDual *filter, double*in, double*out);
 void hcInitDual(HConvDual *filter, double*h, int hlen, int sflen, int lflen);
+void hcResetDual(HConvDual *filter);
 void hcCloseDual(HConvDual *filter);
 
 /* tripple filter functions */
@@ -99,5 +145,13 @@ void hcProcessAddTripple(HConvTripple *filter, double*in, double*out);
 void hcInitTripple(HConvTripple *filter, double*h, int hlen, int sflen, int mflen, int lflen);
 void hcCloseTripple(HConvTripple *filter);
 
+/* zero latency filter functions */
+int hcZeroLatencyHeadLength(void);
+void hcProcessZeroLatency(HConvZeroLatency *filter, double*in, double*out, int len);
+void hcInitZeroLatency(HConvZeroLatency *filter, double*h, int hlen, int flen, int lflen);
+void hcResetZeroLatency(HConvZeroLatency *filter);
+void hcScaleZeroLatency(HConvZeroLatency *filter, double gain);
+void hcCloseZeroLatency(HConvZeroLatency *filter);
+
 
 #endif // __LIBHYBRIDCONV_H__
@@ -0,0 +1,81 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "stdafx.h"
+
+#include "ExpressionCache.h"
+
+using namespace std;
+using namespace mup;
+
+// enough for the conditions of typical configurations, while a parser copy takes several kilobytes
+static const size_t maxCompiledExpressionCount = 128;
+// only the expression texts are kept for these
+static const size_t maxVariableExpressionCount = 1024;
+
+void ExpressionCache::setParser(ParserX* parser)
+{
+	// constants and functions might have been redefined, which is only noticed by a new compilation
+	this->parser = parser;
+	compiledExpressions.clear();
+	useOrder.clear();
+	variableExpressions.clear();
+}
+
+Value ExpressionCache::evaluate(const wstring& expression)
+{
+	auto it = compiledExpressions.find(expression);
+	if (it != compiledExpressions.end())
+	{
+		useOrder.splice(useOrder.end(), useOrder, it->second.usePosition);
+		return it->second.parser->Eval();
+	}
+
+	parser->SetExpr(expression);
+	Value result = parser->Eval();
+
+	// variables are bound to their values during compilation and recreated on every load,
+	// so only expressions consisting of constants and function calls can be reused
+	if (variableExpressions.find(expression) == variableExpressions.end())
+	{
+		if (parser->GetExprVar().empty())
+		{
+			if (compiledExpressions.size() >= maxCompiledExpressionCount)
+			{
+				compiledExpressions.erase(useOrder.front());
+				useOrder.pop_front();
+			}
+
+			// compiled on its first evaluation
+			ParserX* compiled = new ParserX(*parser);
+			compiled->SetExpr(expression);
+			CompiledExpression& entry = compiledExpressions[expression];
+			entry.parser = unique_ptr<ParserX>(compiled);
+			entry.usePosition = useOrder.insert(useOrder.end(), expression);
+		}
+		else
+		{
+			if (variableExpressions.size() >= maxVariableExpressionCount)
+				variableExpressions.clear();
+			variableExpressions.insert(expression);
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,51 @@
+/*
+    This file is part of EqualizerAPO, a system-wide equalizer.
+    Copyright (C) 2026  Jonas Thedering
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <mpParser.h>
+
+// Evaluates expressions with a parser and keeps the compiled form of those that do not reference variables,
+// so that they are not tokenized again when the configuration is reloaded. muparserx only keeps the compiled form
+// inside a parser, so each cached expression holds a copy of the parser. Therefore, only the most recently used
+// expressions are kept.
+class ExpressionCache
+{
+public:
+	void setParser(mup::ParserX* parser);
+	mup::Value evaluate(const std::wstring& expression);
+
+private:
+	struct CompiledExpression
+	{
+		std::unique_ptr<mup::ParserX> parser;
+		std::list<std::wstring>::iterator usePosition;
+	};
+
+	mup::ParserX* parser = NULL;
+	std::unordered_map<std::wstring, CompiledExpression> compiledExpressions;
+	// least recently used first
+	std::list<std::wstring> useOrder;
+	std::unordered_set<std::wstring> variableExpressions;
+};
@@ -19,12 +19,36 @@
 
 #include "stdafx.h"
 #include <regex>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "RegexFunctions.h"
 
 using namespace std;
 using namespace mup;
 
+static const size_t maxCachedRegexCount = 256;
+static mutex regexMutex;
+static unordered_map<wstring, shared_ptr<const wregex>> regexCache;
+
+// compiled regular expressions are shared by all engines, as the same conditions are usually evaluated for each device
+static shared_ptr<const wregex> getRegex(const wstring& regexString)
+{
+	lock_guard<mutex> lock(regexMutex);
+
+	auto it = regexCache.find(regexString);
+	if (it != regexCache.end())
+		return it->second;
+
+	if (regexCache.size() >= maxCachedRegexCount)
+		regexCache.clear();
+
+	shared_ptr<const wregex> regex = make_shared<wregex>(regexString);
+	regexCache[regexString] = regex;
+	return regex;
+}
+
 RegexSearchFunction::RegexSearchFunction()
 	: ICallback(cmFUNC, L"regexSearch", 2)
 {
@@ -40,9 +64,9 @@ void RegexSearchFunction::Eval(ptr_val_type& ret, const ptr_val_type* arg, int a
 	wstring regexString = arg[0]->GetString();
 	wstring string = arg[1]->GetString();
 
-	wregex regex(regexString);
+	shared_ptr<const wregex> regex = getRegex(regexString);
 	wsmatch match;
-	bool found = regex_search(string, match, regex);
+	bool found = regex_search(string, match, *regex);
 
 	vector<Value> result;
 	if (found)
@@ -82,8 +106,8 @@ void RegexReplaceFunction::Eval(ptr_val_type& ret, const ptr_val_type* arg, int
 	wstring string = arg[1]->GetString();
 	wstring replacement = arg[2]->GetString();
 
-	wregex regex(regexString);
-	wstring result = regex_replace(string, regex, replacement);
+	shared_ptr<const wregex> regex = getRegex(regexString);
+	wstring result = regex_replace(string, *regex, replacement);
 
 	*ret = result;
 }